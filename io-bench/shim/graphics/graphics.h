@@ -0,0 +1,137 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "vec2.h"
+#include "vec3.h"
+#include "vec4.h"
+#include "../util/base.h"
+#include "../util/bmem.h"
+
+struct gs_rect
+{
+    int x, y, cx, cy;
+};
+
+enum gs_color_format
+{
+    GS_UNKNOWN, GS_RGBA, GS_BGRA
+};
+
+enum gs_zstencil_format
+{
+    GS_ZS_NONE
+};
+
+enum gs_blend_type
+{
+    GS_BLEND_ZERO, GS_BLEND_ONE, GS_BLEND_SRCCOLOR, GS_BLEND_INVSRCCOLOR, GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA
+};
+
+#define GS_CLEAR_COLOR (1 << 0)
+
+typedef struct gs_effect gs_effect_t;
+typedef struct gs_texture gs_texture_t;
+typedef struct gs_effect_param gs_eparam_t;
+typedef struct gs_vertex_buffer gs_vertbuffer_t;
+typedef struct gs_index_buffer gs_indexbuffer_t;
+typedef struct gs_texture_render gs_texrender_t;
+
+#define GS_DYNAMIC (1 << 1)
+
+enum gs_draw_mode
+{
+    GS_POINTS, GS_LINES, GS_LINESTRIP, GS_TRIS, GS_TRISTRIP
+};
+
+struct gs_tvertarray
+{
+    size_t width;
+    void* array;
+};
+
+struct gs_vb_data
+{
+    size_t num;
+    struct vec3* points;
+    struct vec3* normals;
+    struct vec3* tangents;
+    uint32_t* colors;
+    size_t num_tex;
+    struct gs_tvertarray* tvarray;
+};
+
+static inline struct gs_vb_data* gs_vbdata_create(void)
+{
+    return (struct gs_vb_data*) bzalloc(sizeof(struct gs_vb_data));
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void gs_matrix_push(void);
+
+void gs_matrix_pop(void);
+
+void gs_matrix_translate3f(float x, float y, float z);
+
+void gs_matrix_rotaa4f(float x, float y, float z, float angle);
+
+gs_eparam_t* gs_effect_get_param_by_name(const gs_effect_t* effect, const char* name);
+
+void gs_effect_set_texture(gs_eparam_t* param, gs_texture_t* val);
+
+void gs_draw_sprite_subregion(gs_texture_t* tex, uint32_t flip, uint32_t x, uint32_t y, uint32_t cx, uint32_t cy);
+
+gs_vertbuffer_t* gs_vertexbuffer_create(struct gs_vb_data* data, uint32_t flags);
+
+void gs_vertexbuffer_destroy(gs_vertbuffer_t* vertbuffer);
+
+void gs_vertexbuffer_flush(gs_vertbuffer_t* vertbuffer);
+
+struct gs_vb_data* gs_vertexbuffer_get_data(const gs_vertbuffer_t* vertbuffer);
+
+void gs_load_vertexbuffer(gs_vertbuffer_t* vertbuffer);
+
+void gs_load_indexbuffer(gs_indexbuffer_t* indexbuffer);
+
+void gs_draw(enum gs_draw_mode draw_mode, uint32_t start_vert, uint32_t num_verts);
+
+void gs_draw_sprite(gs_texture_t* tex, uint32_t flip, uint32_t width, uint32_t height);
+
+void gs_clear(uint32_t clear_flags, const struct vec4* color, float depth, uint8_t stencil);
+
+void gs_ortho(float left, float right, float top, float bottom, float znear, float zfar);
+
+void gs_blend_state_push(void);
+
+void gs_blend_state_pop(void);
+
+void gs_blend_function(enum gs_blend_type src, enum gs_blend_type dest);
+
+void gs_blend_function_separate(enum gs_blend_type src_c, enum gs_blend_type dest_c, enum gs_blend_type src_a,
+                                enum gs_blend_type dest_a);
+
+gs_texrender_t* gs_texrender_create(enum gs_color_format format, enum gs_zstencil_format zsformat);
+
+void gs_texrender_destroy(gs_texrender_t* texrender);
+
+bool gs_texrender_begin(gs_texrender_t* texrender, uint32_t cx, uint32_t cy);
+
+void gs_texrender_end(gs_texrender_t* texrender);
+
+void gs_texrender_reset(gs_texrender_t* texrender);
+
+gs_texture_t* gs_texrender_get_texture(const gs_texrender_t* texrender);
+
+#ifdef __cplusplus
+}
+#endif
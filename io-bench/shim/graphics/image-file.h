@@ -0,0 +1,37 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include "graphics.h"
+
+struct gs_image_file
+{
+    gs_texture_t* texture;
+    enum gs_color_format format;
+    uint32_t cx, cy;
+    bool is_animated_gif;
+    bool frame_updated;
+    bool loaded;
+    uint8_t* texture_data;
+};
+
+typedef struct gs_image_file gs_image_file_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void gs_image_file_init(gs_image_file_t* image, const char* file);
+
+void gs_image_file_free(gs_image_file_t* image);
+
+void gs_image_file_init_texture(gs_image_file_t* image);
+
+#ifdef __cplusplus
+}
+#endif
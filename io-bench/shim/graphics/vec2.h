@@ -0,0 +1,20 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+struct vec2
+{
+    union
+    {
+        struct
+        {
+            float x, y;
+        };
+        float ptr[2];
+    };
+};
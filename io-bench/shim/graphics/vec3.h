@@ -0,0 +1,20 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+struct vec3
+{
+    union
+    {
+        struct
+        {
+            float x, y, z, w;
+        };
+        float ptr[4];
+    };
+};
@@ -0,0 +1,27 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <string.h>
+
+struct vec4
+{
+    union
+    {
+        struct
+        {
+            float x, y, z, w;
+        };
+        float ptr[4];
+    };
+};
+
+static inline void vec4_zero(struct vec4* dst)
+{
+    memset(dst, 0, sizeof(struct vec4));
+}
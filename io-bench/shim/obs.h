@@ -0,0 +1,50 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "util/base.h"
+#include "util/bmem.h"
+#include "graphics/graphics.h"
+
+typedef struct obs_data obs_data_t;
+typedef struct obs_source obs_source_t;
+typedef struct obs_properties obs_properties_t;
+typedef struct obs_property obs_property_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool obs_data_get_bool(obs_data_t* data, const char* name);
+
+void obs_data_set_string(obs_data_t* data, const char* name, const char* val);
+
+obs_property_t* obs_properties_get(obs_properties_t* props, const char* property);
+
+void obs_source_update(obs_source_t* source, obs_data_t* settings);
+
+uint32_t obs_source_get_width(obs_source_t* source);
+
+uint32_t obs_source_get_height(obs_source_t* source);
+
+void obs_source_video_render(obs_source_t* source);
+
+void obs_property_list_clear(obs_property_t* p);
+
+size_t obs_property_list_add_int(obs_property_t* p, const char* name, long long val);
+
+void obs_enter_graphics(void);
+
+void obs_leave_graphics(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,273 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include <obs-module.h>
+#include <util/platform.h>
+#include <graphics/image-file.h>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+
+/* Only warnings and errors are printed, so logging
+ * doesn't end up in the measurements */
+void blog(const int log_level, const char* format, ...)
+{
+    if (log_level > LOG_WARNING)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+uint64_t os_gettime_ns(void)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void os_sleep_ms(const uint32_t duration)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+}
+
+FILE* os_fopen(const char* path, const char* mode)
+{
+    return fopen(path, mode);
+}
+
+char* os_get_abs_path_ptr(const char* path)
+{
+#ifdef _WIN32
+    return _fullpath(nullptr, path, 0);
+#else
+    return realpath(path, nullptr);
+#endif
+}
+
+void bfree(void* ptr)
+{
+    free(ptr);
+}
+
+void* bzalloc(size_t size)
+{
+    return calloc(1, size ? size : 1);
+}
+
+const char* obs_module_text(const char* lookup_string)
+{
+    return lookup_string;
+}
+
+/* Graphics and sources don't exist without obs, these are
+ * only referenced by code the benchmarks never run */
+void gs_matrix_push(void)
+{
+}
+
+void gs_matrix_pop(void)
+{
+}
+
+void gs_matrix_translate3f(float, float, float)
+{
+}
+
+void gs_matrix_rotaa4f(float, float, float, float)
+{
+}
+
+gs_eparam_t* gs_effect_get_param_by_name(const gs_effect_t*, const char*)
+{
+    return nullptr;
+}
+
+void gs_effect_set_texture(gs_eparam_t*, gs_texture_t*)
+{
+}
+
+void gs_draw_sprite_subregion(gs_texture_t*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t)
+{
+}
+
+/* Vertex buffers are only their data, so uploads still copy it like obs does */
+gs_vertbuffer_t* gs_vertexbuffer_create(gs_vb_data* data, uint32_t)
+{
+    return reinterpret_cast<gs_vertbuffer_t*>(data);
+}
+
+void gs_vertexbuffer_destroy(gs_vertbuffer_t* vertbuffer)
+{
+    const auto data = reinterpret_cast<gs_vb_data*>(vertbuffer);
+    if (!data)
+        return;
+    for (size_t i = 0; i < data->num_tex; i++)
+        free(data->tvarray[i].array);
+    free(data->tvarray);
+    free(data->points);
+    free(data);
+}
+
+void gs_vertexbuffer_flush(gs_vertbuffer_t*)
+{
+}
+
+gs_vb_data* gs_vertexbuffer_get_data(const gs_vertbuffer_t* vertbuffer)
+{
+    return reinterpret_cast<gs_vb_data*>(const_cast<gs_vertbuffer_t*>(vertbuffer));
+}
+
+void gs_load_vertexbuffer(gs_vertbuffer_t*)
+{
+}
+
+void gs_load_indexbuffer(gs_indexbuffer_t*)
+{
+}
+
+void gs_draw(gs_draw_mode, uint32_t, uint32_t)
+{
+}
+
+void gs_draw_sprite(gs_texture_t*, uint32_t, uint32_t, uint32_t)
+{
+}
+
+void gs_clear(uint32_t, const vec4*, float, uint8_t)
+{
+}
+
+void gs_ortho(float, float, float, float, float, float)
+{
+}
+
+void gs_blend_state_push(void)
+{
+}
+
+void gs_blend_state_pop(void)
+{
+}
+
+void gs_blend_function(gs_blend_type, gs_blend_type)
+{
+}
+
+void gs_blend_function_separate(gs_blend_type, gs_blend_type, gs_blend_type, gs_blend_type)
+{
+}
+
+/* Render targets only have to be distinct pointers */
+gs_texrender_t* gs_texrender_create(gs_color_format, gs_zstencil_format)
+{
+    return static_cast<gs_texrender_t*>(bzalloc(1));
+}
+
+void gs_texrender_destroy(gs_texrender_t* texrender)
+{
+    free(texrender);
+}
+
+bool gs_texrender_begin(gs_texrender_t*, uint32_t, uint32_t)
+{
+    return true;
+}
+
+void gs_texrender_end(gs_texrender_t*)
+{
+}
+
+void gs_texrender_reset(gs_texrender_t*)
+{
+}
+
+gs_texture_t* gs_texrender_get_texture(const gs_texrender_t* texrender)
+{
+    return reinterpret_cast<gs_texture_t*>(const_cast<gs_texrender_t*>(texrender));
+}
+
+void obs_enter_graphics(void)
+{
+}
+
+void obs_leave_graphics(void)
+{
+}
+
+/* Images aren't decoded, every file is an opaque square so layouts can be
+ * used. Like in obs the pixels are freed once the texture is created */
+#define SHIM_IMAGE_SIZE 64
+
+void gs_image_file_init(gs_image_file_t* image, const char*)
+{
+    *image = {};
+    image->cx = image->cy = SHIM_IMAGE_SIZE;
+    image->format = GS_RGBA;
+    image->texture_data = static_cast<uint8_t*>(bzalloc(SHIM_IMAGE_SIZE * SHIM_IMAGE_SIZE * 4));
+    memset(image->texture_data, 0xff, SHIM_IMAGE_SIZE * SHIM_IMAGE_SIZE * 4);
+    image->loaded = true;
+}
+
+void gs_image_file_free(gs_image_file_t* image)
+{
+    if (image) {
+        bfree(image->texture_data);
+        image->texture_data = nullptr;
+        image->loaded = false;
+    }
+}
+
+void gs_image_file_init_texture(gs_image_file_t* image)
+{
+    bfree(image->texture_data);
+    image->texture_data = nullptr;
+}
+
+bool obs_data_get_bool(obs_data_t*, const char*)
+{
+    return false;
+}
+
+void obs_data_set_string(obs_data_t*, const char*, const char*)
+{
+}
+
+obs_property_t* obs_properties_get(obs_properties_t*, const char*)
+{
+    return nullptr;
+}
+
+void obs_source_update(obs_source_t*, obs_data_t*)
+{
+}
+
+uint32_t obs_source_get_width(obs_source_t*)
+{
+    return 0;
+}
+
+uint32_t obs_source_get_height(obs_source_t*)
+{
+    return 0;
+}
+
+void obs_source_video_render(obs_source_t*)
+{
+}
+
+void obs_property_list_clear(obs_property_t*)
+{
+}
+
+size_t obs_property_list_add_int(obs_property_t*, const char*, long long)
+{
+    return 0;
+}
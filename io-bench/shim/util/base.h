@@ -0,0 +1,30 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+/* Minimal stand-in for libobs, only declares what the benchmarked
+ * parts of io-obs use. Implemented in obs_shim.cpp */
+
+#include <stdarg.h>
+
+enum
+{
+    LOG_ERROR = 100, LOG_WARNING = 200, LOG_INFO = 300, LOG_DEBUG = 400
+};
+
+#define UNUSED_PARAMETER(param) (void)param
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void blog(int log_level, const char* format, ...);
+
+#ifdef __cplusplus
+}
+#endif
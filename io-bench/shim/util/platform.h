@@ -0,0 +1,31 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t os_gettime_ns(void);
+
+void os_sleep_ms(uint32_t duration);
+
+FILE* os_fopen(const char* path, const char* mode);
+
+#define os_stat stat
+
+/* Free the result with bfree */
+char* os_get_abs_path_ptr(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
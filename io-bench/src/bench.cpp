@@ -0,0 +1,88 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "bench.hpp"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+/* Bumped whenever fields are renamed or their meaning changes,
+ * so comparison scripts don't compare different things */
+#define IO_BENCH_FORMAT 1
+
+namespace bench
+{
+    void runner::add_result(const char* name, const uint32_t events, const double rate, const uint64_t iterations,
+                            std::vector<double> &samples)
+    {
+        result r;
+        r.name = name;
+        r.events = events;
+        r.rate = rate;
+        r.iterations = iterations;
+        r.samples = static_cast<uint32_t>(samples.size());
+
+        std::sort(samples.begin(), samples.end());
+        const auto mid = samples.size() / 2;
+        r.ns_per_op = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2.0;
+        r.ns_per_op_min = samples.front();
+
+        double mean = 0.0, variance = 0.0;
+        for (const auto &s : samples)
+            mean += s;
+        mean /= samples.size();
+        for (const auto &s : samples)
+            variance += (s - mean) * (s - mean);
+        r.ns_per_op_stddev = std::sqrt(variance / samples.size());
+
+        m_results.emplace_back(r);
+        fprintf(stderr, "%-40s %12.1f ns/op %14.0f events/s %8.4f%% load\n", name, r.ns_per_op,
+                r.events_per_second(), r.load() * 100.0);
+    }
+
+    void runner::write(FILE* out) const
+    {
+        if (m_options.list)
+            return;
+
+        if (m_options.format == FORMAT_CSV) {
+            fprintf(out, "name,events,iterations,samples,ns_per_op,ns_per_op_min,ns_per_op_stddev,"
+                         "ns_per_event,events_per_second,rate,load\n");
+            for (const auto &r : m_results) {
+                fprintf(out, "%s,%u,%llu,%u,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f,%.9f\n", r.name.c_str(), r.events,
+                        static_cast<unsigned long long>(r.iterations), r.samples, r.ns_per_op, r.ns_per_op_min,
+                        r.ns_per_op_stddev, r.ns_per_event(), r.events_per_second(), r.rate, r.load());
+            }
+            return;
+        }
+
+        char date[32] = "";
+        const auto now = time(nullptr);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+        fprintf(out, "{\n  \"suite\": \"io-bench\",\n  \"format\": %i,\n  \"date\": \"%s\",\n", IO_BENCH_FORMAT, date);
+#ifdef NDEBUG
+        fprintf(out, "  \"build\": \"release\",\n");
+#else
+        fprintf(out, "  \"build\": \"debug\",\n");
+#endif
+        fprintf(out, "  \"samples\": %u,\n  \"sample_time\": %.3f,\n  \"benchmarks\": [", m_options.samples,
+                m_options.sample_time);
+
+        for (size_t i = 0; i < m_results.size(); i++) {
+            const auto &r = m_results[i];
+            /* Names are plain identifiers and slashes, no escaping needed */
+            fprintf(out, "%s\n    {\"name\": \"%s\", \"events\": %u, \"iterations\": %llu, \"samples\": %u, "
+                         "\"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, \"ns_per_op_stddev\": %.3f, "
+                         "\"ns_per_event\": %.3f, \"events_per_second\": %.1f, \"rate\": %.1f, \"load\": %.9f}",
+                    i > 0 ? "," : "", r.name.c_str(), r.events, static_cast<unsigned long long>(r.iterations),
+                    r.samples, r.ns_per_op, r.ns_per_op_min, r.ns_per_op_stddev, r.ns_per_event(),
+                    r.events_per_second(), r.rate, r.load());
+        }
+        fprintf(out, "\n  ]\n}\n");
+    }
+}
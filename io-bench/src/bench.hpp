@@ -0,0 +1,154 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* Typical rates of the benchmarked work in a running obs instance,
+ * used to put the measured time into relation (see result::load) */
+#define RATE_TYPING         20      /* ~120 wpm, press and release */
+#define RATE_MOUSE          1000    /* 1000 Hz polling rate */
+#define RATE_GAMEPAD        1000    /* Two sticks and triggers at ~250 Hz */
+#define RATE_FRAME          60      /* Once per video frame */
+#define RATE_REMOTE         250     /* Messages per second of one io-client */
+
+namespace bench
+{
+    enum output_format
+    {
+        FORMAT_JSON, FORMAT_CSV
+    };
+
+    struct options
+    {
+        std::string filter;                     /* Only run benchmarks containing this */
+        uint32_t samples = 15;                  /* Measurements per benchmark */
+        double sample_time = 0.02;              /* Minimum duration of one sample in seconds */
+        output_format format = FORMAT_JSON;
+        bool list = false;                      /* Only print the names */
+    };
+
+    struct result
+    {
+        std::string name;
+        uint32_t events = 1;            /* Input events handled per operation */
+        uint64_t iterations = 0;        /* Operations per sample */
+        uint32_t samples = 0;
+        double ns_per_op = 0.0;         /* Median of all samples */
+        double ns_per_op_min = 0.0;
+        double ns_per_op_stddev = 0.0;
+        double rate = 0.0;              /* Typical events per second */
+
+        double ns_per_event() const
+        {
+            return ns_per_op / events;
+        }
+
+        double events_per_second() const
+        {
+            return 1000000000.0 / ns_per_event();
+        }
+
+        /* Share of one cpu core spent at the typical rate */
+        double load() const
+        {
+            return rate * ns_per_event() / 1000000000.0;
+        }
+    };
+
+    /* Keeps the compiler from dropping work whose result isn't used */
+    template<class T>
+    inline void keep(const T &value)
+    {
+#ifdef _MSC_VER
+        static volatile const void* sink;
+        sink = &value;
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    class runner
+    {
+    public:
+        explicit runner(const options &opt) : m_options(opt)
+        {
+        }
+
+        /* Measures op, which handles events input events per call.
+         * The iteration count is raised until one sample takes at least
+         * sample_time, so slow and fast operations get the same accuracy
+         */
+        template<class F>
+        void run(const char* name, const uint32_t events, const double rate, F op)
+        {
+            if (!m_options.filter.empty() && std::string(name).find(m_options.filter) == std::string::npos)
+                return;
+
+            if (m_options.list) {
+                printf("%s\n", name);
+                return;
+            }
+
+            uint64_t iterations = 1;
+            double elapsed;
+            for (;;) {
+                elapsed = measure(op, iterations);
+                if (elapsed >= m_options.sample_time || iterations >= (1ull << 40))
+                    break;
+                /* Aim slightly above the target to avoid another round */
+                const auto factor = elapsed > 0.0 ? m_options.sample_time * 1.2 / elapsed : 16.0;
+                iterations = static_cast<uint64_t>(iterations * (factor > 16.0 ? 16.0 : (factor < 2.0 ? 2.0 : factor)));
+            }
+
+            std::vector<double> samples;
+            for (uint32_t i = 0; i < m_options.samples; i++)
+                samples.emplace_back(measure(op, iterations) * 1000000000.0 / iterations);
+
+            add_result(name, events, rate, iterations, samples);
+        }
+
+        void write(FILE* out) const;
+
+        const std::vector<result> &results() const
+        {
+            return m_results;
+        }
+
+    private:
+        template<class F>
+        static double measure(F &op, const uint64_t iterations)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < iterations; i++)
+                op();
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        void add_result(const char* name, uint32_t events, double rate, uint64_t iterations,
+                        std::vector<double> &samples);
+
+        options m_options;
+        std::vector<result> m_results;
+    };
+
+    /* Benchmark groups, each in their own file */
+    void run_data_benchmarks(runner &r);
+
+    void run_history_benchmarks(runner &r);
+
+    void run_network_benchmarks(runner &r);
+
+    void run_gamepad_benchmarks(runner &r);
+
+    void run_render_benchmarks(runner &r);
+}
@@ -0,0 +1,156 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "bench.hpp"
+#include "util/element/element_data_holder.hpp"
+#include "sources/input_history.hpp"
+#include "util/trace.hpp"
+#include "util/profiled_mutex.hpp"
+#include <uiohook.h>
+
+namespace bench
+{
+    /* Home row and a few common keys, roughly what typing looks like */
+    static const uint16_t typing_keys[] = {VC_A, VC_S, VC_D, VC_F, VC_J, VC_K, VC_L, VC_E, VC_SPACE, VC_SHIFT_L,
+                                           VC_R, VC_T, VC_I, VC_O, VC_N, VC_BACKSPACE};
+    static const size_t typing_key_count = sizeof(typing_keys) / sizeof(typing_keys[0]);
+
+    /* Every key of a 16 key rollover keyboard held at once */
+    static const uint16_t rollover_keys[] = {VC_W, VC_A, VC_S, VC_D, VC_Q, VC_E, VC_R, VC_F, VC_SPACE, VC_SHIFT_L,
+                                             VC_CONTROL_L, VC_TAB, VC_1, VC_2, VC_3, VC_4};
+
+    static void add_data_benchmarks(runner &r)
+    {
+        /* Remote sources go through the recorder check, like io_client does */
+        element_data_holder holder(1);
+        size_t key = 0;
+
+        r.run("holder/add_data/keys", 2, RATE_TYPING, [&]
+        {
+            const auto vc = typing_keys[key++ % typing_key_count];
+            holder.add_data(vc, element_data_button(STATE_PRESSED));
+            holder.add_data(vc, element_data_button(STATE_RELEASED));
+        });
+
+        /* Mouse stats are persistent, every move is merged into the slot */
+        int16_t x = 0;
+        r.run("holder/merge/mouse_move", 1, RATE_MOUSE, [&]
+        {
+            x = static_cast<int16_t>((x + 3) & 0x7FF);
+            holder.add_data(VC_MOUSE_DATA, element_data_mouse_stats(x, static_cast<int16_t>(x / 2)));
+        });
+
+        r.run("holder/merge/mouse_wheel", 1, RATE_TYPING, [&]
+        {
+            holder.add_data(VC_MOUSE_WHEEL, element_data_wheel(WHEEL_DIR_UP, STATE_RELEASED));
+        });
+
+        float axis = 0.f;
+        r.run("holder/merge/stick_axis", 1, RATE_GAMEPAD, [&]
+        {
+            axis = axis > 1.f ? -1.f : axis + 0.01f;
+            holder.add_gamepad_data(0, VC_STICK_DATA, element_data_analog_stick(axis, SD_LEFT_X));
+        });
+
+        r.run("holder/add_gamepad_data/buttons", 2, RATE_TYPING, [&]
+        {
+            const auto vc = PAD_TO_VC(key++ % 15);
+            holder.add_gamepad_data(0, vc, element_data_button(STATE_PRESSED));
+            holder.add_gamepad_data(0, vc, element_data_button(STATE_RELEASED));
+        });
+
+        /* One batch of changes published and picked up by the next frame */
+        r.run("holder/publish_snapshot", 1, RATE_FRAME, [&]
+        {
+            holder.publish();
+            keep(holder.snapshot());
+        });
+    }
+
+    static void populate_benchmark(runner &r, const char* name, const input_state &state, const uint16_t flags)
+    {
+        sources::history_settings settings;
+        settings.flags = flags;
+        std::vector<uint16_t> keys;
+
+        r.run(name, 1, RATE_FRAME, [&]
+        {
+            keys.clear();
+            state.populate_vector(keys, &settings);
+            keep(keys.data());
+        });
+    }
+
+    static void populate_benchmarks(runner &r)
+    {
+        input_state idle;
+        populate_benchmark(r, "state/populate_vector/idle", idle, sources::FLAG_INCLUDE_MOUSE);
+
+        input_state typing;
+        typing.add_data(VC_SHIFT_L, element_data_button(STATE_PRESSED));
+        typing.add_data(VC_A, element_data_button(STATE_PRESSED));
+        typing.add_data(VC_S, element_data_button(STATE_RELEASED));
+        typing.add_data(VC_MOUSE_DATA, element_data_mouse_stats(100, 200));
+        populate_benchmark(r, "state/populate_vector/typing", typing, sources::FLAG_INCLUDE_MOUSE);
+
+        input_state rollover = typing;
+        for (const auto &vc : rollover_keys)
+            rollover.add_data(vc, element_data_button(STATE_PRESSED));
+        rollover.add_data(VC_MOUSE_BUTTON1, element_data_button(STATE_PRESSED));
+        rollover.add_data(VC_MOUSE_WHEEL, element_data_wheel(WHEEL_DIR_DOWN, STATE_RELEASED));
+        populate_benchmark(r, "state/populate_vector/rollover", rollover, sources::FLAG_INCLUDE_MOUSE);
+
+        input_state pad;
+        pad.add_gamepad_data(0, VC_PAD_A, element_data_button(STATE_PRESSED));
+        pad.add_gamepad_data(0, VC_PAD_RB, element_data_button(STATE_PRESSED));
+        pad.add_gamepad_data(0, VC_STICK_DATA, element_data_analog_stick(STATE_PRESSED, SIDE_LEFT));
+        pad.add_gamepad_data(0, VC_TRIGGER_DATA, element_data_trigger(T_DATA_RIGHT, 0.8f));
+        populate_benchmark(r, "state/populate_vector/gamepad", pad,
+                           sources::FLAG_INCLUDE_MOUSE | sources::FLAG_INCLUDE_PAD);
+    }
+
+    /* Spans are on the path of every event, so they
+     * have to be close to free while tracing is off */
+    static void trace_benchmarks(runner &r)
+    {
+        r.run("trace/scope/off", 1, RATE_MOUSE, [&]
+        {
+            TRACE_SCOPE("bench");
+        });
+
+        trace::start();
+        r.run("trace/scope/on", 1, RATE_MOUSE, [&]
+        {
+            TRACE_SCOPE("bench");
+        });
+        trace::stop();
+    }
+
+    /* Every drain and gamepad report takes one of the shared locks */
+    static void lock_benchmarks(runner &r)
+    {
+        std::mutex plain;
+        r.run("lock/std_mutex", 1, RATE_GAMEPAD, [&]
+        {
+            std::lock_guard<std::mutex> lock(plain);
+        });
+
+        static profiled_mutex profiled("bench::mutex");
+        r.run("lock/profiled_mutex", 1, RATE_GAMEPAD, [&]
+        {
+            PROFILED_LOCK(lock, profiled);
+        });
+    }
+
+    void run_data_benchmarks(runner &r)
+    {
+        add_data_benchmarks(r);
+        populate_benchmarks(r);
+        trace_benchmarks(r);
+        lock_benchmarks(r);
+    }
+}
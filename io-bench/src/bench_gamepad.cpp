@@ -0,0 +1,53 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "bench.hpp"
+
+#ifdef LINUX
+#include "hook/gamepad_binding.hpp"
+#include "util/element/element_data_holder.hpp"
+#include <linux/joystick.h>
+#endif
+
+namespace bench
+{
+#ifdef LINUX
+    void run_gamepad_benchmarks(runner &r)
+    {
+        gamepad::gamepad_binding binding;
+        binding.init_default();
+        element_data_holder holder;
+
+        /* Both sticks moving, a trigger being pulled and a button
+         * pressed and released every now and then */
+        std::vector<js_event> events;
+        for (int i = 0; i < 64; i++) {
+            js_event e = {};
+            e.type = JS_EVENT_AXIS;
+            e.number = static_cast<uint8_t>(i % 6);
+            e.value = static_cast<int16_t>(i * 1000 - 32000);
+            events.emplace_back(e);
+        }
+        for (int i = 0; i < 64; i += 16) {
+            events[i].type = JS_EVENT_BUTTON;
+            events[i].number = static_cast<uint8_t>(i / 16);
+            events[i].value = (i / 16) % 2;
+        }
+
+        size_t index = 0;
+        r.run("gamepad/handle_event", 1, RATE_GAMEPAD, [&]
+        {
+            binding.handle_event(0, &holder, &events[index++ % events.size()]);
+        });
+    }
+#else
+    /* Gamepads are read through xinput on windows, there's no binding */
+    void run_gamepad_benchmarks(runner &)
+    {
+    }
+#endif
+}
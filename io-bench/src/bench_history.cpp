@@ -0,0 +1,91 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "bench.hpp"
+#include "util/element/element_data_holder.hpp"
+#include "util/history/input_entry.hpp"
+#include "util/history/key_names.hpp"
+#include "sources/input_history.hpp"
+#include "util/frame_scheduler.hpp"
+#include <uiohook.h>
+#include <cstdlib>
+
+/* The scheduler needs obs, history entries get their state from here */
+static const input_state* frame_state = nullptr;
+
+const input_state* frame_scheduler::get_state(const uint8_t source)
+{
+    return source == 0 ? frame_state : nullptr;
+}
+
+namespace bench
+{
+    static const uint16_t entry_keys[] = {VC_CONTROL_L, VC_SHIFT_L, VC_ALT_L, VC_T, VC_F5};
+
+    /* key_names only loads from files, so a config naming all
+     * keycodes used here is written to the temp directory */
+    static bool load_names(key_names &names)
+    {
+#ifdef _WIN32
+        const char* dir = getenv("TEMP");
+#else
+        const char* dir = getenv("TMPDIR");
+#endif
+        const auto path = std::string(dir ? dir : ".") + "/io-bench-key-names.ini";
+        const auto file = fopen(path.c_str(), "w");
+        if (!file)
+            return false;
+
+        for (uint16_t vc = 0; vc < 0x100; vc++)
+            fprintf(file, "%x=Key %u\n", vc, vc);
+        for (const auto &vc : entry_keys)
+            fprintf(file, "%x=Name of %x\n", vc, vc);
+        fclose(file);
+
+        names.load_from_file(path.c_str());
+        remove(path.c_str());
+        return !names.empty();
+    }
+
+    void run_history_benchmarks(runner &r)
+    {
+        input_state state;
+        for (const auto &vc : entry_keys)
+            state.add_data(vc, element_data_button(STATE_PRESSED));
+        frame_state = &state;
+
+        sources::history_settings settings;
+        settings.flags = sources::FLAG_INCLUDE_MOUSE;
+        input_entry entry;
+
+        /* Frame state lookup and populate_vector */
+        r.run("history/collect_inputs", 1, RATE_FRAME, [&]
+        {
+            entry.clear();
+            entry.collect_inputs(&settings);
+        });
+
+        /* One entry is built per new key combination */
+        key_names no_names;
+        r.run("history/build_string/builtin", 1, RATE_TYPING, [&]
+        {
+            keep(entry.build_string(&no_names, false));
+        });
+
+        key_names names;
+        if (load_names(names)) {
+            r.run("history/build_string/custom", 1, RATE_TYPING, [&]
+            {
+                keep(entry.build_string(&names, false));
+            });
+        } else {
+            blog(LOG_WARNING, "Couldn't write key name config, skipping history/build_string/custom");
+        }
+
+        frame_state = nullptr;
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "bench.hpp"
+#include "network/io_client.hpp"
+#include "hook/xinput_fix.hpp"
+#include <util/platform.h>
+#include <uiohook.h>
+
+namespace bench
+{
+    /* Messages are written the same way io-client sends them,
+     * without the message id which io_server reads first */
+    static netlib_byte_buf* button_message()
+    {
+        const auto buf = netlib_alloc_byte_buf(32);
+        const uint16_t keys[] = {VC_CONTROL_L, VC_SHIFT_L, VC_W, VC_MOUSE_BUTTON1};
+
+        netlib_write_uint8(buf, sizeof(keys) / sizeof(keys[0]));
+        for (const auto &vc : keys)
+            netlib_write_uint16(buf, vc);
+        return buf;
+    }
+
+    static netlib_byte_buf* mouse_message()
+    {
+        const auto buf = netlib_alloc_byte_buf(16);
+        netlib_write_int16(buf, 960);
+        netlib_write_int16(buf, 540);
+        netlib_write_int8(buf, WHEEL_DIR_UP);
+        netlib_write_int16(buf, 1);
+        netlib_write_uint8(buf, 0);
+        return buf;
+    }
+
+    static netlib_byte_buf* gamepad_message()
+    {
+        const auto buf = netlib_alloc_byte_buf(32);
+        netlib_write_uint8(buf, 0);
+        netlib_write_uint16(buf, xinput_fix::CODE_A | xinput_fix::CODE_LEFT_THUMB);
+        netlib_write_float(buf, 0.5f);
+        netlib_write_float(buf, -0.25f);
+        netlib_write_float(buf, 0.f);
+        netlib_write_float(buf, 1.f);
+        netlib_write_uint8(buf, 0);
+        netlib_write_uint8(buf, 200);
+        return buf;
+    }
+
+    static netlib_byte_buf* time_message()
+    {
+        const auto buf = netlib_alloc_byte_buf(16);
+        const auto now = os_gettime_ns();
+        netlib_write_uint32(buf, static_cast<uint32_t>(now >> 32));
+        netlib_write_uint32(buf, static_cast<uint32_t>(now));
+        netlib_write_uint32(buf, 500);
+        return buf;
+    }
+
+    static void decode_benchmark(runner &r, const char* name, network::io_client &client, netlib_byte_buf* buf,
+                                 const message msg)
+    {
+        r.run(name, 1, RATE_REMOTE, [&]
+        {
+            buf->read_pos = 0;
+            if (!client.read_event(buf, msg))
+                abort(); /* Would only measure the error path */
+        });
+        netlib_free_byte_buf(buf);
+    }
+
+    void run_network_benchmarks(runner &r)
+    {
+        /* The client deletes its name and closes the socket, which is null */
+        network::io_client client(new char(0), nullptr, 0);
+
+        decode_benchmark(r, "protocol/read_event/buttons", client, button_message(), MSG_BUTTON_DATA);
+        decode_benchmark(r, "protocol/read_event/mouse", client, mouse_message(), MSG_MOUSE_DATA);
+        decode_benchmark(r, "protocol/read_event/gamepad", client, gamepad_message(), MSG_GAMEPAD_DATA);
+        /* Includes recording the capture to ingest latency */
+        decode_benchmark(r, "protocol/read_event/time", client, time_message(), MSG_TIME_DATA);
+    }
+}
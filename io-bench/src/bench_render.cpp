@@ -0,0 +1,53 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "bench.hpp"
+#include "util/sprite_batch.hpp"
+
+namespace bench
+{
+    /* Full size keyboard: 104 keys on a 1024x512 texture,
+     * every fourth one pressed, plus a mouse arrow */
+    static void build_keyboard(sprite_batch &batch, const float angle)
+    {
+        batch.begin(1024, 512);
+        for (int i = 0; i < 104; i++) {
+            const gs_rect rect = {(i % 22) * 46, (i / 22) * 46 + (i % 4 == 0 ? 256 : 0), 44, 44};
+            vec2 pos = {};
+            pos.x = static_cast<float>((i % 22) * 46);
+            pos.y = static_cast<float>((i / 22) * 46);
+            batch.add(rect, pos);
+        }
+
+        const gs_rect arrow = {0, 460, 32, 32};
+        vec2 pos = {};
+        pos.x = 980.f;
+        pos.y = 200.f;
+        batch.add(arrow, pos, angle);
+    }
+
+    void run_render_benchmarks(runner &r)
+    {
+        sprite_batch batch;
+        auto angle = 0.f;
+
+        r.run("render/batch/build_keyboard", 105, RATE_FRAME, [&]
+        {
+            angle += 0.01f;
+            build_keyboard(batch, angle);
+            keep(batch.quads());
+        });
+
+        /* With the shim the upload is just the copy into the vertex buffer */
+        r.run("render/batch/draw_keyboard", 105, RATE_FRAME, [&]
+        {
+            angle += 0.01f;
+            build_keyboard(batch, angle);
+            batch.draw(nullptr, reinterpret_cast<gs_texture_t*>(&batch));
+        });
+    }
+}
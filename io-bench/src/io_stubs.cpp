@@ -0,0 +1,45 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "util/history/history_icons.hpp"
+#include "util/config.hpp"
+
+/* Parts of io-obs that the built files reference, but which need
+ * obs or Qt. Config values keep the defaults from config.cpp */
+
+namespace io_config
+{
+    input_filter io_window_filters;
+    std::mutex filter_mutex;
+
+    bool control = false;
+    bool remote = false;
+    bool gamepad = true;
+    bool uiohook = true;
+    bool evdev = false;
+    bool overlay = true;
+    bool history = true;
+    bool regex = false;
+    bool log_flag = false;
+    int filter_mode = 0;
+    uint16_t refresh_rate = 250;
+    uint16_t port = 1608;
+}
+
+/* Window filters need Qt, input is never blocked */
+input_filter::~input_filter() = default;
+
+bool input_filter::input_blocked()
+{
+    return false;
+}
+
+void history_icons::draw(uint16_t vc, vec2* pos)
+{
+    UNUSED_PARAMETER(vc);
+    UNUSED_PARAMETER(pos);
+}
@@ -0,0 +1,535 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "latency.hpp"
+#include "../../ccl/ccl.hpp"
+#include "hook/hook_helper.hpp"
+#include "hook/evdev_hook.hpp"
+#include "hook/gamepad_hook.hpp"
+#include "network/io_server.hpp"
+#include "network/remote_connection.hpp"
+#include "sources/input_source.hpp"
+#include "sources/input_history.hpp"
+#include "util/element/element_data_holder.hpp"
+#include "util/history/input_entry.hpp"
+#include "util/file_watcher.hpp"
+#include "util/frame_scheduler.hpp"
+#include "util/layout_cache.hpp"
+#include "util/layout_constants.hpp"
+#include "util/layout_format.hpp"
+#include "util/overlay.hpp"
+#include "util/config.hpp"
+#include <util/platform.h>
+#include <linux/input.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+
+namespace latency
+{
+    /* How long a device may take to show up before the probe counts as unsupported */
+    static const uint64_t discovery_timeout = 5000ull * 1000 * 1000;
+
+    const char* path_name(const input_path path)
+    {
+        switch (path) {
+            case PATH_XRECORD:
+                return "xrecord";
+            case PATH_EVDEV:
+                return "evdev";
+            case PATH_JS:
+                return "js";
+            case PATH_REMOTE:
+                return "remote";
+            default:
+                return "invalid";
+        }
+    }
+
+    const char* probe_name(const probe_type probe)
+    {
+        switch (probe) {
+            case PROBE_KEY:
+                return "keyboard";
+            case PROBE_MOUSE:
+                return "mouse";
+            case PROBE_PAD:
+                return "gamepad";
+            default:
+                return "invalid";
+        }
+    }
+
+    /* The parts of obs a source would see: the scheduler tick on the
+     * graphics thread, then an overlay and a history entry reading the
+     * frame's state, the same way input_source and input_queue do
+     */
+    class pipeline
+    {
+    public:
+        pipeline(const uint8_t source, const double fps) : m_source(source)
+        {
+            m_interval = fps > 0.0 ? static_cast<uint64_t>(1000000000.0 / fps) : 0;
+            m_next_frame = os_gettime_ns();
+
+            m_history.flags = sources::FLAG_INCLUDE_MOUSE | sources::FLAG_INCLUDE_PAD;
+            m_history.selected_source = source;
+            m_settings.selected_source = source;
+        }
+
+        ~pipeline()
+        {
+            m_overlay.reset();
+            if (!m_settings.layout_file.empty())
+                remove(m_settings.layout_file.c_str());
+        }
+
+        /* One button for the probe key and the pad and the mouse movement,
+         * written as ini layout or as the .iolayout io-cct would compile it to */
+        bool load_layout(const uint16_t key_vc, const bool compiled = false)
+        {
+            const char* dir = getenv("TMPDIR");
+            m_settings.layout_file = std::string(dir ? dir : "/tmp") + "/io-latency-" + std::to_string(getpid()) +
+                                     (compiled ? IOLAYOUT_EXTENSION : ".ini");
+            m_settings.image_file = m_settings.layout_file; /* Images aren't decoded */
+
+            if (compiled) {
+                if (!write_compiled(m_settings.layout_file, key_vc))
+                    return false;
+            } else {
+                auto cfg = ccl_config(m_settings.layout_file, "io-latency layout");
+                cfg.free_nodes();
+                cfg.add_int(CFG_TOTAL_WIDTH, "", LAYOUT_SIZE, true);
+                cfg.add_int(CFG_TOTAL_HEIGHT, "", LAYOUT_SIZE, true);
+                cfg.add_string(CFG_FIRST_ID, "", "key", true);
+                add_element(cfg, "key", BUTTON, key_vc, 0, "pad");
+                add_element(cfg, "pad", BUTTON, VC_PAD_A, 2, "mouse");
+                add_element(cfg, "mouse", MOUSE_STATS, VC_MOUSE_DATA, 4, nullptr);
+                cfg.add_int("mouse" CFG_MOUSE_RADIUS, "", 10, true);
+                cfg.add_int("mouse" CFG_MOUSE_TYPE, "", 0, true);
+                cfg.write(false);
+            }
+
+            m_overlay.reset(new overlay(&m_settings));
+            return m_overlay->is_loaded();
+        }
+
+        /* Hands the overlay a state directly, without hooks or scheduler */
+        void refresh(const input_state &state)
+        {
+            m_overlay->refresh_data(&state);
+        }
+
+        /* Draws like the graphics thread, returns the quads drawn into the cache */
+        size_t draw()
+        {
+            m_overlay->draw(nullptr);
+            return m_overlay->cache_quads();
+        }
+
+        void set_gamepad(const uint8_t pad)
+        {
+            m_settings.gamepad = pad;
+            m_history.target_gamepad = pad;
+        }
+
+        /* Sleeps until the next frame is due, calls inject at its time
+         * if that comes first. Without a frame rate this never waits */
+        template<class F>
+        void wait(uint64_t inject_at, F inject)
+        {
+            if (inject_at && inject_at <= m_next_frame) {
+                sleep_until(inject_at);
+                inject();
+            }
+
+            if (m_interval) {
+                sleep_until(m_next_frame);
+                m_next_frame += m_interval;
+                /* Don't catch up on frames that were missed */
+                if (m_next_frame < os_gettime_ns())
+                    m_next_frame = os_gettime_ns() + m_interval;
+            }
+        }
+
+        /* What a frame does for the overlay and history sources */
+        void frame()
+        {
+            frame_scheduler::tick_proc(nullptr, m_interval ? m_interval / 1000000000.f : 0.f);
+            const auto state = frame_scheduler::get_state(m_source);
+            m_state = state;
+            m_overlay->refresh_data(state);
+
+            m_entry.clear();
+            m_entry.collect_inputs(&m_history);
+        }
+
+        const input_state* state() const
+        {
+            return m_state;
+        }
+
+        bool key_visible(const uint16_t vc) const
+        {
+            const auto data = m_overlay->get_data(vc);
+            return data && data->get_button() && data->get_button()->get_state() == STATE_PRESSED;
+        }
+
+        /* Mouse position the overlay has */
+        int32_t mouse_x() const
+        {
+            const auto data = m_overlay->get_data(VC_MOUSE_DATA);
+            const auto stats = data ? data->get_mouse_stats() : nullptr;
+            return stats ? stats->get_mouse_x() : INT32_MIN;
+        }
+
+        bool history_visible() const
+        {
+            return m_entry.get_input_count() > 0;
+        }
+
+    private:
+        /* Elements are next to each other, so buttons can be baked into the background */
+        static const int32_t LAYOUT_SIZE = 8;
+
+        static iolayout_element make_record(const element_type type, const uint16_t vc, const int32_t x)
+        {
+            iolayout_element e{};
+            e.type = static_cast<int8_t>(type);
+            e.keycode = vc;
+            e.z_level = 1;
+            e.x = x;
+            e.w = e.h = 1;
+            return e;
+        }
+
+        /* Same elements as the ini layout */
+        static bool write_compiled(const std::string &path, const uint16_t key_vc)
+        {
+            iolayout_element records[] = {make_record(BUTTON, key_vc, 0), make_record(BUTTON, VC_PAD_A, 2),
+                                          make_record(MOUSE_STATS, VC_MOUSE_DATA, 4)};
+            records[2].radius = 10;
+
+            iolayout_header header{};
+            memcpy(header.magic, IOLAYOUT_MAGIC, IOLAYOUT_MAGIC_SIZE);
+            header.version = IOLAYOUT_VERSION;
+            header.cx = header.cy = LAYOUT_SIZE;
+            header.element_count = sizeof(records) / sizeof(records[0]);
+            header.elements_offset = sizeof(header);
+            header.atlas_offset = sizeof(header) + sizeof(records);
+
+            const auto f = fopen(path.c_str(), "wb");
+            if (!f)
+                return false;
+            const auto written = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                                 fwrite(records, sizeof(records), 1, f) == 1;
+            return fclose(f) == 0 && written;
+        }
+
+        static void add_element(ccl_config &cfg, const std::string &id, const element_type type, const uint16_t vc,
+                                const int32_t x, const char* next)
+        {
+            cfg.add_int(id + CFG_TYPE, "", type, true);
+            cfg.add_int(id + CFG_KEY_CODE, "", vc, true);
+            cfg.add_int(id + CFG_Z_LEVEL, "", 1, true);
+            cfg.add_rect(id + CFG_MAPPING, "", 0, 0, 1, 1, true);
+            cfg.add_point(id + CFG_POS, "", x, 0, true);
+            if (next)
+                cfg.add_string(id + CFG_NEXT_ID, "", next, true);
+        }
+
+        static void sleep_until(const uint64_t time)
+        {
+            const auto now = os_gettime_ns();
+            if (time > now)
+                std::this_thread::sleep_for(std::chrono::nanoseconds(time - now));
+        }
+
+        uint8_t m_source;
+        uint64_t m_interval;
+        uint64_t m_next_frame;
+        const input_state* m_state = nullptr;
+        sources::overlay_settings m_settings;
+        sources::history_settings m_history;
+        std::unique_ptr<overlay> m_overlay;
+        input_entry m_entry;
+    };
+
+    /* Injects and checks one kind of input */
+    class probe
+    {
+    public:
+        probe(const probe_type type, devices &dev, const uint16_t key) : m_type(type)
+        {
+            switch (type) {
+                case PROBE_KEY:
+                    m_device = &dev.keyboard;
+                    m_vc = evdev::key_to_vc(key);
+                    m_key = key;
+                    break;
+                case PROBE_MOUSE:
+                    m_device = &dev.mouse;
+                    break;
+                case PROBE_PAD:
+                    m_device = &dev.gamepad;
+                    m_vc = VC_PAD_A;
+                    m_key = BTN_SOUTH;
+                    break;
+                default:;
+            }
+        }
+
+        bool has_history() const
+        {
+            return m_type != PROBE_MOUSE;
+        }
+
+        uint64_t press(const pipeline &p)
+        {
+            if (m_type == PROBE_MOUSE) {
+                /* Back and forth, so the pointer never ends up at the screen edge */
+                m_mouse_x = p.mouse_x();
+                m_direction = -m_direction;
+                return m_device->send(EV_REL, REL_X, m_direction);
+            }
+            return m_device->send(EV_KEY, m_key, 1);
+        }
+
+        void release()
+        {
+            if (m_type != PROBE_MOUSE)
+                m_device->send(EV_KEY, m_key, 0);
+        }
+
+        bool overlay_visible(const pipeline &p) const
+        {
+            return m_type == PROBE_MOUSE ? p.mouse_x() != m_mouse_x : p.key_visible(m_vc);
+        }
+
+        bool released(const pipeline &p) const
+        {
+            return m_type == PROBE_MOUSE || (!p.key_visible(m_vc) && !p.history_visible());
+        }
+
+        /* Finds the slot the virtual pad got, the
+         * kernel numbers them after all real ones */
+        int find_pad(const pipeline &p) const
+        {
+            const auto state = p.state();
+            for (uint8_t i = 0; state && i < PAD_COUNT; i++) {
+                const auto data = state->get_by_gamepad(i, VC_PAD_A);
+                if (data && data->get_button() && data->get_button()->get_state() == STATE_PRESSED)
+                    return i;
+            }
+            return -1;
+        }
+
+    private:
+        probe_type m_type;
+        uinput_device* m_device = nullptr;
+        uint16_t m_vc = 0;
+        uint16_t m_key = 0;
+        int32_t m_mouse_x = 0;
+        int32_t m_direction = 1;
+    };
+
+    /* Runs frames until done returns true or the time is up */
+    template<class F>
+    static bool run_until(pipeline &p, const uint64_t timeout, F done)
+    {
+        const auto end = os_gettime_ns() + timeout;
+        while (os_gettime_ns() < end) {
+            p.wait(0, [] {});
+            p.frame();
+            if (done())
+                return true;
+        }
+        return false;
+    }
+
+    static void measure_probe(pipeline &p, probe &pr, const options &opt, result &overlay_result,
+                              result &history_result)
+    {
+        const uint64_t timeout = opt.timeout_ms * 1000000ull;
+
+        /* New devices are picked up by rescans and hotplug events, so the
+         * first press can take a while. It also tells which slot the pad got */
+        pr.press(p);
+        if (!run_until(p, discovery_timeout, [&] { return pr.find_pad(p) >= 0 || pr.overlay_visible(p); })) {
+            overlay_result.error = history_result.error = "Injected input never arrived";
+            pr.release();
+            return;
+        }
+        if (pr.find_pad(p) >= 0)
+            p.set_gamepad(static_cast<uint8_t>(pr.find_pad(p)));
+        pr.release();
+        run_until(p, timeout, [&] { return pr.released(p); });
+
+        std::mt19937 rng(std::random_device{}());
+        std::uniform_int_distribution<uint64_t> gap(10000000, 30000000);
+
+        for (uint32_t i = 0; i < opt.samples; i++) {
+            /* Random gaps put the injection at a random point of the frame */
+            uint64_t inject_at = os_gettime_ns() + gap(rng);
+            uint64_t pressed = 0, overlay_time = 0, history_time = 0;
+
+            while (!pressed)
+                p.wait(inject_at, [&] { pressed = pr.press(p); });
+
+            const auto end = pressed + timeout;
+            do {
+                p.frame();
+                const auto now = os_gettime_ns();
+                if (!overlay_time && pr.overlay_visible(p))
+                    overlay_time = now;
+                if (!history_time && pr.has_history() && p.history_visible())
+                    history_time = now;
+
+                if (overlay_time && (history_time || !pr.has_history()))
+                    break;
+                p.wait(0, [] {});
+            } while (os_gettime_ns() < end);
+
+            if (overlay_time)
+                overlay_result.times.emplace_back(overlay_time - pressed);
+            else
+                overlay_result.lost++;
+
+            if (history_time)
+                history_result.times.emplace_back(history_time - pressed);
+            else
+                history_result.lost++;
+
+            pr.release();
+            run_until(p, timeout, [&] { return pr.released(p); });
+        }
+    }
+
+    static bool start_hooks(const input_path path, const options &opt, std::string &error)
+    {
+        io_config::evdev = path == PATH_EVDEV;
+        hook::init_data_holder();
+
+        switch (path) {
+            case PATH_XRECORD:
+                hook::start_hook();
+                if (!hook::hook_initialized)
+                    error = "libuiohook couldn't start, is there an X server?";
+                break;
+            case PATH_EVDEV:
+                evdev::start_evdev_hook();
+                gamepad::start_pad_hook();
+                if (!evdev::evdev_hook_state)
+                    error = "evdev hook couldn't start";
+                break;
+            case PATH_JS:
+                gamepad::start_pad_hook();
+                if (!gamepad::gamepad_hook_state)
+                    error = "Gamepad hook couldn't start";
+                break;
+            case PATH_REMOTE:
+                network::local_input = false;
+                network::start_network(opt.port);
+                if (!network::network_flag) {
+                    error = "Couldn't start the server";
+                    break;
+                }
+
+                blog(LOG_INFO, "Waiting %us for io-client to connect to port %u", opt.client_wait_s, opt.port);
+                for (uint32_t i = 0; i < opt.client_wait_s * 10 && !network::server_instance->client_count(); i++)
+                    os_sleep_ms(100);
+                if (!network::server_instance->client_count())
+                    error = "No io-client connected";
+                break;
+            default:;
+        }
+        return error.empty();
+    }
+
+    std::vector<result> measure_path(const input_path path, devices &dev, const options &opt)
+    {
+        std::vector<probe_type> probes;
+        switch (path) {
+            case PATH_XRECORD:
+            case PATH_REMOTE:
+                probes = {PROBE_KEY, PROBE_MOUSE};
+                break;
+            case PATH_EVDEV:
+                probes = {PROBE_KEY, PROBE_MOUSE, PROBE_PAD};
+                break;
+            case PATH_JS:
+                probes = {PROBE_PAD};
+                break;
+            default:;
+        }
+
+        std::vector<result> results;
+        std::string error;
+        const auto started = start_hooks(path, opt, error);
+
+        pipeline p(path == PATH_REMOTE ? 1 : 0, opt.fps);
+        if (started && !p.load_layout(evdev::key_to_vc(opt.key)))
+            error = "Couldn't load the layout";
+
+        for (const auto &type : probes) {
+            result overlay_result{path, type, "overlay", error, {}, 0};
+            result history_result{path, type, "history", error, {}, 0};
+
+            if (error.empty()) {
+                probe pr(type, dev, opt.key);
+                measure_probe(p, pr, opt, overlay_result, history_result);
+            }
+
+            results.emplace_back(overlay_result);
+            if (type != PROBE_MOUSE)
+                results.emplace_back(history_result);
+        }
+        return results;
+    }
+
+    bool check_layouts(const options &opt, std::string &error)
+    {
+        const auto vc = evdev::key_to_vc(opt.key);
+        for (const auto compiled : {false, true}) {
+            const auto format = compiled ? "compiled" : "ini";
+            pipeline p(0, 0.0);
+            if (!p.load_layout(vc, compiled)) {
+                error = std::string("Couldn't load the ") + format + " layout";
+                break;
+            }
+
+            /* Released buttons are baked into the background,
+             * only the mouse element is drawn into the cache */
+            if (p.draw() != 1) {
+                error = std::string("The ") + format + " layout draws released buttons every time";
+                break;
+            }
+
+            input_state state;
+            state.add_data(vc, element_data_button(STATE_PRESSED));
+            p.refresh(state);
+            if (!p.key_visible(vc) || p.draw() != 2) {
+                error = std::string("The ") + format + " layout doesn't show the key press";
+                break;
+            }
+
+            state.add_data(vc, element_data_button(STATE_RELEASED));
+            p.refresh(state);
+            if (p.key_visible(vc) || p.draw() != 1) {
+                error = std::string("The ") + format + " layout doesn't show the key release";
+                break;
+            }
+        }
+
+        /* Both are started by the overlay */
+        file_watcher::stop();
+        layout_loader::stop();
+        return error.empty();
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include "uinput_device.hpp"
+#include <string>
+#include <vector>
+
+namespace latency
+{
+    /* Routes input takes into the plugin */
+    enum input_path
+    {
+        PATH_XRECORD,   /* libuiohook, keyboard and mouse through the X server */
+        PATH_EVDEV,     /* evdev hook and evdev gamepads */
+        PATH_JS,        /* Gamepads through /dev/input/js* */
+        PATH_REMOTE,    /* io-client on this machine sending over loopback */
+        PATH_COUNT
+    };
+
+    /* What is injected and checked */
+    enum probe_type
+    {
+        PROBE_KEY,      /* Key press, checked in the overlay and history */
+        PROBE_MOUSE,    /* One pixel mouse move, checked in the overlay */
+        PROBE_PAD,      /* Gamepad button press, checked in the overlay and history */
+        PROBE_COUNT
+    };
+
+    struct options
+    {
+        uint32_t samples = 500;             /* Measured presses per probe */
+        double fps = 60.0;                  /* Frame rate of the simulated graphics thread, 0 = no wait */
+        uint16_t key = 97;                  /* Linux key code of the probe key, KEY_RIGHTCTRL */
+        uint32_t timeout_ms = 1000;         /* Samples slower than this are counted as lost */
+        uint32_t client_wait_s = 30;        /* How long the remote path waits for io-client */
+        uint16_t port = 1608;
+        bool paths[PATH_COUNT] = {true, true, true, true};
+    };
+
+    struct devices
+    {
+        uinput_device keyboard, mouse, gamepad;
+    };
+
+    /* Latency of one probe up to one stage (overlay or history)
+     * of one path, or the reason why it couldn't be measured */
+    struct result
+    {
+        input_path path;
+        probe_type probe;
+        const char* stage;
+        std::string error;
+        std::vector<uint64_t> times;    /* Injection to visible in ns */
+        uint32_t lost = 0;
+    };
+
+    const char* path_name(input_path path);
+
+    const char* probe_name(probe_type probe);
+
+    /* Starts the hooks of path, then injects samples of every probe the
+     * path supports and runs a simulated frame loop until the change is
+     * visible. Hooks can't be restarted, so this runs once per process */
+    std::vector<result> measure_path(input_path path, devices &dev, const options &opt);
+
+    /* Loads the probe layout as ini and as compiled layout and checks that both show
+     * a press and release of the probe key, drawing released buttons only into the
+     * background. Needs no devices, false and the reason in error if a layout failed */
+    bool check_layouts(const options &opt, std::string &error);
+}
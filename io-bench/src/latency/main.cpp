@@ -0,0 +1,256 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "latency.hpp"
+#include <util/platform.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#define IO_LATENCY_FORMAT 1
+
+static void print_usage(const char* name)
+{
+    printf("Usage: %s [options]\n"
+           "  --paths <list>       Comma separated paths out of xrecord,evdev,js,remote (default all)\n"
+           "  --samples <n>        Measured presses per device and path (default 500)\n"
+           "  --fps <n>            Frame rate of the simulated graphics thread, 0 = no wait (default 60)\n"
+           "  --key <code>         Linux key code used as probe key (default 97, right control)\n"
+           "  --timeout <ms>       Samples slower than this count as lost (default 1000)\n"
+           "  --port <n>           Port io-client connects to for the remote path (default 1608)\n"
+           "  --client-wait <s>    How long to wait for io-client (default 30)\n"
+           "  --output <file>      Write results to file instead of stdout\n"
+           "  --check              Only check that ini and compiled layouts show the probe key\n"
+           "Needs write access to /dev/uinput. Results go to stdout, progress is printed to stderr\n", name);
+}
+
+static bool parse_paths(const char* list, latency::options &opt)
+{
+    std::fill(opt.paths, opt.paths + latency::PATH_COUNT, false);
+    std::string names(list);
+    size_t start = 0;
+
+    while (start <= names.size()) {
+        auto end = names.find(',', start);
+        if (end == std::string::npos)
+            end = names.size();
+        const auto name = names.substr(start, end - start);
+
+        auto found = false;
+        for (int i = 0; i < latency::PATH_COUNT; i++) {
+            if (name == latency::path_name(static_cast<latency::input_path>(i)))
+                found = opt.paths[i] = true;
+        }
+        if (!found)
+            return false;
+        start = end + 1;
+    }
+    return true;
+}
+
+/* Nearest rank percentile of sorted times in microseconds */
+static double percentile(const std::vector<uint64_t> &times, const double p)
+{
+    auto rank = static_cast<size_t>(p * times.size() + 0.999999);
+    rank = std::max<size_t>(rank, 1);
+    return times[std::min(rank, times.size()) - 1] / 1000.0;
+}
+
+static std::string to_json(latency::result &r)
+{
+    char buf[512];
+    snprintf(buf, sizeof(buf), R"({"path": "%s", "device": "%s", "stage": "%s", )",
+             latency::path_name(r.path), latency::probe_name(r.probe), r.stage);
+    std::string json(buf);
+
+    if (!r.error.empty()) {
+        std::string error;
+        for (const auto &c : r.error) {
+            if (c == '"' || c == '\\')
+                error += '\\';
+            error += c;
+        }
+        return json + R"("error": ")" + error + "\"}";
+    }
+
+    if (r.times.empty())
+        return json + R"("error": "All samples timed out"})";
+
+    std::sort(r.times.begin(), r.times.end());
+    uint64_t total = 0;
+    for (const auto &t : r.times)
+        total += t;
+
+    snprintf(buf, sizeof(buf), R"("samples": %zu, "lost": %u, "p50_us": %.1f, "p99_us": %.1f, "p999_us": %.1f, )"
+             R"("min_us": %.1f, "max_us": %.1f, "mean_us": %.1f})", r.times.size(), r.lost,
+             percentile(r.times, 0.5), percentile(r.times, 0.99), percentile(r.times, 0.999),
+             r.times.front() / 1000.0, r.times.back() / 1000.0, total / 1000.0 / r.times.size());
+    return json + buf;
+}
+
+static void print_result(latency::result &r)
+{
+    fprintf(stderr, "%-8s %-9s %-8s ", latency::path_name(r.path), latency::probe_name(r.probe), r.stage);
+    if (!r.error.empty())
+        fprintf(stderr, "%s\n", r.error.c_str());
+    else if (r.times.empty())
+        fprintf(stderr, "all samples timed out\n");
+    else
+        fprintf(stderr, "p50 %8.1f us  p99 %8.1f us  p99.9 %8.1f us  (%zu samples, %u lost)\n",
+                percentile(r.times, 0.5), percentile(r.times, 0.99), percentile(r.times, 0.999), r.times.size(),
+                r.lost);
+}
+
+/* Hooks run threads that can't be stopped and started again,
+ * so every path is measured in its own process. The results
+ * come back through a pipe, one json object per line */
+static std::vector<std::string> run_path(const latency::input_path path, latency::devices &dev,
+                                         const latency::options &opt)
+{
+    std::vector<std::string> lines;
+    int fds[2];
+    if (pipe(fds) != 0)
+        return lines;
+
+    const auto pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        auto out = fdopen(fds[1], "w");
+        for (auto &r : latency::measure_path(path, dev, opt)) {
+            print_result(r);
+            fprintf(out, "%s\n", to_json(r).c_str());
+        }
+        fclose(out);
+        _exit(0); /* Hook threads are left running */
+    }
+
+    close(fds[1]);
+    if (pid > 0) {
+        auto in = fdopen(fds[0], "r");
+        char line[1024];
+        while (fgets(line, sizeof(line), in)) {
+            line[strcspn(line, "\n")] = '\0';
+            lines.emplace_back(line);
+        }
+        fclose(in);
+        waitpid(pid, nullptr, 0);
+    } else {
+        close(fds[0]);
+    }
+    return lines;
+}
+
+int main(int argc, char** argv)
+{
+    latency::options opt;
+    const char* output = nullptr;
+    auto check = false;
+
+    for (int i = 1; i < argc; i++) {
+        const auto arg = argv[i];
+        const auto value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (!strcmp(arg, "--check")) {
+            check = true;
+            continue;
+        }
+
+        if (!strcmp(arg, "--help") || !value) {
+            print_usage(argv[0]);
+            return strcmp(arg, "--help") ? 1 : 0;
+        }
+
+        if (!strcmp(arg, "--paths")) {
+            if (!parse_paths(value, opt)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(arg, "--samples")) {
+            opt.samples = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else if (!strcmp(arg, "--fps")) {
+            opt.fps = strtod(value, nullptr);
+        } else if (!strcmp(arg, "--key")) {
+            opt.key = static_cast<uint16_t>(strtoul(value, nullptr, 10));
+        } else if (!strcmp(arg, "--timeout")) {
+            opt.timeout_ms = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else if (!strcmp(arg, "--port")) {
+            opt.port = static_cast<uint16_t>(strtoul(value, nullptr, 10));
+        } else if (!strcmp(arg, "--client-wait")) {
+            opt.client_wait_s = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else if (!strcmp(arg, "--output")) {
+            output = value;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (opt.samples == 0 || opt.fps < 0.0 || opt.timeout_ms == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (check) {
+        std::string error;
+        if (!latency::check_layouts(opt, error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        fprintf(stderr, "Layouts show the probe key\n");
+        return 0;
+    }
+
+    /* Devices stay the same for all paths, so
+     * slot numbers and discovery only happen once */
+    latency::devices dev;
+    if (!dev.keyboard.create(uinput_device::KEYBOARD) || !dev.mouse.create(uinput_device::MOUSE) ||
+        !dev.gamepad.create(uinput_device::GAMEPAD)) {
+        fprintf(stderr, "Couldn't create virtual devices, is /dev/uinput writable?\n");
+        return 1;
+    }
+    /* Give udev time to create the device nodes */
+    os_sleep_ms(500);
+
+    std::vector<std::string> results;
+    for (int i = 0; i < latency::PATH_COUNT; i++) {
+        if (!opt.paths[i])
+            continue;
+        fprintf(stderr, "Measuring %s path\n", latency::path_name(static_cast<latency::input_path>(i)));
+        for (auto &line : run_path(static_cast<latency::input_path>(i), dev, opt))
+            results.emplace_back(line);
+    }
+
+    dev.keyboard.destroy();
+    dev.mouse.destroy();
+    dev.gamepad.destroy();
+
+    auto out = stdout;
+    if (output && !(out = fopen(output, "w"))) {
+        fprintf(stderr, "Couldn't open %s\n", output);
+        return 1;
+    }
+
+    char date[32];
+    const auto now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(out, "{\n  \"suite\": \"io-latency\",\n  \"format\": %i,\n  \"date\": \"%s\",\n", IO_LATENCY_FORMAT,
+            date);
+    fprintf(out, "  \"fps\": %.1f,\n  \"samples\": %u,\n  \"results\": [", opt.fps, opt.samples);
+    for (size_t i = 0; i < results.size(); i++)
+        fprintf(out, "%s\n    %s", i ? "," : "", results[i].c_str());
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
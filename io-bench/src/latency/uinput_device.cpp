@@ -0,0 +1,120 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "uinput_device.hpp"
+#include <util/platform.h>
+#include <util/base.h>
+#include <linux/uinput.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+/* Sticks are centered, triggers go from zero to full */
+static const struct
+{
+    uint16_t axis;
+    int32_t min, max;
+} pad_axes[] = {{ABS_X,     -32768, 32767},
+                {ABS_Y,     -32768, 32767},
+                {ABS_RX,    -32768, 32767},
+                {ABS_RY,    -32768, 32767},
+                {ABS_Z,     0,      255},
+                {ABS_RZ,    0,      255},
+                {ABS_HAT0X, -1,     1},
+                {ABS_HAT0Y, -1,     1}};
+
+static const uint16_t pad_buttons[] = {BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST, BTN_TL, BTN_TR, BTN_SELECT,
+                                       BTN_START, BTN_MODE, BTN_THUMBL, BTN_THUMBR};
+
+uinput_device::~uinput_device()
+{
+    destroy();
+}
+
+bool uinput_device::create(const device_type type)
+{
+    destroy();
+    m_fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        blog(LOG_ERROR, "Couldn't open /dev/uinput (%s)", strerror(errno));
+        return false;
+    }
+
+    uinput_setup setup = {};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1608;
+    auto ok = true;
+
+    switch (type) {
+        case KEYBOARD:
+            /* evdev only picks up devices that look like a full keyboard */
+            strncpy(setup.name, "io-latency keyboard", UINPUT_MAX_NAME_SIZE - 1);
+            setup.id.product = 1;
+            ok = ioctl(m_fd, UI_SET_EVBIT, EV_KEY) == 0;
+            for (int key = KEY_ESC; ok && key <= KEY_F24; key++)
+                ok = ioctl(m_fd, UI_SET_KEYBIT, key) == 0;
+            break;
+        case MOUSE:
+            strncpy(setup.name, "io-latency mouse", UINPUT_MAX_NAME_SIZE - 1);
+            setup.id.product = 2;
+            ok = ioctl(m_fd, UI_SET_EVBIT, EV_KEY) == 0 && ioctl(m_fd, UI_SET_KEYBIT, BTN_LEFT) == 0 &&
+                 ioctl(m_fd, UI_SET_KEYBIT, BTN_RIGHT) == 0 && ioctl(m_fd, UI_SET_KEYBIT, BTN_MIDDLE) == 0 &&
+                 ioctl(m_fd, UI_SET_EVBIT, EV_REL) == 0 && ioctl(m_fd, UI_SET_RELBIT, REL_X) == 0 &&
+                 ioctl(m_fd, UI_SET_RELBIT, REL_Y) == 0 && ioctl(m_fd, UI_SET_RELBIT, REL_WHEEL) == 0;
+            break;
+        case GAMEPAD:
+            strncpy(setup.name, "io-latency gamepad", UINPUT_MAX_NAME_SIZE - 1);
+            setup.id.product = 3;
+            ok = ioctl(m_fd, UI_SET_EVBIT, EV_KEY) == 0 && ioctl(m_fd, UI_SET_EVBIT, EV_ABS) == 0;
+            for (const auto &button : pad_buttons)
+                ok = ok && ioctl(m_fd, UI_SET_KEYBIT, button) == 0;
+
+            for (const auto &axis : pad_axes) {
+                uinput_abs_setup abs = {};
+                abs.code = axis.axis;
+                abs.absinfo.minimum = axis.min;
+                abs.absinfo.maximum = axis.max;
+                ok = ok && ioctl(m_fd, UI_SET_ABSBIT, axis.axis) == 0 && ioctl(m_fd, UI_ABS_SETUP, &abs) == 0;
+            }
+            break;
+    }
+
+    if (!ok || ioctl(m_fd, UI_DEV_SETUP, &setup) < 0 || ioctl(m_fd, UI_DEV_CREATE) < 0) {
+        blog(LOG_ERROR, "Couldn't create virtual device %s (%s)", setup.name, strerror(errno));
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void uinput_device::destroy()
+{
+    if (m_fd >= 0) {
+        ioctl(m_fd, UI_DEV_DESTROY);
+        close(m_fd);
+    }
+    m_fd = -1;
+}
+
+bool uinput_device::write_event(const uint16_t type, const uint16_t code, const int32_t value)
+{
+    input_event ev = {};
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    return write(m_fd, &ev, sizeof(ev)) == sizeof(ev);
+}
+
+uint64_t uinput_device::send(const uint16_t type, const uint16_t code, const int32_t value)
+{
+    const auto time = os_gettime_ns();
+    if (!write_event(type, code, value) || !write_event(EV_SYN, SYN_REPORT, 0))
+        blog(LOG_WARNING, "Couldn't write to virtual device (%s)", strerror(errno));
+    return time;
+}
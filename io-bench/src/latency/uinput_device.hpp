@@ -0,0 +1,50 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Virtual input device created through /dev/uinput. The kernel
+ * treats it like real hardware, so its events go through the same
+ * path (evdev, js, X server) as a keyboard, mouse or gamepad would.
+ * Needs write access to /dev/uinput
+ */
+class uinput_device
+{
+public:
+    enum device_type
+    {
+        KEYBOARD, MOUSE, GAMEPAD
+    };
+
+    uinput_device() = default;
+
+    ~uinput_device();
+
+    uinput_device(const uinput_device &) = delete;
+
+    uinput_device &operator=(const uinput_device &) = delete;
+
+    bool create(device_type type);
+
+    void destroy();
+
+    bool valid() const
+    {
+        return m_fd >= 0;
+    }
+
+    /* Sends one event followed by SYN_REPORT and returns
+     * the os_gettime_ns() time right before it was written */
+    uint64_t send(uint16_t type, uint16_t code, int32_t value);
+
+private:
+    bool write_event(uint16_t type, uint16_t code, int32_t value);
+
+    int m_fd = -1;
+};
@@ -0,0 +1,87 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "bench.hpp"
+#include <cstdlib>
+#include <cstring>
+
+static void print_usage(const char* name)
+{
+    printf("Usage: %s [options]\n"
+           "  --filter <text>      Only run benchmarks whose name contains text\n"
+           "  --samples <n>        Measurements per benchmark (default 15)\n"
+           "  --sample-time <ms>   Minimum duration of one measurement (default 20)\n"
+           "  --format <json|csv>  Output format (default json)\n"
+           "  --output <file>      Write results to file instead of stdout\n"
+           "  --list               Print benchmark names and exit\n"
+           "Results go to stdout, progress is printed to stderr\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    bench::options opt;
+    const char* output = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const auto arg = argv[i];
+        const auto value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (!strcmp(arg, "--list")) {
+            opt.list = true;
+            continue;
+        }
+
+        if (!strcmp(arg, "--help") || !value) {
+            print_usage(argv[0]);
+            return strcmp(arg, "--help") ? 1 : 0;
+        }
+
+        if (!strcmp(arg, "--filter")) {
+            opt.filter = value;
+        } else if (!strcmp(arg, "--samples")) {
+            opt.samples = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+        } else if (!strcmp(arg, "--sample-time")) {
+            opt.sample_time = strtod(value, nullptr) / 1000.0;
+        } else if (!strcmp(arg, "--format")) {
+            if (!strcmp(value, "csv"))
+                opt.format = bench::FORMAT_CSV;
+            else if (strcmp(value, "json") != 0) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(arg, "--output")) {
+            output = value;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (opt.samples == 0 || opt.sample_time <= 0.0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    bench::runner r(opt);
+    bench::run_data_benchmarks(r);
+    bench::run_history_benchmarks(r);
+    bench::run_network_benchmarks(r);
+    bench::run_gamepad_benchmarks(r);
+    bench::run_render_benchmarks(r);
+
+    auto out = stdout;
+    if (output && !opt.list && !(out = fopen(output, "w"))) {
+        fprintf(stderr, "Couldn't open %s\n", output);
+        return 1;
+    }
+
+    r.write(out);
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
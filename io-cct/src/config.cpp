@@ -13,7 +13,9 @@
 #include "util/texture.hpp"
 #include "util/palette.hpp"
 #include "../../ccl/ccl.hpp"
+#include "../../io-obs/util/layout_format.hpp"
 #include "element/element_analog_stick.hpp"
+#include <cstring>
 
 config::config(const char* texture_path, const char* config, const SDL_Point def_dim, const SDL_Point space, sdl_helper* h,
                dialog_element_settings* s)
@@ -311,7 +313,7 @@ void config::write_config(notifier* n)
         n->add_msg(MESSAGE_ERROR, m_helper->loc(LANG_MSG_SAVE_ERROR));
         n->add_msg(MESSAGE_ERROR, cfg.get_error_message());
     }
-    else
+    else if (write_compiled(n, width, height, flags))
     {
         const auto result = sdl_helper::format(m_helper->loc(LANG_MSG_SAVE_SUCCESS).c_str(), m_elements.size(),
                                               (end - start));
@@ -320,6 +322,51 @@ void config::write_config(notifier* n)
     cfg.free_nodes();
 }
 
+bool config::write_compiled(notifier* n, const int width, const int height, const uint8_t flags)
+{
+    auto path = m_config_path;
+    const auto dot = path.find_last_of('.');
+    const auto separator = path.find_last_of("/\\");
+    if (dot != std::string::npos && (separator == std::string::npos || dot > separator))
+        path.erase(dot);
+    path += IOLAYOUT_EXTENSION;
+
+    /* The texture can only be referenced if it's next to the layout */
+    const auto texture_separator = m_texture_path.find_last_of("/\\");
+    std::string atlas;
+    if (m_texture_path.substr(0, texture_separator + 1) == path.substr(0, separator + 1))
+        atlas = m_texture_path.substr(texture_separator + 1);
+
+    std::vector<iolayout_element> records(m_elements.size());
+    for (size_t i = 0; i < m_elements.size(); i++)
+        m_elements[i]->write_to_record(&records[i]);
+
+    iolayout_header header{};
+    memcpy(header.magic, IOLAYOUT_MAGIC, IOLAYOUT_MAGIC_SIZE);
+    header.version = IOLAYOUT_VERSION;
+    header.flags = flags;
+    header.cx = static_cast<uint32_t>(width);
+    header.cy = static_cast<uint32_t>(height);
+    header.element_count = static_cast<uint32_t>(records.size());
+    header.elements_offset = sizeof(iolayout_header);
+    header.atlas_offset = static_cast<uint32_t>(header.elements_offset + records.size() * sizeof(iolayout_element));
+    header.atlas_length = static_cast<uint32_t>(atlas.size());
+
+    const auto file = SDL_RWFromFile(path.c_str(), "wb");
+    auto ok = file != nullptr;
+    if (ok)
+    {
+        ok = SDL_RWwrite(file, &header, sizeof(header), 1) == 1;
+        ok = ok && SDL_RWwrite(file, records.data(), sizeof(iolayout_element), records.size()) == records.size();
+        ok = ok && (atlas.empty() || SDL_RWwrite(file, atlas.data(), atlas.size(), 1) == 1);
+        ok = SDL_RWclose(file) == 0 && ok;
+    }
+
+    if (!ok)
+        n->add_msg(MESSAGE_ERROR, sdl_helper::format(m_helper->loc(LANG_MSG_COMPILE_ERROR).c_str(), path.c_str()));
+    return ok;
+}
+
 void config::read_config(notifier* n)
 {
     const auto start = SDL_GetTicks();
@@ -67,6 +67,10 @@ public:
     void reset_selection();
 
 private:
+    /* Writes the elements as a compiled layout next to the config file,
+     * which io-obs can load without parsing */
+    bool write_compiled(notifier* n, int width, int height, uint8_t flags);
+
     /* Move selected elements*/
     void move_elements(int new_x, int new_y);
 
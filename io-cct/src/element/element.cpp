@@ -23,6 +23,7 @@
 #include "../util/notifier.hpp"
 #include "../util/sdl_helper.hpp"
 #include "../../../ccl/ccl.hpp"
+#include "../../../io-obs/util/layout_format.hpp"
 
 element* element::read_from_file(ccl_config* file, const std::string &id, const element_type t, SDL_Point* default_dim)
 {
@@ -135,6 +136,14 @@ void element::write_to_file(ccl_config* cfg, SDL_Point* default_dim, uint8_t &la
     cfg->add_point(m_id + CFG_POS, comment, m_position.x, m_position.y, true);
 }
 
+void element::write_to_record(iolayout_element* record)
+{
+    record->type = static_cast<int8_t>(m_type);
+    record->z_level = m_z_level;
+    record->x = m_position.x;
+    record->y = m_position.y;
+}
+
 SDL_Rect* element::get_abs_dim(coordinate_system* cs)
 {
     m_scale = cs->get_scale();
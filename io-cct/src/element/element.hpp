@@ -33,6 +33,8 @@ class ccl_config;
 
 class texture;
 
+struct iolayout_element;
+
 /* Base class for display elements
  */
 class element
@@ -42,6 +44,9 @@ public:
 
     virtual void write_to_file(ccl_config* cfg, SDL_Point* default_dim, uint8_t &layout_flags);
 
+    /* Same values as write_to_file() for compiled layouts */
+    virtual void write_to_record(iolayout_element* record);
+
     virtual SDL_Rect* get_abs_dim(coordinate_system* cs);
 
     virtual void update_settings(dialog_new_element* dialog);
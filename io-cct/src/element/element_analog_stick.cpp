@@ -15,6 +15,7 @@
 #include "../dialog/dialog_new_element.hpp"
 #include "../dialog/dialog_element_settings.hpp"
 #include "../../../ccl/ccl.hpp"
+#include "../../../io-obs/util/layout_format.hpp"
 
 ElementAnalogStick::ElementAnalogStick(const std::string& id, const SDL_Point pos, const SDL_Rect mapping,
                                        const element_side side, const uint8_t radius, const uint8_t z) : element_texture(
@@ -78,6 +79,13 @@ void ElementAnalogStick::write_to_file(ccl_config* cfg, SDL_Point* default_dim,
     flags |= FLAG_GAMEPAD | (m_stick == SIDE_LEFT ? FLAG_LEFT_STICK : FLAG_RIGHT_STICK);
 }
 
+void ElementAnalogStick::write_to_record(iolayout_element* record)
+{
+    element_texture::write_to_record(record);
+    record->side = static_cast<int8_t>(m_stick);
+    record->radius = m_radius;
+}
+
 void ElementAnalogStick::update_settings(dialog_new_element* dialog)
 {
     element_texture::update_settings(dialog);
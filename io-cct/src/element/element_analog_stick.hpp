@@ -30,6 +30,8 @@ public:
 
     void write_to_file(ccl_config* cfg, SDL_Point* default_dim, uint8_t &flags) override;
 
+    void write_to_record(iolayout_element* record) override;
+
     void update_settings(dialog_new_element* dialog) override;
 
     void update_settings(dialog_element_settings* dialog) override;
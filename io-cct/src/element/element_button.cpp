@@ -15,6 +15,7 @@
 #include "../dialog/dialog_new_element.hpp"
 #include "../dialog/dialog_element_settings.hpp"
 #include "../../../ccl/ccl.hpp"
+#include "../../../io-obs/util/layout_format.hpp"
 #include "../../../io-obs/util/util.hpp"
 
 ElementButton::ElementButton(const std::string& id, const SDL_Point pos, const SDL_Rect mapping, const uint16_t vc, const uint8_t z)
@@ -60,6 +61,12 @@ void ElementButton::write_to_file(ccl_config* cfg, SDL_Point* default_dim, uint8
         layout_flags |= FLAG_GAMEPAD;
 }
 
+void ElementButton::write_to_record(iolayout_element* record)
+{
+    element_texture::write_to_record(record);
+    record->keycode = m_keycode;
+}
+
 void ElementButton::update_settings(dialog_new_element* dialog)
 {
     element_texture::update_settings(dialog);
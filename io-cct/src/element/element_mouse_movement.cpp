@@ -12,6 +12,7 @@
 #include "../dialog/dialog_new_element.hpp"
 #include "../dialog/dialog_element_settings.hpp"
 #include "../../../ccl/ccl.hpp"
+#include "../../../io-obs/util/layout_format.hpp"
 
 ElementMouseMovement::ElementMouseMovement(const std::string &id, const SDL_Point pos, const SDL_Rect mapping,
                                            const mouse_movement_type type, const uint16_t radius, const uint8_t z)
@@ -45,6 +46,13 @@ void ElementMouseMovement::write_to_file(ccl_config* cfg, SDL_Point* default_dim
     layout_flags |= FLAG_MOUSE;
 }
 
+void ElementMouseMovement::write_to_record(iolayout_element* record)
+{
+    element_texture::write_to_record(record);
+    record->mouse_type = static_cast<uint8_t>(m_type);
+    record->radius = m_radius;
+}
+
 void ElementMouseMovement::update_settings(dialog_new_element* dialog)
 {
     element_texture::update_settings(dialog);
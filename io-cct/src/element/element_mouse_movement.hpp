@@ -24,6 +24,8 @@ public:
 
     void write_to_file(ccl_config* cfg, SDL_Point* default_dim, uint8_t &layout_flags) override;
 
+    void write_to_record(iolayout_element* record) override;
+
     void update_settings(dialog_new_element* dialog) override;
 
     mouse_movement_type get_mouse_type() const;
@@ -14,6 +14,7 @@
 #include "../util/notifier.hpp"
 #include "../util/palette.hpp"
 #include "../../../ccl/ccl.hpp"
+#include "../../../io-obs/util/layout_format.hpp"
 
 element_texture::element_texture(const std::string &id, const SDL_Point pos, const SDL_Rect mapping, const uint8_t z)
         : element(TEXTURE, id, pos, z)
@@ -54,6 +55,15 @@ void element_texture::write_to_file(ccl_config* cfg, SDL_Point* default_dim, uin
     cfg->add_rect(m_id + CFG_MAPPING, comment, m_mapping.x, m_mapping.y, m_mapping.w, m_mapping.h);
 }
 
+void element_texture::write_to_record(iolayout_element* record)
+{
+    element::write_to_record(record);
+    record->u = m_mapping.x;
+    record->v = m_mapping.y;
+    record->w = m_mapping.w;
+    record->h = m_mapping.h;
+}
+
 void element_texture::update_settings(dialog_new_element* dialog)
 {
     element::update_settings(dialog);
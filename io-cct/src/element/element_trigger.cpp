@@ -13,6 +13,7 @@
 #include "../util/texture.hpp"
 #include "../util/palette.hpp"
 #include "../../../ccl/ccl.hpp"
+#include "../../../io-obs/util/layout_format.hpp"
 
 element_trigger::element_trigger(const std::string &id, const SDL_Point pos, const SDL_Rect mapping, const element_side s,
                                const trigger_direction d, const uint8_t z) : element_texture(TRIGGER, id, pos, mapping,
@@ -71,6 +72,15 @@ void element_trigger::write_to_file(ccl_config* cfg, SDL_Point* default_dim, uin
     }
 }
 
+void element_trigger::write_to_record(iolayout_element* record)
+{
+    element_texture::write_to_record(record);
+    record->trigger_mode = m_button_mode;
+    record->side = static_cast<int8_t>(m_side);
+    if (!m_button_mode)
+        record->direction = static_cast<uint8_t>(m_direction);
+}
+
 void element_trigger::update_settings(dialog_new_element* dialog)
 {
     element_texture::update_settings(dialog);
@@ -56,6 +56,7 @@
 #define LANG_MSG_SAVE_ERROR             "msg_save_error"
 #define LANG_MSG_LOAD_ERROR             "msg_load_error"
 #define LANG_MSG_SAVE_SUCCESS           "msg_save_success"
+#define LANG_MSG_COMPILE_ERROR          "msg_compile_error"
 #define LANG_MSG_LOAD_SUCCESS           "msg_load_success"
 #define LANG_MSG_CONFIG_EMPTY           "msg_config_empty"
 #define LANG_MSG_CONFIG_CORRUPT         "msg_config_corrupt"
@@ -97,6 +97,7 @@ namespace gamepad
             if (m_current_state.merge(new_state))
             {
                 m_changed = true;
+                network::mark_change();
             }
             m_mutex.unlock();
         }
@@ -10,6 +10,8 @@
 #include "util.hpp"
 #include <cstdio>
 #include "gamepad.hpp"
+#define IO_CLIENT
+#include "../../io-obs/util/util.hpp"
 #ifdef UNIX
 #include <pthread.h>
 #endif
@@ -20,6 +22,8 @@ namespace network
 	netlib_socket_set set = nullptr;
     netlib_byte_buf* buffer = nullptr;
 
+    std::atomic<uint64_t> unsent_since(0);
+
     volatile bool need_refresh = false;
     volatile bool data_block = false;
     volatile bool network_loop = true;
@@ -27,12 +31,49 @@ namespace network
     bool connected = false;
     bool state = false;
 
+    /* Set once the server confirmed that it reads MSG_TIME_DATA, older
+     * servers would read the time data as other messages */
+    static bool time_data = false;
+
 #ifdef _WIN32
 	static HANDLE network_thread;
 #else
 	static pthread_t network_thread;
 #endif
 
+    /* Deadlines for the network thread, in milliseconds. Guarded by uiohook::m_mutex */
+    static timer_wheel timers(1);
+    static deadline_timer wheel_timer([](void*) { uiohook::data.reset_wheel(); }, nullptr);
+
+    void schedule_wheel_reset(const uint64_t deadline)
+    {
+        timers.schedule(wheel_timer, deadline);
+    }
+
+    void mark_change()
+    {
+        uint64_t none = 0;
+        unsent_since.compare_exchange_strong(none, util::get_time_ns());
+    }
+
+    /* Send time and how long the oldest input in this buffer is waiting,
+     * the server uses it to time input from capture to its arrival */
+    static bool write_time_data(netlib_byte_buf* buf)
+    {
+        const auto now = util::get_time_ns();
+        const auto since = unsent_since.exchange(0);
+        uint32_t age = TIME_DATA_NO_INPUT;
+        if (since) {
+            const auto waited = (now - since) / 1000;
+            age = waited < TIME_DATA_NO_INPUT ? static_cast<uint32_t>(waited) : TIME_DATA_NO_INPUT - 1;
+        }
+
+        return netlib_write_uint8(buf, MSG_TIME_DATA) &&
+            netlib_write_uint32(buf, static_cast<uint32_t>(now >> 32)) &&
+            netlib_write_uint32(buf, static_cast<uint32_t>(now)) &&
+            netlib_write_uint32(buf, age);
+    }
+
     bool start_connection()
     {
     	DEBUG_LOG("Allocating socket...");
@@ -73,6 +114,14 @@ namespace network
 			return false;
         }
 
+        /* Ask whether the server wants time data, it only answers if it does */
+        buffer->write_pos = 0;
+        if (!netlib_write_uint8(buffer, MSG_TIME_SUPPORTED) || !netlib_tcp_send_buf_smart(sock, buffer))
+        {
+            DEBUG_LOG("Failed to send capabilities: %s\n", netlib_get_error());
+            return false;
+        }
+
         if (!start_thread())
         {
 			DEBUG_LOG("Failed to create network thread.\n");
@@ -108,10 +157,9 @@ namespace network
 				break;
             }
 
-            /* Reset scroll wheel if no scroll event happened */
-            if (util::get_ticks() - uiohook::data.get_last_scroll() >= SCROLL_TIMEOUT)
             {
-                uiohook::data.reset_wheel();
+                std::lock_guard<std::mutex> lock(uiohook::m_mutex);
+                timers.advance(util::get_ticks());
             }
 
             if (need_refresh)
@@ -119,6 +167,12 @@ namespace network
                 std::lock_guard<std::mutex> lock(uiohook::m_mutex);
 
                 buffer->write_pos = 0;
+                if (time_data && !write_time_data(network::buffer))
+                {
+                    DEBUG_LOG("Writing time data to buffer failed: %s\n", netlib_get_error());
+                    break;
+                }
+
                 if (gamepad::check_changes() && !util::write_gamepad_data())
                 {
                     DEBUG_LOG("Failed to write gamepad event data to buffer. Exiting...\n");
@@ -186,6 +240,9 @@ namespace network
 			case MSG_READ_ERROR:
 				DEBUG_LOG("Couldn't read message.\n");
 				return false;
+            case MSG_TIME_SUPPORTED:
+                time_data = true;
+                return true;
             case MSG_REFRESH:
                 need_refresh = true; /* fallthrough */
             case MSG_PING_CLIENT: /* NO-OP needed */
@@ -7,13 +7,14 @@
 
 #pragma once
 #include <netlib.h>
+#include <atomic>
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 #include "util.hpp"
 
- /* We need 85 bytes if all four gamepads are sent + 32 bytes if all buttons are pressed down */
-#define BUFFER_SIZE     118
+ /* We need 85 bytes if all four gamepads are sent + 32 bytes if all buttons are pressed down + 13 bytes of timing */
+#define BUFFER_SIZE     131
 #define LISTEN_TIMEOUT  25
 
 namespace network
@@ -26,6 +27,15 @@ namespace network
     extern volatile bool need_refresh;  /* Set to true by other threads */
     extern volatile bool data_block;    /* Set to true to prevent other threads from modifying data, which is about to be sent */
 	extern netlib_byte_buf* buffer;     /* Shared buffer for writing data, which will be sent to the server */
+    extern std::atomic<uint64_t> unsent_since; /* Time of the oldest change that wasn't sent yet, 0 if none */
+
+    /* Called by the hooks on every input change, so the
+     * server knows how long the input waited to be sent */
+    void mark_change();
+
+    /* Resets the scroll wheel at deadline (ms), moves the reset there if it's
+     * already scheduled. Caller has to hold uiohook::m_mutex */
+    void schedule_wheel_reset(uint64_t deadline);
 	
 	bool init();
 	bool start_connection();
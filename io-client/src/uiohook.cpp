@@ -25,6 +25,7 @@ namespace uiohook
 
     void data_holder::set_button(const uint16_t keycode, const bool pressed)
     {
+        network::mark_change();
         m_mutex.lock();
         if (pressed)
             m_button_states[keycode] = pressed;
@@ -35,6 +36,7 @@ namespace uiohook
 
     void data_holder::set_mouse_pos(const int16_t x, const int16_t y)
     {
+        network::mark_change();
         m_mutex.lock();
         m_mouse_x = x;
         m_mouse_y = y;
@@ -44,6 +46,7 @@ namespace uiohook
 
     void data_holder::set_wheel(int amount, wheel_dir dir)
     {
+        network::mark_change();
         m_mutex.lock();
         if (dir != m_wheel_direction)
             m_wheel_amount = amount;
@@ -51,20 +54,20 @@ namespace uiohook
             m_wheel_amount += amount;
         m_wheel_direction = dir;
         m_new_mouse_data = true;
-        m_last_scroll = util::get_ticks();
+        /* Direction is reset once no scroll event came in for SCROLL_TIMEOUT */
+        network::schedule_wheel_reset(util::get_ticks() + SCROLL_TIMEOUT);
         m_mutex.unlock();
     }
 
     void data_holder::reset_wheel()
     {
-        m_mutex.lock();
         m_new_mouse_data = true;
         m_wheel_direction = wheel_none;
-        m_mutex.unlock();
     }
 
     void data_holder::set_wheel(bool pressed)
     {
+        network::mark_change();
         m_mutex.lock();
         m_new_mouse_data = true;
         m_wheel_pressed = pressed;
@@ -112,11 +115,6 @@ namespace uiohook
         return success;
     }
 
-    uint32_t data_holder::get_last_scroll()
-    {
-        return m_last_scroll;
-    }
-
     bool logger_proc(unsigned level, const char* format, ...)
     {
         auto status = false;
@@ -31,17 +31,15 @@ namespace uiohook
         int16_t m_wheel_amount;
         bool m_wheel_pressed;
         bool m_new_mouse_data;
-        uint32_t m_last_scroll;
 
     public:
         data_holder();
         void set_button(uint16_t keycode, bool pressed);
         void set_mouse_pos(int16_t x, int16_t y);
         void set_wheel(int amount, wheel_dir dir);
-        void reset_wheel();
+        void reset_wheel(); /* Caller has to hold m_mutex */
         void set_wheel(bool pressed);
         bool write_to_buffer(netlib_byte_buf* buffer);
-        uint32_t get_last_scroll();
     };
 
     inline uint16_t util_mouse_fix(int m)
@@ -179,16 +179,29 @@ namespace util
 	    return true;
     }
 
-    uint32_t get_ticks()
+    uint64_t get_ticks()
     {
 #ifdef _WIN32
-		SYSTEMTIME time;
-		GetSystemTime(&time);
-		return (time.wSecond * 1000) + time.wMilliseconds;
+		return GetTickCount64();
 #else
 		struct timespec spec;
 		clock_gettime(CLOCK_MONOTONIC, &spec);
-		return round(spec.tv_nsec / 1.0e6);
+		return static_cast<uint64_t>(spec.tv_sec) * 1000 + spec.tv_nsec / 1000000;
+#endif
+    }
+
+    uint64_t get_time_ns()
+    {
+#ifdef _WIN32
+		LARGE_INTEGER frequency, counter;
+		QueryPerformanceFrequency(&frequency);
+		QueryPerformanceCounter(&counter);
+		return static_cast<uint64_t>(counter.QuadPart / frequency.QuadPart * 1000000000ull +
+			counter.QuadPart % frequency.QuadPart * 1000000000ull / frequency.QuadPart);
+#else
+		struct timespec spec;
+		clock_gettime(CLOCK_MONOTONIC, &spec);
+		return static_cast<uint64_t>(spec.tv_sec) * 1000000000ull + spec.tv_nsec;
 #endif
     }
 
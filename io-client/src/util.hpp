@@ -62,7 +62,11 @@ namespace util
 	    return (in >> 8) | (in << 8);
 	}
 
-	uint32_t get_ticks();
+	/* Monotonic time in milliseconds */
+	uint64_t get_ticks();
+
+	/* Monotonic time in nanoseconds */
+	uint64_t get_time_ns();
     
 	message recv_msg();
 
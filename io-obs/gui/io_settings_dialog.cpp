@@ -12,12 +12,19 @@
 #include "util/util.hpp"
 #include "util/config.hpp"
 #include "hook/gamepad_hook.hpp"
+#include "util/recording/recorder.hpp"
+#include "util/recording/replay.hpp"
+#include "util/latency_stats.hpp"
+#include "util/trace.hpp"
+#include "util/profiled_mutex.hpp"
 #include <obs-frontend-api.h>
 #include <util/platform.h>
 #include <util/config-file.h>
 #include <string>
 #include <obs-module.h>
 #include <QDesktopServices>
+#include <QDir>
+#include <QFontDatabase>
 
 io_settings_dialog* settings_dialog = nullptr;
 
@@ -28,6 +35,7 @@ io_settings_dialog::io_settings_dialog(QWidget* parent) : QDialog(parent, Qt::Di
 
 #ifndef LINUX
     ui->tab_gamepad->setVisible(false);
+    ui->cb_evdev->setVisible(false);
 #else
     for (const auto &binding : gamepad::default_bindings) {
         auto text_box = findChild<QLineEdit*>(binding.text_box_id);
@@ -46,9 +54,15 @@ io_settings_dialog::io_settings_dialog(QWidget* parent) : QDialog(parent, Qt::Di
     connect(ui->btn_refresh_cb, &QPushButton::clicked, this, &io_settings_dialog::RefreshWindowList);
     connect(ui->btn_add, &QPushButton::clicked, this, &io_settings_dialog::AddFilter);
     connect(ui->btn_remove, &QPushButton::clicked, this, &io_settings_dialog::RemoveFilter);
+    connect(ui->btn_record, &QPushButton::clicked, this, &io_settings_dialog::ToggleRecording);
+    connect(ui->btn_replay, &QPushButton::clicked, this, &io_settings_dialog::ToggleReplay);
+    connect(ui->btn_latency_log, &QPushButton::clicked, this, &io_settings_dialog::LogLatency);
+    connect(ui->btn_latency_reset, &QPushButton::clicked, this, &io_settings_dialog::ResetLatency);
+    connect(ui->btn_trace, &QPushButton::clicked, this, &io_settings_dialog::ToggleTrace);
 
     /* Load values */
     ui->cb_iohook->setChecked(io_config::uiohook);
+    ui->cb_evdev->setChecked(io_config::evdev);
     ui->cb_gamepad_hook->setChecked(io_config::gamepad);
     ui->cb_enable_overlay->setChecked(io_config::overlay);
     ui->cb_enable_history->setChecked(io_config::history);
@@ -57,6 +71,9 @@ io_settings_dialog::io_settings_dialog(QWidget* parent) : QDialog(parent, Qt::Di
     ui->cb_log->setChecked(io_config::log_flag);
     ui->box_port->setValue(io_config::port);
     ui->cb_regex->setChecked(io_config::regex);
+    ui->txt_record_path->setText(QDir::home().filePath("input-overlay.iolog"));
+    ui->txt_latency->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    ui->txt_trace_path->setText(QDir::home().filePath("input-overlay-trace.json"));
 
     /* Tooltips aren't translated by obs */
     ui->box_refresh_rate->setToolTip(T_REFRESH_RATE_TOOLTIP);
@@ -103,6 +120,28 @@ void io_settings_dialog::toggleShowHide()
 
 void io_settings_dialog::RefreshUi()
 {
+    /* Recording state can change without the dialog (replay finished) */
+    ui->btn_record->setText(recorder::active() ? T_RECORDING_STOP : T_RECORDING_START);
+    ui->btn_replay->setText(replay::active() ? T_RECORDING_STOP_REPLAY : T_RECORDING_REPLAY);
+    ui->txt_record_path->setEnabled(!recorder::active() && !replay::active());
+    if (recorder::active())
+        ui->lbl_record_status->setText(QString::asprintf(T_RECORDING_STATUS,
+                                                         static_cast<unsigned long long>(recorder::written_records()),
+                                                         static_cast<unsigned long long>(recorder::dropped_records())));
+
+    ui->btn_trace->setText(trace::active() ? T_LATENCY_TRACE_STOP : T_LATENCY_TRACE_START);
+    ui->txt_trace_path->setEnabled(!trace::active());
+
+    if (ui->tab_latency->isVisible()) {
+        auto latency = latency_stats::summary();
+        const auto locks = lock_stats::summary();
+        if (latency.empty())
+            latency = T_LATENCY_EMPTY;
+        if (!locks.empty())
+            latency += "\n" + locks;
+        ui->txt_latency->setPlainText(latency.c_str());
+    }
+
     /* Populate client list */
     if (network::network_flag && network::server_instance && network::server_instance->clients_changed()) {
         ui->box_connections->clear();
@@ -199,6 +238,7 @@ void io_settings_dialog::FormAccepted()
     auto cfg = obs_frontend_get_global_config();
 
     io_config::uiohook = ui->cb_iohook->isChecked();
+    io_config::evdev = ui->cb_evdev->isChecked();
     io_config::gamepad = ui->cb_gamepad_hook->isChecked();
     io_config::overlay = ui->cb_enable_overlay->isChecked();
     io_config::history = ui->cb_enable_history->isChecked();
@@ -246,3 +286,51 @@ void io_settings_dialog::OpenForums()
 {
     QDesktopServices::openUrl(QUrl("https://obsproject.com/forum/resources/input-overlay.552/"));
 }
+
+void io_settings_dialog::ToggleRecording()
+{
+    if (recorder::active()) {
+        recorder::stop();
+    } else {
+        /* Only one of the two runs at a time, otherwise the overlays
+         * would show replayed input that isn't in the recording */
+        replay::stop();
+        recorder::start(ui->txt_record_path->text().toUtf8().constData());
+    }
+    RefreshUi();
+}
+
+void io_settings_dialog::ToggleReplay()
+{
+    if (replay::active()) {
+        replay::stop();
+    } else {
+        recorder::stop();
+        replay::start(ui->txt_record_path->text().toUtf8().constData(),
+                      static_cast<float>(ui->box_replay_speed->value()));
+    }
+    RefreshUi();
+}
+
+void io_settings_dialog::LogLatency()
+{
+    latency_stats::log();
+    lock_stats::log();
+}
+
+void io_settings_dialog::ResetLatency()
+{
+    latency_stats::reset();
+    lock_stats::reset();
+    RefreshUi();
+}
+
+void io_settings_dialog::ToggleTrace()
+{
+    if (trace::active()) {
+        trace::stop();
+        trace::write(ui->txt_trace_path->text().toUtf8().constData());
+    } else
+        trace::start();
+    RefreshUi();
+}
@@ -46,6 +46,16 @@ private Q_SLOTS:
     void OpenGitHub();
 
     void OpenForums();
+
+    void ToggleRecording();
+
+    void ToggleReplay();
+
+    void LogLatency();
+
+    void ResetLatency();
+
+    void ToggleTrace();
 private:
     Ui::io_config_dialog* ui;
     QTimer* m_refresh = nullptr;
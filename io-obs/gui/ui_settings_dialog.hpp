@@ -15,13 +15,16 @@
 #include <QtWidgets/QComboBox>
 #include <QtWidgets/QDialog>
 #include <QtWidgets/QDialogButtonBox>
+#include <QtWidgets/QDoubleSpinBox>
 #include <QtWidgets/QFrame>
 #include <QtWidgets/QHBoxLayout>
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QLineEdit>
 #include <QtWidgets/QListWidget>
+#include <QtWidgets/QPlainTextEdit>
 #include <QtWidgets/QPushButton>
 #include <QtWidgets/QScrollArea>
+#include <QtWidgets/QSpacerItem>
 #include <QtWidgets/QSpinBox>
 #include <QtWidgets/QTabWidget>
 #include <QtWidgets/QTextEdit>
@@ -39,6 +42,7 @@ public:
     QVBoxLayout *verticalLayout_2;
     QLabel *lbl_local_features;
     QCheckBox *cb_iohook;
+    QCheckBox *cb_evdev;
     QCheckBox *cb_gamepad_hook;
     QCheckBox *cb_enable_overlay;
     QCheckBox *cb_enable_history;
@@ -157,6 +161,32 @@ public:
     QLabel *lbl_connections;
     QListWidget *box_connections;
     QPushButton *btn_refresh;
+    QWidget *tab_recording;
+    QVBoxLayout *verticalLayout_7;
+    QLabel *lbl_record_info;
+    QLabel *lbl_record_path;
+    QLineEdit *txt_record_path;
+    QLabel *lbl_replay_speed;
+    QDoubleSpinBox *box_replay_speed;
+    QFrame *frame_record;
+    QHBoxLayout *horizontalLayout_24;
+    QPushButton *btn_record;
+    QPushButton *btn_replay;
+    QLabel *lbl_record_status;
+    QSpacerItem *verticalSpacer;
+    QWidget *tab_latency;
+    QVBoxLayout *verticalLayout_8;
+    QLabel *lbl_latency_info;
+    QPlainTextEdit *txt_latency;
+    QFrame *frame_latency;
+    QHBoxLayout *horizontalLayout_25;
+    QPushButton *btn_latency_log;
+    QPushButton *btn_latency_reset;
+    QLabel *lbl_trace_info;
+    QFrame *frame_trace;
+    QHBoxLayout *horizontalLayout_26;
+    QLineEdit *txt_trace_path;
+    QPushButton *btn_trace;
     QWidget *tab_about;
     QVBoxLayout *verticalLayout_6;
     QTextEdit *txt_about;
@@ -203,6 +233,11 @@ public:
 
         verticalLayout_2->addWidget(cb_iohook);
 
+        cb_evdev = new QCheckBox(tab_local);
+        cb_evdev->setObjectName(QString::fromUtf8("cb_evdev"));
+
+        verticalLayout_2->addWidget(cb_evdev);
+
         cb_gamepad_hook = new QCheckBox(tab_local);
         cb_gamepad_hook->setObjectName(QString::fromUtf8("cb_gamepad_hook"));
 
@@ -889,6 +924,135 @@ public:
         verticalLayout_4->addWidget(btn_refresh);
 
         tabs->addTab(tab_remote, QString());
+        tab_recording = new QWidget();
+        tab_recording->setObjectName(QString::fromUtf8("tab_recording"));
+        verticalLayout_7 = new QVBoxLayout(tab_recording);
+        verticalLayout_7->setObjectName(QString::fromUtf8("verticalLayout_7"));
+        lbl_record_info = new QLabel(tab_recording);
+        lbl_record_info->setObjectName(QString::fromUtf8("lbl_record_info"));
+        lbl_record_info->setWordWrap(true);
+
+        verticalLayout_7->addWidget(lbl_record_info);
+
+        lbl_record_path = new QLabel(tab_recording);
+        lbl_record_path->setObjectName(QString::fromUtf8("lbl_record_path"));
+
+        verticalLayout_7->addWidget(lbl_record_path);
+
+        txt_record_path = new QLineEdit(tab_recording);
+        txt_record_path->setObjectName(QString::fromUtf8("txt_record_path"));
+
+        verticalLayout_7->addWidget(txt_record_path);
+
+        lbl_replay_speed = new QLabel(tab_recording);
+        lbl_replay_speed->setObjectName(QString::fromUtf8("lbl_replay_speed"));
+
+        verticalLayout_7->addWidget(lbl_replay_speed);
+
+        box_replay_speed = new QDoubleSpinBox(tab_recording);
+        box_replay_speed->setObjectName(QString::fromUtf8("box_replay_speed"));
+        box_replay_speed->setSuffix(QString::fromUtf8("x"));
+        box_replay_speed->setMaximum(100.000000000000000);
+        box_replay_speed->setSingleStep(0.500000000000000);
+        box_replay_speed->setValue(1.000000000000000);
+
+        verticalLayout_7->addWidget(box_replay_speed);
+
+        frame_record = new QFrame(tab_recording);
+        frame_record->setObjectName(QString::fromUtf8("frame_record"));
+        frame_record->setFrameShape(QFrame::NoFrame);
+        frame_record->setFrameShadow(QFrame::Plain);
+        horizontalLayout_24 = new QHBoxLayout(frame_record);
+        horizontalLayout_24->setContentsMargins(0, 0, 0, 0);
+        horizontalLayout_24->setObjectName(QString::fromUtf8("horizontalLayout_24"));
+        btn_record = new QPushButton(frame_record);
+        btn_record->setObjectName(QString::fromUtf8("btn_record"));
+
+        horizontalLayout_24->addWidget(btn_record);
+
+        btn_replay = new QPushButton(frame_record);
+        btn_replay->setObjectName(QString::fromUtf8("btn_replay"));
+
+        horizontalLayout_24->addWidget(btn_replay);
+
+
+        verticalLayout_7->addWidget(frame_record);
+
+        lbl_record_status = new QLabel(tab_recording);
+        lbl_record_status->setObjectName(QString::fromUtf8("lbl_record_status"));
+        lbl_record_status->setText(QString::fromUtf8(""));
+
+        verticalLayout_7->addWidget(lbl_record_status);
+
+        verticalSpacer = new QSpacerItem(20, 40, QSizePolicy::Minimum, QSizePolicy::Expanding);
+
+        verticalLayout_7->addItem(verticalSpacer);
+
+        tabs->addTab(tab_recording, QString());
+        tab_latency = new QWidget();
+        tab_latency->setObjectName(QString::fromUtf8("tab_latency"));
+        verticalLayout_8 = new QVBoxLayout(tab_latency);
+        verticalLayout_8->setObjectName(QString::fromUtf8("verticalLayout_8"));
+        lbl_latency_info = new QLabel(tab_latency);
+        lbl_latency_info->setObjectName(QString::fromUtf8("lbl_latency_info"));
+        lbl_latency_info->setWordWrap(true);
+
+        verticalLayout_8->addWidget(lbl_latency_info);
+
+        txt_latency = new QPlainTextEdit(tab_latency);
+        txt_latency->setObjectName(QString::fromUtf8("txt_latency"));
+        txt_latency->setLineWrapMode(QPlainTextEdit::NoWrap);
+        txt_latency->setReadOnly(true);
+
+        verticalLayout_8->addWidget(txt_latency);
+
+        frame_latency = new QFrame(tab_latency);
+        frame_latency->setObjectName(QString::fromUtf8("frame_latency"));
+        frame_latency->setFrameShape(QFrame::NoFrame);
+        frame_latency->setFrameShadow(QFrame::Plain);
+        horizontalLayout_25 = new QHBoxLayout(frame_latency);
+        horizontalLayout_25->setContentsMargins(0, 0, 0, 0);
+        horizontalLayout_25->setObjectName(QString::fromUtf8("horizontalLayout_25"));
+        btn_latency_log = new QPushButton(frame_latency);
+        btn_latency_log->setObjectName(QString::fromUtf8("btn_latency_log"));
+
+        horizontalLayout_25->addWidget(btn_latency_log);
+
+        btn_latency_reset = new QPushButton(frame_latency);
+        btn_latency_reset->setObjectName(QString::fromUtf8("btn_latency_reset"));
+
+        horizontalLayout_25->addWidget(btn_latency_reset);
+
+
+        verticalLayout_8->addWidget(frame_latency);
+
+        lbl_trace_info = new QLabel(tab_latency);
+        lbl_trace_info->setObjectName(QString::fromUtf8("lbl_trace_info"));
+        lbl_trace_info->setWordWrap(true);
+
+        verticalLayout_8->addWidget(lbl_trace_info);
+
+        frame_trace = new QFrame(tab_latency);
+        frame_trace->setObjectName(QString::fromUtf8("frame_trace"));
+        frame_trace->setFrameShape(QFrame::NoFrame);
+        frame_trace->setFrameShadow(QFrame::Plain);
+        horizontalLayout_26 = new QHBoxLayout(frame_trace);
+        horizontalLayout_26->setContentsMargins(0, 0, 0, 0);
+        horizontalLayout_26->setObjectName(QString::fromUtf8("horizontalLayout_26"));
+        txt_trace_path = new QLineEdit(frame_trace);
+        txt_trace_path->setObjectName(QString::fromUtf8("txt_trace_path"));
+
+        horizontalLayout_26->addWidget(txt_trace_path);
+
+        btn_trace = new QPushButton(frame_trace);
+        btn_trace->setObjectName(QString::fromUtf8("btn_trace"));
+
+        horizontalLayout_26->addWidget(btn_trace);
+
+
+        verticalLayout_8->addWidget(frame_trace);
+
+        tabs->addTab(tab_latency, QString());
         tab_about = new QWidget();
         tab_about->setObjectName(QString::fromUtf8("tab_about"));
         verticalLayout_6 = new QVBoxLayout(tab_about);
@@ -952,6 +1116,7 @@ public:
         io_config_dialog->setWindowTitle(QApplication::translate("io_config_dialog", "Dialog.Title", nullptr));
         lbl_local_features->setText(QApplication::translate("io_config_dialog", "Dialog.LocalFeatures.Info", nullptr));
         cb_iohook->setText(QApplication::translate("io_config_dialog", "Dialog.Uiohook.Enable", nullptr));
+        cb_evdev->setText(QApplication::translate("io_config_dialog", "Dialog.Evdev.Enable", nullptr));
         cb_gamepad_hook->setText(QApplication::translate("io_config_dialog", "Dialog.GamepadHook.Enable", nullptr));
         cb_enable_overlay->setText(QApplication::translate("io_config_dialog", "Dialog.InputOverlay.Enable", nullptr));
         cb_enable_history->setText(QApplication::translate("io_config_dialog", "Dialog.InputHistory.Enable", nullptr));
@@ -1026,6 +1191,18 @@ public:
         lbl_connections->setText(QApplication::translate("io_config_dialog", "Dialog.Remote.Connections", nullptr));
         btn_refresh->setText(QApplication::translate("io_config_dialog", "Source.InputSource.Reload", nullptr));
         tabs->setTabText(tabs->indexOf(tab_remote), QApplication::translate("io_config_dialog", "Dialog.RemoteConnection", nullptr));
+        lbl_record_info->setText(QApplication::translate("io_config_dialog", "Dialog.Recording.Info", nullptr));
+        lbl_record_path->setText(QApplication::translate("io_config_dialog", "Dialog.Recording.Path", nullptr));
+        lbl_replay_speed->setText(QApplication::translate("io_config_dialog", "Dialog.Recording.Speed", nullptr));
+        btn_record->setText(QApplication::translate("io_config_dialog", "Dialog.Recording.Start", nullptr));
+        btn_replay->setText(QApplication::translate("io_config_dialog", "Dialog.Recording.Replay", nullptr));
+        tabs->setTabText(tabs->indexOf(tab_recording), QApplication::translate("io_config_dialog", "Dialog.Recording", nullptr));
+        lbl_latency_info->setText(QApplication::translate("io_config_dialog", "Dialog.Latency.Info", nullptr));
+        btn_latency_log->setText(QApplication::translate("io_config_dialog", "Dialog.Latency.Log", nullptr));
+        btn_latency_reset->setText(QApplication::translate("io_config_dialog", "Dialog.Latency.Reset", nullptr));
+        lbl_trace_info->setText(QApplication::translate("io_config_dialog", "Dialog.Latency.TraceInfo", nullptr));
+        btn_trace->setText(QApplication::translate("io_config_dialog", "Dialog.Latency.TraceStart", nullptr));
+        tabs->setTabText(tabs->indexOf(tab_latency), QApplication::translate("io_config_dialog", "Dialog.Latency", nullptr));
         txt_about->setHtml(QApplication::translate("io_config_dialog", "<!DOCTYPE HTML PUBLIC \"-//W3C//DTD HTML 4.0//EN\" \"http://www.w3.org/TR/REC-html40/strict.dtd\">\n"
 "<html><head><meta name=\"qrichtext\" content=\"1\" /><style type=\"text/css\">\n"
 "p, li { white-space: pre-wrap; }\n"
@@ -0,0 +1,503 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "evdev_hook.hpp"
+#include "hook_helper.hpp"
+#include "../util/config.hpp"
+#include "../util/trace.hpp"
+#include <util/platform.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+/* Older headers only have the timeval member */
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+#define EVDEV_DIR               "/dev/input"
+#define EVDEV_PREFIX            "event"
+#define EVDEV_RESCAN_MS         2000    /* Rescan interval if /dev/input can't be watched */
+#define EVDEV_READ_BATCH        64      /* input_events read per syscall */
+#define EVDEV_WHEEL_AMOUNT      3       /* Same scroll amount uiohook reports on X11 */
+
+#define BITS_PER_LONG           (sizeof(long) * 8)
+#define BIT_WORDS(n)            (((n) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+#define TEST_BIT(bit, array)    ((array[(bit) / BITS_PER_LONG] >> ((bit) % BITS_PER_LONG)) & 1)
+
+namespace evdev
+{
+    bool evdev_hook_state = false;
+
+    /* Everything below is only touched by the evdev thread */
+    struct device
+    {
+        int fd = -1;
+        std::string path;
+        /* Motion is collected until the device sends SYN_REPORT */
+        int32_t rel_x = 0, rel_y = 0, wheel = 0;
+        uint64_t time = 0;
+        bool dropped = false; /* Kernel buffer overflowed, skip until next report */
+    };
+
+    static pthread_t evdev_thread;
+    static int epoll_fd = -1;
+    static int stop_fd = -1; /* eventfd, wakes the thread up for shutdown */
+    static int inotify_fd = -1; /* Watches EVDEV_DIR for new devices */
+    static std::vector<device*> devices;
+    /* Mice only report motion, so the position is made up from
+     * all of them together, like the cursor would be */
+    static int32_t mouse_x = 0, mouse_y = 0;
+
+    /* Linux KEY_* codes 1-88 are the same as set 1 scancodes, which
+     * uiohook uses as well. Everything else has to be looked up */
+    struct key_mapping
+    {
+        uint16_t key;
+        uint16_t vc;
+    };
+
+    static const key_mapping extended_keys[] = {
+        {KEY_102ND, VC_LESSER_GREATER},
+        {KEY_KPENTER, VC_KP_ENTER},
+        {KEY_RIGHTCTRL, VC_CONTROL_R},
+        {KEY_KPSLASH, VC_KP_DIVIDE},
+        {KEY_SYSRQ, VC_PRINTSCREEN},
+        {KEY_RIGHTALT, VC_ALT_R},
+        {KEY_HOME, VC_HOME},
+        {KEY_UP, VC_UP},
+        {KEY_PAGEUP, VC_PAGE_UP},
+        {KEY_LEFT, VC_LEFT},
+        {KEY_RIGHT, VC_RIGHT},
+        {KEY_END, VC_END},
+        {KEY_DOWN, VC_DOWN},
+        {KEY_PAGEDOWN, VC_PAGE_DOWN},
+        {KEY_INSERT, VC_INSERT},
+        {KEY_DELETE, VC_DELETE},
+        {KEY_MUTE, VC_VOLUME_MUTE},
+        {KEY_VOLUMEDOWN, VC_VOLUME_DOWN},
+        {KEY_VOLUMEUP, VC_VOLUME_UP},
+        {KEY_POWER, VC_POWER},
+        {KEY_KPEQUAL, VC_KP_EQUALS},
+        {KEY_PAUSE, VC_PAUSE},
+        {KEY_KPCOMMA, VC_KP_COMMA},
+        {KEY_YEN, VC_YEN},
+        {KEY_LEFTMETA, VC_META_L},
+        {KEY_RIGHTMETA, VC_META_R},
+        {KEY_COMPOSE, VC_CONTEXT_MENU},
+        {KEY_SLEEP, VC_SLEEP},
+        {KEY_WAKEUP, VC_WAKE},
+        {KEY_CALC, VC_APP_CALCULATOR},
+        {KEY_MAIL, VC_APP_MAIL},
+        {KEY_HOMEPAGE, VC_BROWSER_HOME},
+        {KEY_BACK, VC_BROWSER_BACK},
+        {KEY_FORWARD, VC_BROWSER_FORWARD},
+        {KEY_STOP, VC_BROWSER_STOP},
+        {KEY_REFRESH, VC_BROWSER_REFRESH},
+        {KEY_BOOKMARKS, VC_BROWSER_FAVORITES},
+        {KEY_SEARCH, VC_BROWSER_SEARCH},
+        {KEY_NEXTSONG, VC_MEDIA_NEXT},
+        {KEY_PLAYPAUSE, VC_MEDIA_PLAY},
+        {KEY_PREVIOUSSONG, VC_MEDIA_PREVIOUS},
+        {KEY_STOPCD, VC_MEDIA_STOP},
+        {KEY_EJECTCD, VC_MEDIA_EJECT},
+        {KEY_F13, VC_F13},
+        {KEY_F14, VC_F14},
+        {KEY_F15, VC_F15},
+        {KEY_F16, VC_F16},
+        {KEY_F17, VC_F17},
+        {KEY_F18, VC_F18},
+        {KEY_F19, VC_F19},
+        {KEY_F20, VC_F20},
+        {KEY_F21, VC_F21},
+        {KEY_F22, VC_F22},
+        {KEY_F23, VC_F23},
+        {KEY_F24, VC_F24},
+    };
+
+    uint16_t key_to_vc(const uint16_t key)
+    {
+        if (key > KEY_RESERVED && key <= KEY_F12 && key != KEY_102ND && key != 84 /* Unused */)
+            return key;
+
+        for (const auto &mapping : extended_keys) {
+            if (mapping.key == key)
+                return mapping.vc;
+        }
+        return VC_UNDEFINED;
+    }
+
+    /* uiohook numbers mouse buttons like X11 does */
+    static uint16_t button_to_mouse(const uint16_t button)
+    {
+        switch (button) {
+            case BTN_LEFT:
+                return MOUSE_BUTTON1;
+            case BTN_MIDDLE:
+                return MOUSE_BUTTON2;
+            case BTN_RIGHT:
+                return MOUSE_BUTTON3;
+            case BTN_SIDE:
+                return MOUSE_BUTTON4;
+            case BTN_EXTRA:
+                return MOUSE_BUTTON5;
+            default:
+                return MOUSE_NOBUTTON;
+        }
+    }
+
+    static uint64_t event_time(const input_event &ev)
+    {
+        return static_cast<uint64_t>(ev.input_event_sec) * 1000000000ULL +
+               static_cast<uint64_t>(ev.input_event_usec) * 1000ULL;
+    }
+
+    static int16_t clamp_pos(const int32_t pos)
+    {
+        return static_cast<int16_t>(pos < INT16_MIN ? INT16_MIN : (pos > INT16_MAX ? INT16_MAX : pos));
+    }
+
+    static void queue(raw_event &e, const uint64_t time)
+    {
+        e.time = time;
+        hook::event_ring.push(e);
+    }
+
+    static void commit_motion(device* dev)
+    {
+        if (dev->rel_x || dev->rel_y) {
+            mouse_x += dev->rel_x;
+            mouse_y += dev->rel_y;
+            mouse_x = clamp_pos(mouse_x);
+            mouse_y = clamp_pos(mouse_y);
+
+            raw_event e = {};
+            e.type = EVENT_MOUSE_MOVED;
+            e.x = static_cast<int16_t>(mouse_x);
+            e.y = static_cast<int16_t>(mouse_y);
+            queue(e, dev->time);
+        }
+
+        if (dev->wheel) {
+            raw_event e = {};
+            e.type = EVENT_MOUSE_WHEEL;
+            e.x = static_cast<int16_t>(mouse_x);
+            e.y = static_cast<int16_t>(mouse_y);
+            /* Positive values mean scrolling up here, uiohook has it the other way around */
+            e.rotation = static_cast<int16_t>(dev->wheel > 0 ? WHEEL_UP : WHEEL_DOWN);
+            e.amount = static_cast<uint16_t>(EVDEV_WHEEL_AMOUNT * (dev->wheel > 0 ? dev->wheel : -dev->wheel));
+            queue(e, dev->time);
+        }
+
+        dev->rel_x = dev->rel_y = dev->wheel = 0;
+    }
+
+    static void handle_event(device* dev, const input_event &ev)
+    {
+        raw_event e = {};
+
+        if (dev->dropped) {
+            /* Everything up to the next report is incomplete */
+            if (ev.type == EV_SYN && ev.code == SYN_REPORT)
+                dev->dropped = false;
+            return;
+        }
+
+        switch (ev.type) {
+            case EV_KEY:
+                if (ev.code >= BTN_MISC && ev.code < KEY_OK) {
+                    /* Mouse button, repeats (value 2) don't exist for those */
+                    e.code = button_to_mouse(ev.code);
+                    if (e.code == MOUSE_NOBUTTON || ev.value > 1)
+                        break;
+                    e.type = ev.value ? EVENT_MOUSE_PRESSED : EVENT_MOUSE_RELEASED;
+                    e.x = static_cast<int16_t>(mouse_x);
+                    e.y = static_cast<int16_t>(mouse_y);
+                } else {
+                    e.code = key_to_vc(ev.code);
+                    if (e.code == VC_UNDEFINED)
+                        break;
+                    /* Key repeats count as presses, same as with uiohook */
+                    e.type = ev.value ? EVENT_KEY_PRESSED : EVENT_KEY_RELEASED;
+                }
+                queue(e, event_time(ev));
+                break;
+            case EV_REL:
+                dev->time = event_time(ev);
+                if (ev.code == REL_X)
+                    dev->rel_x += ev.value;
+                else if (ev.code == REL_Y)
+                    dev->rel_y += ev.value;
+                else if (ev.code == REL_WHEEL)
+                    dev->wheel += ev.value;
+                break;
+            case EV_SYN:
+                if (ev.code == SYN_REPORT) {
+                    commit_motion(dev);
+                } else if (ev.code == SYN_DROPPED) {
+                    dev->rel_x = dev->rel_y = dev->wheel = 0;
+                    dev->dropped = true;
+                }
+                break;
+            default:;
+        }
+    }
+
+    static void close_device(device* dev)
+    {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, dev->fd, nullptr);
+        close(dev->fd);
+        DEBUG_LOG(LOG_INFO, "evdev: Closed %s", dev->path.c_str());
+
+        for (auto it = devices.begin(); it != devices.end(); ++it) {
+            if (*it == dev) {
+                devices.erase(it);
+                break;
+            }
+        }
+        delete dev;
+    }
+
+    /* Reads everything the device has buffered, returns false if
+     * the device is gone */
+    static bool read_device(device* dev)
+    {
+        input_event events[EVDEV_READ_BATCH];
+
+        for (;;) {
+            const auto bytes = read(dev->fd, events, sizeof(events));
+            if (bytes < 0)
+                return errno == EAGAIN || errno == EINTR;
+            if (bytes == 0)
+                return false;
+
+            const auto count = static_cast<size_t>(bytes) / sizeof(input_event);
+            for (size_t i = 0; i < count; i++)
+                handle_event(dev, events[i]);
+
+            if (count < EVDEV_READ_BATCH)
+                return true;
+        }
+    }
+
+    /* Only keyboards and mice are of interest, game pads are
+     * handled by the gamepad hook */
+    static bool is_keyboard_or_mouse(const int fd)
+    {
+        unsigned long ev_bits[BIT_WORDS(EV_MAX + 1)] = {};
+        unsigned long key_bits[BIT_WORDS(KEY_MAX + 1)] = {};
+        unsigned long rel_bits[BIT_WORDS(REL_MAX + 1)] = {};
+
+        if (ioctl(fd, EVIOCGBIT(0, sizeof(ev_bits)), ev_bits) < 0 || !TEST_BIT(EV_KEY, ev_bits))
+            return false;
+        ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits);
+
+        if (TEST_BIT(EV_REL, ev_bits)) {
+            ioctl(fd, EVIOCGBIT(EV_REL, sizeof(rel_bits)), rel_bits);
+            if (TEST_BIT(REL_X, rel_bits) && TEST_BIT(BTN_LEFT, key_bits))
+                return true;
+        }
+        return TEST_BIT(KEY_A, key_bits) && TEST_BIT(KEY_SPACE, key_bits);
+    }
+
+    static void open_device(const std::string &path)
+    {
+        const auto fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        if (!is_keyboard_or_mouse(fd)) {
+            close(fd);
+            return;
+        }
+
+        /* Timestamps are taken from the same clock os_gettime_ns() uses */
+        int clock = CLOCK_MONOTONIC;
+        if (ioctl(fd, EVIOCSCLOCKID, &clock) < 0)
+            blog(LOG_WARNING, "[input-overlay] evdev: Couldn't switch %s to monotonic timestamps", path.c_str());
+
+        auto dev = new device();
+        dev->fd = fd;
+        dev->path = path;
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = dev;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            delete dev;
+            return;
+        }
+
+        devices.emplace_back(dev);
+        DEBUG_LOG(LOG_INFO, "evdev: Reading %s", path.c_str());
+    }
+
+    static void scan_devices()
+    {
+        auto dir = opendir(EVDEV_DIR);
+        if (!dir)
+            return;
+
+        struct dirent* entry;
+        while ((entry = readdir(dir))) {
+            if (strncmp(entry->d_name, EVDEV_PREFIX, strlen(EVDEV_PREFIX)) != 0)
+                continue;
+
+            std::string path = EVDEV_DIR "/";
+            path.append(entry->d_name);
+
+            auto known = false;
+            for (const auto dev : devices) {
+                if (dev->path == path) {
+                    known = true;
+                    break;
+                }
+            }
+
+            if (!known)
+                open_device(path);
+        }
+        closedir(dir);
+    }
+
+    /* True if a device node was added or became readable */
+    static bool read_hotplug()
+    {
+        /* inotify_events have to be aligned like this */
+        char buffer[4096] __attribute__((aligned(__alignof__(inotify_event))));
+        auto changed = false;
+
+        for (;;) {
+            const auto bytes = read(inotify_fd, buffer, sizeof(buffer));
+            if (bytes <= 0)
+                break;
+
+            for (auto ptr = buffer; ptr < buffer + bytes;) {
+                const auto event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                /* Permissions are set by udev after the node was created */
+                if (event->len && strncmp(event->name, EVDEV_PREFIX, strlen(EVDEV_PREFIX)) == 0)
+                    changed = true;
+            }
+        }
+        return changed;
+    }
+
+    static void* evdev_thread_proc(void*)
+    {
+        epoll_event events[16];
+        auto run = true;
+        trace::set_thread_name("evdev hook");
+
+        while (run) {
+            /* Without inotify new devices are only found by rescanning */
+            const auto count = epoll_wait(epoll_fd, events, 16, inotify_fd >= 0 ? -1 : EVDEV_RESCAN_MS);
+            TRACE_SCOPE("evdev::read_devices");
+
+            if (count == 0) {
+                scan_devices();
+                continue;
+            }
+
+            for (int i = 0; i < count; i++) {
+                if (!events[i].data.ptr) {
+                    run = false; /* stop_fd */
+                    break;
+                }
+
+                if (events[i].data.ptr == &inotify_fd) {
+                    if (read_hotplug())
+                        scan_devices();
+                    continue;
+                }
+
+                auto dev = static_cast<device*>(events[i].data.ptr);
+                if ((events[i].events & (EPOLLERR | EPOLLHUP)) || !read_device(dev))
+                    close_device(dev);
+            }
+        }
+        return nullptr;
+    }
+
+    void start_evdev_hook()
+    {
+        if (evdev_hook_state)
+            return;
+
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        if (epoll_fd < 0 || stop_fd < 0) {
+            blog(LOG_ERROR, "[input-overlay] evdev: Couldn't create epoll instance (%s)", strerror(errno));
+            end_evdev_hook();
+            return;
+        }
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &ev);
+
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd >= 0 && inotify_add_watch(inotify_fd, EVDEV_DIR, IN_CREATE | IN_ATTRIB) >= 0) {
+            ev.data.ptr = &inotify_fd;
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, inotify_fd, &ev);
+        } else {
+            blog(LOG_WARNING, "[input-overlay] evdev: Couldn't watch " EVDEV_DIR " for new devices (%s)",
+                 strerror(errno));
+            if (inotify_fd >= 0)
+                close(inotify_fd);
+            inotify_fd = -1;
+        }
+
+        scan_devices();
+        if (devices.empty())
+            blog(LOG_WARNING, "[input-overlay] evdev: No readable keyboard or mouse found in "
+                              EVDEV_DIR ", is the user in the 'input' group?");
+        else
+            blog(LOG_INFO, "[input-overlay] evdev: Reading %lu devices", static_cast<unsigned long>(devices.size()));
+
+        evdev_hook_state = pthread_create(&evdev_thread, nullptr, evdev_thread_proc, nullptr) == 0;
+        if (!evdev_hook_state)
+            end_evdev_hook();
+    }
+
+    void end_evdev_hook()
+    {
+        if (evdev_hook_state) {
+            uint64_t one = 1;
+            if (write(stop_fd, &one, sizeof(one)) == sizeof(one))
+                pthread_join(evdev_thread, nullptr);
+            evdev_hook_state = false;
+        }
+
+        while (!devices.empty())
+            close_device(devices.back());
+
+        if (inotify_fd >= 0)
+            close(inotify_fd);
+        if (stop_fd >= 0)
+            close(stop_fd);
+        if (epoll_fd >= 0)
+            close(epoll_fd);
+        inotify_fd = stop_fd = epoll_fd = -1;
+    }
+}
@@ -0,0 +1,30 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Native keyboard and mouse backend for linux. Reads all keyboards
+ * and mice in /dev/input/event* from one thread with epoll and queues
+ * them into hook::event_ring, so it replaces libuiohook (XRecord) and
+ * works without an X server. Needs read access to the event devices,
+ * which usually means the user has to be in the 'input' group.
+ * Events keep the kernel timestamp instead of the time they were read
+ */
+namespace evdev
+{
+    extern bool evdev_hook_state;
+
+    void start_evdev_hook();
+
+    void end_evdev_hook();
+
+    /* Converts a linux KEY_* code to the uiohook VC_* code,
+     * returns VC_UNDEFINED if there's no equivalent */
+    uint16_t key_to_vc(uint16_t key);
+}
@@ -44,20 +44,20 @@ namespace gamepad
             vc = get_button_event_by_id(event->number);
 
             if (vc == PAD_L_STICK)
-                data->add_gamepad_data(pad_id, VC_STICK_DATA, new element_data_analog_stick(state, SIDE_LEFT));
+                data->add_gamepad_data(pad_id, VC_STICK_DATA, element_data_analog_stick(state, SIDE_LEFT));
             else if (vc == PAD_R_STICK)
-                data->add_gamepad_data(pad_id, VC_STICK_DATA, new element_data_analog_stick(state, SIDE_RIGHT));
+                data->add_gamepad_data(pad_id, VC_STICK_DATA, element_data_analog_stick(state, SIDE_RIGHT));
             else if (vc == PAD_DOWN)
-                data->add_gamepad_data(pad_id, VC_DPAD_DATA, new element_data_dpad(DPAD_DOWN, state));
+                data->add_gamepad_data(pad_id, VC_DPAD_DATA, element_data_dpad(DPAD_DOWN, state));
             else if (vc == PAD_UP)
-                data->add_gamepad_data(pad_id, VC_DPAD_DATA, new element_data_dpad(DPAD_UP, state));
+                data->add_gamepad_data(pad_id, VC_DPAD_DATA, element_data_dpad(DPAD_UP, state));
             else if (vc == PAD_LEFT)
-                data->add_gamepad_data(pad_id, VC_DPAD_DATA, new element_data_dpad(DPAD_LEFT, state));
+                data->add_gamepad_data(pad_id, VC_DPAD_DATA, element_data_dpad(DPAD_LEFT, state));
             else if (vc == PAD_RIGHT)
-                data->add_gamepad_data(pad_id, VC_DPAD_DATA, new element_data_dpad(DPAD_RIGHT, state));
+                data->add_gamepad_data(pad_id, VC_DPAD_DATA, element_data_dpad(DPAD_RIGHT, state));
 
             if (vc != PAD_L_STICK && vc != PAD_R_STICK)
-                data->add_gamepad_data(pad_id, PAD_TO_VC(vc), new element_data_button(state));
+                data->add_gamepad_data(pad_id, PAD_TO_VC(vc), element_data_button(state));
 
         } else if (event->type == JS_EVENT_AXIS) {
             vc = get_axis_event_by_id(event->number);
@@ -68,7 +68,7 @@ namespace gamepad
                 /* Trigger data goes from ~ -32000 to +32000, so it's offset by 0x7FFF
                  * and then divided by 0xffff to convert it to a float (0.0 - 1.0) */
                 axis = (event->value + (0xffff / 2)) / ((float) 0xffff);
-                data->add_gamepad_data(pad_id, VC_TRIGGER_DATA, new element_data_trigger(trigger, axis));
+                data->add_gamepad_data(pad_id, VC_TRIGGER_DATA, element_data_trigger(trigger, axis));
             } else {
                 axis = event->value / ((float) 0xffff);
                 stick_data_type sd;
@@ -81,7 +81,7 @@ namespace gamepad
                 else
                     sd = SD_RIGHT_X;
 
-                data->add_gamepad_data(pad_id, VC_STICK_DATA, new element_data_analog_stick(axis, sd));
+                data->add_gamepad_data(pad_id, VC_STICK_DATA, element_data_analog_stick(axis, sd));
             }
         }
     }
@@ -13,20 +13,567 @@
 #include "../util/element/element_analog_stick.hpp"
 #include "../util/element/element_trigger.hpp"
 #include "../util/element/element_dpad.hpp"
+#include "../util/config.hpp"
+#include "../util/latency_stats.hpp"
+#include "../util/trace.hpp"
+#ifdef LINUX
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <pthread.h>
+#include <string.h>
+#include <dirent.h>
+#include <time.h>
+
+/* Older headers only have the timeval member */
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+#define PAD_DIR             "/dev/input"
+#define PAD_PREFIX          "js"
+#define PAD_EVDEV_PREFIX    "event"
+#define PAD_READ_BATCH      64  /* js_events read per syscall */
+/* epoll tags, pads use their index */
+#define TAG_INOTIFY         PAD_COUNT
+#define TAG_CONTROL         (PAD_COUNT + 1)
+
+#define BITS_PER_LONG       (sizeof(long) * 8)
+#define BIT_WORDS(n)        (((n) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+#define TEST_BIT(bit, array) ((array[(bit) / BITS_PER_LONG] >> ((bit) % BITS_PER_LONG)) & 1)
+#endif
 
 namespace gamepad
 {
     bool gamepad_hook_state = false;
-    bool gamepad_hook_run_flag = true;
+    std::atomic<bool> gamepad_hook_run_flag(true);
     GamepadState pad_states[PAD_COUNT];
-    std::mutex mutex;
 #ifdef _WIN32
+    profiled_mutex mutex("gamepad::mutex");
     static HANDLE hook_thread;
 #else
 
     gamepad_binding bindings;
     uint8_t last_input = 0xff;
     static pthread_t game_pad_hook_thread;
+
+    /* The pad file descriptors are only opened and closed by the reader
+     * thread once it runs, everything else just wakes it up */
+    static int epoll_fd = -1;
+    static int inotify_fd = -1;
+    static int control_fd = -1; /* eventfd for reload requests and shutdown */
+
+    static void watch_fd(const int fd, const uint32_t tag)
+    {
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u32 = tag;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    static void close_pad(const uint8_t id)
+    {
+        auto &pad = pad_states[id];
+        if (!pad.valid())
+            return;
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pad.get_fd(), nullptr);
+        pad.unload();
+        blog(LOG_INFO, "[input-overlay] Gamepad %i disconnected", id);
+    }
+
+    static bool open_pad(const uint8_t id)
+    {
+        close_pad(id);
+        auto &pad = pad_states[id];
+        pad.init(id);
+        if (!pad.valid())
+            return false;
+
+        watch_fd(pad.get_fd(), id);
+        blog(LOG_INFO, "[input-overlay] Gamepad %i connected", id);
+        return true;
+    }
+
+    /* evdev pads don't have a fixed number, they get the first free slot */
+    static bool open_evdev_pad(const std::string &path)
+    {
+        for (auto &pad : pad_states) {
+            if (pad.valid() && pad.get_path() == path)
+                return true;
+        }
+
+        for (uint8_t id = 0; id < PAD_COUNT; id++) {
+            auto &pad = pad_states[id];
+            if (pad.valid())
+                continue;
+            if (!pad.init_evdev(id, path))
+                return false;
+
+            watch_fd(pad.get_fd(), id);
+            blog(LOG_INFO, "[input-overlay] Gamepad %i connected (%s)", id, path.c_str());
+            return true;
+        }
+        return false;
+    }
+
+    static void close_evdev_pad(const std::string &path)
+    {
+        for (uint8_t id = 0; id < PAD_COUNT; id++) {
+            if (pad_states[id].valid() && pad_states[id].get_path() == path)
+                close_pad(id);
+        }
+    }
+
+    static bool open_pads()
+    {
+        auto flag = false;
+
+        if (io_config::evdev) {
+            for (uint8_t id = 0; id < PAD_COUNT; id++)
+                close_pad(id);
+
+            auto dir = opendir(PAD_DIR);
+            if (!dir)
+                return false;
+
+            struct dirent* entry;
+            while ((entry = readdir(dir))) {
+                if (strncmp(entry->d_name, PAD_EVDEV_PREFIX, strlen(PAD_EVDEV_PREFIX)) == 0)
+                    flag = open_evdev_pad(PAD_DIR "/" + std::string(entry->d_name)) || flag;
+            }
+            closedir(dir);
+            return flag;
+        }
+
+        for (uint8_t id = 0; id < PAD_COUNT; id++)
+            flag = open_pad(id) || flag;
+        return flag;
+    }
+
+    /* Returns the pad id of a /dev/input/jsN name, or -1 */
+    static int pad_id_from_name(const char* name)
+    {
+        if (strncmp(name, PAD_PREFIX, strlen(PAD_PREFIX)) != 0)
+            return -1;
+        char* end = nullptr;
+        const auto id = strtol(name + strlen(PAD_PREFIX), &end, 10);
+        if (end == name + strlen(PAD_PREFIX) || *end != '\0' || id < 0 || id >= PAD_COUNT)
+            return -1;
+        return static_cast<int>(id);
+    }
+
+    static void handle_hotplug()
+    {
+        /* inotify_events have to be aligned like this */
+        char buffer[4096] __attribute__((aligned(__alignof__(inotify_event))));
+
+        for (;;) {
+            const auto bytes = read(inotify_fd, buffer, sizeof(buffer));
+            if (bytes <= 0)
+                break;
+
+            for (auto ptr = buffer; ptr < buffer + bytes;) {
+                const auto event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                if (!event->len)
+                    continue;
+
+                if (io_config::evdev) {
+                    if (strncmp(event->name, PAD_EVDEV_PREFIX, strlen(PAD_EVDEV_PREFIX)) != 0)
+                        continue;
+
+                    const auto path = PAD_DIR "/" + std::string(event->name);
+                    if (event->mask & IN_DELETE)
+                        close_evdev_pad(path);
+                    else
+                        open_evdev_pad(path);
+                    continue;
+                }
+
+                const auto id = pad_id_from_name(event->name);
+                if (id < 0)
+                    continue;
+
+                if (event->mask & IN_DELETE)
+                    close_pad(static_cast<uint8_t>(id));
+                else if (!pad_states[id].valid())
+                    /* The node is usually created before udev sets its permissions,
+                     * so opening it is tried again once its attributes change */
+                    open_pad(static_cast<uint8_t>(id));
+            }
+        }
+    }
+
+    /* Reads everything the pad has buffered. The input data is only
+     * locked while applying events, never during read(). Returns true
+     * if any events were applied */
+    static bool read_js_pad(const uint8_t id)
+    {
+        js_event events[PAD_READ_BATCH];
+        auto &pad = pad_states[id];
+        auto applied = false;
+
+        for (;;) {
+            const auto count = pad.read_events(events, PAD_READ_BATCH);
+            if (count < 0) {
+                close_pad(id);
+                break;
+            }
+            if (count == 0)
+                break;
+
+            /* Only the newest value of each axis in this batch is applied */
+            bool superseded[PAD_READ_BATCH] = {};
+            uint64_t seen_axes[256 / 64] = {};
+            for (int i = count - 1; i >= 0; i--) {
+                if (events[i].type != JS_EVENT_AXIS)
+                    continue;
+                const auto word = events[i].number / 64;
+                const auto bit = 1ULL << (events[i].number % 64);
+                if (seen_axes[word] & bit) {
+                    superseded[i] = true;
+                    hook::folded_axes.fetch_add(1, std::memory_order_relaxed);
+                }
+                seen_axes[word] |= bit;
+            }
+
+            {
+                PROFILED_LOCK(lock, hook::mutex);
+                if (!hook::input_data)
+                    break;
+
+                /* js_event times are jiffies in milliseconds, they only tell how
+                 * far apart the events are. The newest one counts as captured now */
+                const auto now = os_gettime_ns();
+                const auto newest = events[count - 1].time;
+                hook::input_data->set_gamepad_time(pad.get_player(), now);
+
+                /* js_event code from
+                   https://gist.github.com/jasonwhite/c5b2048c15993d285130
+                 */
+                for (int i = 0; i < count; i++) {
+                    if (superseded[i])
+                        continue;
+                    auto &event = events[i];
+                    latency_stats::record(latency_stats::ORIGIN_LOCAL, latency_stats::STAGE_CAPTURE_INGEST,
+                                          now - static_cast<uint32_t>(newest - event.time) * 1000000ull, now);
+                    switch (event.type) {
+                        case JS_EVENT_BUTTON:
+                            if (event.value)
+                                last_input = event.number;
+                            bindings.handle_event(pad.get_player(), hook::input_data, &event);
+                            break;
+                        case JS_EVENT_AXIS:
+                            last_input = event.number;
+                            bindings.handle_event(pad.get_player(), hook::input_data, &event);
+                            break;
+                        default:;
+                    }
+                }
+            }
+            applied = true;
+
+            if (count < PAD_READ_BATCH)
+                break;
+        }
+        return applied;
+    }
+
+    /* Same as above, but complete reports are applied at once, so
+     * all axis changes of one report show up in the same frame.
+     * Reports with only axis changes are held back, if another one
+     * follows in the same read they're folded into it. Reports with
+     * button changes are always applied, so no transition gets lost */
+    static bool read_evdev_pad(const uint8_t id)
+    {
+        input_event events[PAD_READ_BATCH];
+        auto &pad = pad_states[id];
+        auto applied = false;
+        auto held_back = false;
+
+        for (;;) {
+            const auto count = pad.read_events(events, PAD_READ_BATCH);
+            if (count < 0) {
+                close_pad(id);
+                return applied;
+            }
+            if (count == 0)
+                break;
+
+            for (int i = 0; i < count; i++) {
+                if (!pad.handle_evdev_event(events[i]))
+                    continue;
+
+                if (!pad.report_has_buttons()) {
+                    if (held_back)
+                        hook::folded_axes.fetch_add(1, std::memory_order_relaxed);
+                    held_back = true;
+                    continue;
+                }
+
+                PROFILED_LOCK(lock, hook::mutex);
+                if (hook::input_data) {
+                    pad.apply_report(hook::input_data);
+                    applied = true;
+                }
+                held_back = false;
+            }
+
+            if (count < PAD_READ_BATCH)
+                break;
+        }
+
+        if (held_back) {
+            PROFILED_LOCK(lock, hook::mutex);
+            if (hook::input_data) {
+                pad.apply_report(hook::input_data);
+                applied = true;
+            }
+        }
+        return applied;
+    }
+
+    static bool read_pad(const uint8_t id)
+    {
+        return pad_states[id].is_evdev() ? read_evdev_pad(id) : read_js_pad(id);
+    }
+
+    /* Linux gamepad API button layout, see
+     * https://www.kernel.org/doc/html/latest/input/gamepad.html
+     */
+    struct evdev_button
+    {
+        uint16_t code;
+        uint16_t vc;
+    };
+
+    static const evdev_button evdev_buttons[] = {
+        {BTN_A, VC_PAD_A},
+        {BTN_B, VC_PAD_B},
+        {BTN_X, VC_PAD_X},
+        {BTN_Y, VC_PAD_Y},
+        {BTN_TL, VC_PAD_LB},
+        {BTN_TR, VC_PAD_RB},
+        {BTN_SELECT, VC_PAD_BACK},
+        {BTN_START, VC_PAD_START},
+        {BTN_MODE, VC_PAD_GUIDE},
+    };
+
+    struct evdev_dpad
+    {
+        uint16_t code;
+        dpad_direction dir;
+        uint16_t vc;
+    };
+
+    static const evdev_dpad evdev_dpad_buttons[] = {
+        {BTN_DPAD_LEFT, DPAD_LEFT, VC_PAD_DPAD_LEFT},
+        {BTN_DPAD_RIGHT, DPAD_RIGHT, VC_PAD_DPAD_RIGHT},
+        {BTN_DPAD_UP, DPAD_UP, VC_PAD_DPAD_UP},
+        {BTN_DPAD_DOWN, DPAD_DOWN, VC_PAD_DPAD_DOWN},
+    };
+
+    static uint64_t event_time(const input_event &event)
+    {
+        return static_cast<uint64_t>(event.input_event_sec) * 1000000000ULL +
+               static_cast<uint64_t>(event.input_event_usec) * 1000ULL;
+    }
+
+    bool GamepadState::init_evdev(const uint8_t pad_id, const std::string &path)
+    {
+        unload();
+        m_player = pad_id;
+        m_path = path;
+        load();
+        if (!valid())
+            return false;
+
+        unsigned long ev_bits[BIT_WORDS(EV_MAX + 1)] = {};
+        unsigned long key_bits[BIT_WORDS(KEY_MAX + 1)] = {};
+        unsigned long abs_bits[BIT_WORDS(ABS_MAX + 1)] = {};
+        ioctl(m_controller_id, EVIOCGBIT(0, sizeof(ev_bits)), ev_bits);
+        ioctl(m_controller_id, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits);
+        ioctl(m_controller_id, EVIOCGBIT(EV_ABS, sizeof(abs_bits)), abs_bits);
+
+        if (!TEST_BIT(EV_KEY, ev_bits) || !TEST_BIT(EV_ABS, ev_bits) ||
+            !TEST_BIT(BTN_GAMEPAD, key_bits) || !TEST_BIT(ABS_X, abs_bits)) {
+            unload();
+            return false;
+        }
+
+        /* Timestamps are taken from the same clock os_gettime_ns() uses */
+        int clock = CLOCK_MONOTONIC;
+        ioctl(m_controller_id, EVIOCSCLOCKID, &clock);
+
+        memset(m_abs, 0, sizeof(m_abs));
+        memset(&m_report, 0, sizeof(m_report));
+        m_report.thumbs[0] = m_report.thumbs[1] = STATE_RELEASED;
+
+        /* The absinfo also contains the current value, so the
+         * first report already has the right stick positions */
+        for (uint16_t axis = 0; axis < PAD_ABS_COUNT; axis++) {
+            if (TEST_BIT(axis, abs_bits))
+                ioctl(m_controller_id, EVIOCGABS(axis), &m_abs[axis]);
+        }
+
+        for (uint16_t axis = 0; axis < PAD_ABS_COUNT; axis++) {
+            if (!TEST_BIT(axis, abs_bits))
+                continue;
+            input_event initial = {};
+            initial.type = EV_ABS;
+            initial.code = axis;
+            initial.value = m_abs[axis].value;
+            handle_evdev_event(initial);
+        }
+        m_report.time = 0;
+        m_evdev = true;
+        return true;
+    }
+
+    float GamepadState::normalize(const uint16_t axis, const int32_t value, const bool centered) const
+    {
+        const auto &abs = m_abs[axis];
+        const auto range = static_cast<float>(abs.maximum) - abs.minimum;
+        if (range <= 0.f)
+            return 0.f;
+
+        if (!centered)
+            return UTIL_CLAMP(0.f, (value - abs.minimum) / range, 1.f);
+
+        const auto offset = value - (abs.minimum + range / 2.f);
+        if (offset >= -abs.flat && offset <= abs.flat)
+            return 0.f;
+        return UTIL_CLAMP(-1.f, offset / (range / 2.f), 1.f);
+    }
+
+    bool GamepadState::handle_evdev_event(const input_event &event)
+    {
+        if (m_report.dropped) {
+            /* Everything until the next report is incomplete */
+            if (event.type == EV_SYN && event.code == SYN_REPORT)
+                m_report.dropped = false;
+            return false;
+        }
+
+        switch (event.type) {
+            case EV_KEY: {
+                m_report.has_buttons = true;
+                const auto state = event.value ? STATE_PRESSED : STATE_RELEASED;
+
+                if (event.code == BTN_THUMBL || event.code == BTN_THUMBR) {
+                    m_report.thumbs[event.code == BTN_THUMBR] = state;
+                    m_report.sticks_changed = true;
+                } else if (event.code == BTN_TL2 || event.code == BTN_TR2) {
+                    /* Pads with digital triggers */
+                    m_report.triggers[event.code == BTN_TR2] = event.value ? 1.f : 0.f;
+                    m_report.triggers_changed = true;
+                }
+
+                for (const auto &dpad : evdev_dpad_buttons) {
+                    if (dpad.code != event.code)
+                        continue;
+                    if (event.value)
+                        m_report.dpad |= dpad.dir;
+                    else
+                        m_report.dpad &= ~dpad.dir;
+                }
+
+                for (const auto &button : evdev_buttons) {
+                    if (button.code != event.code || m_report.button_count >= 32)
+                        continue;
+                    m_report.buttons[m_report.button_count].vc = button.vc;
+                    m_report.buttons[m_report.button_count++].state = state;
+                }
+                break;
+            }
+            case EV_ABS:
+                switch (event.code) {
+                    case ABS_X:
+                    case ABS_Y:
+                        m_report.sticks[event.code - ABS_X] = normalize(event.code, event.value, true);
+                        m_report.sticks_changed = true;
+                        break;
+                    case ABS_RX:
+                    case ABS_RY:
+                        m_report.sticks[2 + event.code - ABS_RX] = normalize(event.code, event.value, true);
+                        m_report.sticks_changed = true;
+                        break;
+                    case ABS_Z:
+                    case ABS_BRAKE:
+                        m_report.triggers[0] = normalize(event.code, event.value, false);
+                        m_report.triggers_changed = true;
+                        break;
+                    case ABS_RZ:
+                    case ABS_GAS:
+                        m_report.triggers[1] = normalize(event.code, event.value, false);
+                        m_report.triggers_changed = true;
+                        break;
+                    case ABS_HAT0X:
+                        m_report.has_buttons = true;
+                        m_report.dpad &= ~(DPAD_LEFT | DPAD_RIGHT);
+                        if (event.value)
+                            m_report.dpad |= event.value < 0 ? DPAD_LEFT : DPAD_RIGHT;
+                        break;
+                    case ABS_HAT0Y:
+                        m_report.has_buttons = true;
+                        m_report.dpad &= ~(DPAD_UP | DPAD_DOWN);
+                        if (event.value)
+                            m_report.dpad |= event.value < 0 ? DPAD_UP : DPAD_DOWN;
+                        break;
+                    default:;
+                }
+                break;
+            case EV_SYN:
+                if (event.code == SYN_REPORT) {
+                    m_report.time = event_time(event);
+                    return true;
+                }
+                if (event.code == SYN_DROPPED) {
+                    m_report.button_count = 0;
+                    m_report.dropped = true;
+                }
+                break;
+            default:;
+        }
+        return false;
+    }
+
+    void GamepadState::apply_report(element_data_holder* data)
+    {
+        for (uint8_t i = 0; i < m_report.button_count; i++)
+            data->add_gamepad_data(m_player, m_report.buttons[i].vc, element_data_button(m_report.buttons[i].state));
+
+        const auto dpad_changes = m_report.dpad ^ m_report.applied_dpad;
+        for (const auto &dpad : evdev_dpad_buttons) {
+            if (!(dpad_changes & dpad.dir))
+                continue;
+            const auto state = m_report.dpad & dpad.dir ? STATE_PRESSED : STATE_RELEASED;
+            data->add_gamepad_data(m_player, VC_DPAD_DATA, element_data_dpad(dpad.dir, state));
+            data->add_gamepad_data(m_player, dpad.vc, element_data_button(state));
+        }
+
+        if (m_report.sticks_changed) {
+            data->add_gamepad_data(m_player, VC_STICK_DATA, element_data_analog_stick(
+                    m_report.thumbs[0], m_report.thumbs[1], m_report.sticks[0], m_report.sticks[1],
+                    m_report.sticks[2], m_report.sticks[3]));
+        }
+
+        if (m_report.triggers_changed) {
+            data->add_gamepad_data(m_player, VC_TRIGGER_DATA,
+                                   element_data_trigger(m_report.triggers[0], m_report.triggers[1]));
+        }
+
+        data->set_gamepad_time(m_player, m_report.time);
+        latency_stats::record(latency_stats::ORIGIN_LOCAL, latency_stats::STAGE_CAPTURE_INGEST, m_report.time,
+                              os_gettime_ns());
+
+        m_report.button_count = 0;
+        m_report.applied_dpad = m_report.dpad;
+        m_report.sticks_changed = m_report.triggers_changed = m_report.has_buttons = false;
+    }
 #endif
 
     void start_pad_hook()
@@ -42,20 +589,42 @@ namespace gamepad
             blog(LOG_INFO, "[input-overlay] Gamepad hook init failed");
             return;
         }
-#endif
         gamepad_hook_state = gamepad_hook_run_flag = init_pad_devices();
 
-#ifdef _WIN32
         hook_thread = CreateThread(nullptr, 0, static_cast<LPTHREAD_START_ROUTINE>(hook_method),
             nullptr, 0, nullptr);
         gamepad_hook_state = hook_thread;
 #else
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        control_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        if (epoll_fd < 0 || control_fd < 0) {
+            blog(LOG_ERROR, "[input-overlay] Gamepad hook init failed (%s)", strerror(errno));
+            end_pad_hook();
+            return;
+        }
+        watch_fd(control_fd, TAG_CONTROL);
+
+        /* Pads are attached and detached while running if /dev/input can be watched */
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd >= 0 && inotify_add_watch(inotify_fd, PAD_DIR, IN_CREATE | IN_ATTRIB | IN_DELETE) >= 0) {
+            watch_fd(inotify_fd, TAG_INOTIFY);
+        } else {
+            blog(LOG_WARNING, "[input-overlay] Couldn't watch " PAD_DIR ", gamepads will only be "
+                              "detected when reloading them");
+        }
+
+        init_pad_devices();
+        gamepad_hook_run_flag = true;
         gamepad_hook_state = pthread_create(&game_pad_hook_thread, nullptr, hook_method, nullptr) == 0;
+        if (!gamepad_hook_state)
+            end_pad_hook();
 #endif
     }
 
     bool init_pad_devices()
     {
+#ifdef _WIN32
         uint8_t id = 0;
         auto flag = false;
         for (auto &state : pad_states) {
@@ -64,6 +633,14 @@ namespace gamepad
                 flag = true;
         }
         return flag;
+#else
+        if (gamepad_hook_state) {
+            /* The reader thread owns the pads, let it reopen them */
+            uint64_t one = 1;
+            return write(control_fd, &one, sizeof(one)) == sizeof(one);
+        }
+        return open_pads();
+#endif
     }
 
     void end_pad_hook()
@@ -72,44 +649,58 @@ namespace gamepad
 
 #ifdef _WIN32
         CloseHandle(hook_thread);
+#else
+        if (gamepad_hook_state) {
+            uint64_t one = 1;
+            if (write(control_fd, &one, sizeof(one)) == sizeof(one))
+                pthread_join(game_pad_hook_thread, nullptr);
+            gamepad_hook_state = false;
+        }
+
+        for (uint8_t id = 0; id < PAD_COUNT; id++)
+            close_pad(id);
+
+        for (auto fd : { &inotify_fd, &control_fd, &epoll_fd }) {
+            if (*fd >= 0)
+                close(*fd);
+            *fd = -1;
+        }
 #endif
     }
 
     /* Background process for quering game pads */
 #ifdef _WIN32
     DWORD WINAPI hook_method(const LPVOID arg)
-#else
-
-    void* hook_method(void*)
-#endif
     {
+        trace::set_thread_name("gamepad hook");
         while (gamepad_hook_run_flag) {
             if (!hook::input_data)
                 break;
-            mutex.lock();
 
             for (auto &pad : pad_states) {
+                TRACE_SCOPE("gamepad::hook_method");
+                PROFILED_LOCK(pad_lock, mutex);
                 if (!pad.valid())
                     continue;
 
-#ifdef _WIN32
                 dpad_direction dir[] = { DPAD_CENTER, DPAD_CENTER };
+                PROFILED_LOCK(lock, hook::mutex);
 
                 for (const auto& button : xinput_fix::all_codes)
                 {
                     const auto state = pressed(pad.get_xinput(), button);
                     hook::input_data->add_gamepad_data(pad.get_id(), xinput_fix::to_vc(button),
-                        new element_data_button(state));
+                        element_data_button(state));
                 }
 
                 /* Dpad direction */
                 get_dpad(pad.get_xinput(), dir);
                 hook::input_data->add_gamepad_data(pad.get_id(), VC_DPAD_DATA,
-                    new element_data_dpad(dir[0], dir[1]));
+                    element_data_dpad(dir[0], dir[1]));
 
                 /* Analog sticks */
                 hook::input_data->add_gamepad_data(pad.get_id(), VC_STICK_DATA,
-                    new element_data_analog_stick(
+                    element_data_analog_stick(
                         pressed(pad.get_xinput(), xinput_fix::CODE_LEFT_THUMB),
                         pressed(pad.get_xinput(), xinput_fix::CODE_RIGHT_THUMB),
                         stick_l_x(pad.get_xinput()), -stick_l_y(pad.get_xinput()),
@@ -118,45 +709,53 @@ namespace gamepad
 
                 /* Trigger buttons */
                 hook::input_data->add_gamepad_data(pad.get_id(), VC_TRIGGER_DATA,
-                    new element_data_trigger(
+                    element_data_trigger(
                         trigger_l(pad.get_xinput()), trigger_r(pad.get_xinput())
                     ));
+                hook::input_data->publish();
+            }
+            os_sleep_ms(25);
+        }
+
+        return UIOHOOK_SUCCESS;
+    }
 #else
-                if (pad.read_event() == -1) {
-                    pad.unload();
-                    continue;
-                }
 
-                /* js_event code from
-                   https://gist.github.com/jasonwhite/c5b2048c15993d285130
-                 */
-                switch (pad.get_event()->type) {
-                    case JS_EVENT_BUTTON:
-                        if (pad.get_event()->value)
-                            last_input = pad.get_event()->number;
-                        bindings.handle_event(pad.get_player(), hook::input_data, pad.get_event());
-                        break;
-                    case JS_EVENT_AXIS:
-                        last_input = pad.get_event()->number;
-                        bindings.handle_event(pad.get_player(), hook::input_data, pad.get_event());
+    void* hook_method(void*)
+    {
+        epoll_event events[PAD_COUNT + 2];
+        trace::set_thread_name("gamepad hook");
+
+        while (gamepad_hook_run_flag) {
+            const auto count = epoll_wait(epoll_fd, events, PAD_COUNT + 2, -1);
+            TRACE_SCOPE("gamepad::hook_method");
+            auto applied = false;
+
+            for (int i = 0; i < count; i++) {
+                const auto tag = events[i].data.u32;
+
+                if (tag == TAG_CONTROL) {
+                    uint64_t value;
+                    if (read(control_fd, &value, sizeof(value)) < 0)
+                        continue;
+                    if (!gamepad_hook_run_flag)
                         break;
-                    default:;
+                    open_pads(); /* Reload requested */
+                } else if (tag == TAG_INOTIFY) {
+                    handle_hotplug();
+                } else if (pad_states[tag].valid()) {
+                    /* Pads closed earlier in this loop can still show up here */
+                    applied = read_pad(static_cast<uint8_t>(tag)) || applied;
                 }
+            }
 
-#endif /* LINUX */
-                mutex.unlock();
+            if (applied) {
+                PROFILED_LOCK(lock, hook::mutex);
+                if (hook::input_data)
+                    hook::input_data->publish();
             }
-#ifdef  _WIN32 /* Delay on linux results in buffered input */
-            os_sleep_ms(25);
-#endif
         }
-
-        //for (auto& state : pad_states)
-        //    state.unload();
-#ifdef _WIN32
-        return UIOHOOK_SUCCESS;
-#else
-        pthread_exit(nullptr);
-#endif
+        return nullptr;
     }
+#endif
 }
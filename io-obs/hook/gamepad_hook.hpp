@@ -16,11 +16,15 @@
 #include <malloc.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
 #include <linux/joystick.h>
+#include <linux/input.h>
 #endif
 #include "util/util.hpp"
+#include "util/layout_constants.hpp"
 #include <stdio.h>
-#include <mutex>
+#include "util/profiled_mutex.hpp"
+#include <atomic>
 
 namespace gamepad
 {
@@ -30,6 +34,32 @@ namespace gamepad
     extern uint8_t last_input; /* Used in config screen to bind buttons */
 
 
+    /* Axes of evdev pads that are read, everything
+     * up to ABS_HAT0Y covers sticks, triggers and the dpad */
+#define PAD_ABS_COUNT (ABS_HAT0Y + 1)
+
+    /* State of an evdev pad, changes are collected until the
+     * kernel ends the report with SYN_REPORT */
+    struct evdev_report
+    {
+        float sticks[4];          /* Left x/y, right x/y, -1.0 - 1.0 */
+        float triggers[2];        /* Left/right, 0.0 - 1.0 */
+        uint16_t dpad;            /* dpad_direction bits */
+        uint16_t applied_dpad;    /* dpad bits at the last report */
+        button_state thumbs[2];   /* Left/right stick presses */
+        bool sticks_changed;
+        bool triggers_changed;
+        bool has_buttons;         /* Report has button or dpad events */
+        bool dropped;             /* Kernel buffer overflowed, skip until next report */
+        uint8_t button_count;
+        struct
+        {
+            uint16_t vc;
+            button_state state;
+        } buttons[32];            /* Button changes of this report */
+        uint64_t time;            /* Kernel time of the report */
+    };
+
     struct GamepadState
     {
         ~GamepadState()
@@ -39,12 +69,16 @@ namespace gamepad
 
         void unload()
         {
-            close(m_controller_id);
+            if (m_controller_id >= 0)
+                close(m_controller_id);
+            m_controller_id = -1;
+            m_evdev = false;
         }
 
         void load()
         {
-            m_controller_id = open(m_path.c_str(), O_RDONLY);
+            /* Non blocking, so an idle pad never holds up the others */
+            m_controller_id = open(m_path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
 #if _DEBUG
             blog(LOG_INFO, "Gamepad %i present: %s", m_controller_id, valid() ? "true" : "false");
 #endif
@@ -63,26 +97,55 @@ namespace gamepad
             load();
         }
 
+        /* Opens an event device instead of the joystick interface.
+         * Fails if the device isn't a game pad */
+        bool init_evdev(uint8_t pad_id, const std::string &path);
+
         uint8_t get_player() const
         { return m_player; }
 
-        int read_event()
-        {
-            ssize_t bytes;
-            bytes = read(m_controller_id, &m_event, sizeof(m_event));
-            if (bytes == sizeof(m_event))
-                return 0;
+        int get_fd() const
+        { return m_controller_id; }
+
+        bool is_evdev() const
+        { return m_evdev; }
 
-            /* Error, could not read full event. */
-            return -1;
+        const std::string &get_path() const
+        { return m_path; }
+
+        /* Reads up to max buffered events, returns the amount
+         * read or -1 if the pad is gone */
+        template<class T>
+        int read_events(T* events, size_t max)
+        {
+            const auto bytes = read(m_controller_id, events, max * sizeof(T));
+            if (bytes < 0)
+                return errno == EAGAIN || errno == EINTR ? 0 : -1;
+            if (bytes == 0)
+                return -1;
+            return static_cast<int>(static_cast<size_t>(bytes) / sizeof(T));
         }
 
-        js_event* get_event() { return &m_event; }
+        /* evdev pads only. Adds the event to the current report,
+         * returns true once the report is complete */
+        bool handle_evdev_event(const input_event &event);
+
+        bool report_has_buttons() const
+        { return m_report.has_buttons; }
+
+        /* evdev pads only. Applies and resets the current report,
+         * caller has to hold hook::mutex */
+        void apply_report(element_data_holder* data);
+
     private:
+        float normalize(uint16_t axis, int32_t value, bool centered) const;
+
         std::string m_path;
         int m_controller_id = -1; /* Id assigned by the open command */
         uint8_t m_player; /* 0 - 4 */
-        js_event m_event;
+        bool m_evdev = false;
+        input_absinfo m_abs[PAD_ABS_COUNT]; /* Axis ranges reported by EVIOCGABS */
+        evdev_report m_report;
     };
 
 #endif /* LINUX */
@@ -161,13 +224,18 @@ namespace gamepad
 
     void end_pad_hook();
 
+    /* (Re)opens all pads. Once the hook runs on linux this
+     * only asks the reader thread to do so */
     bool init_pad_devices();
 
-    /* Mutex for thread safety */
-    extern std::mutex mutex;
+#ifdef _WIN32
+    /* Mutex for thread safety. On linux the pads are only
+     * touched by the reader thread, which doesn't need one */
+    extern profiled_mutex mutex;
+#endif
     /* Four structs containing info to query gamepads */
     extern GamepadState pad_states[PAD_COUNT];
     /* Init state of hook */
     extern bool gamepad_hook_state;
     /* False will end thread */
-    extern bool gamepad_hook_run_flag; }
+    extern std::atomic<bool> gamepad_hook_run_flag; }
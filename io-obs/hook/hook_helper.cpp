@@ -11,6 +11,11 @@
 #include "../util/element/element_mouse_wheel.hpp"
 #include "../util/element/element_button.hpp"
 #include "util/element/element_mouse_movement.hpp"
+#include "util/config.hpp"
+#include "util/frame_scheduler.hpp"
+#include "util/latency_stats.hpp"
+#include "util/recording/recorder.hpp"
+#include "util/trace.hpp"
 #include <cstdarg>
 #include <util/platform.h>
 
@@ -22,13 +27,31 @@ namespace hook
         https://github.com/kwhat/libuiohook/blob/master/src/demo_hook_async.c
     */
 
-    uint64_t last_wheel = 0; /* System time at last scroll event */
     element_data_holder* input_data = nullptr; /* Data for local input events */
     wint_t last_character;
     int16_t mouse_x, mouse_y, mouse_x_smooth, mouse_y_smooth, mouse_last_x, mouse_last_y;
     bool hook_initialized = false;
     bool data_initialized = false;
-    std::mutex mutex;
+    profiled_mutex mutex("hook::mutex");
+    spsc_ring<raw_event, EVENT_RING_SIZE> event_ring;
+    static uint64_t last_dropped = 0; /* Dropped event count at last drain */
+    std::atomic<uint64_t> folded_moves(0);
+    std::atomic<uint64_t> folded_axes(0);
+
+    /* Scroll wheel direction is reset once no scroll event came in for SCROLL_TIMEOUT */
+    static void release_wheel(void*)
+    {
+        if (input_data && input_data->data_exists(VC_MOUSE_WHEEL)) {
+            const element_data release = element_data_wheel(WHEEL_DIR_NONE);
+            input_data->add_data(VC_MOUSE_WHEEL, release);
+            input_data->publish();
+            /* Local button data isn't recorded, but replays need the release */
+            if (recorder::active())
+                recorder::record_data(LOG_SOURCE_LOCAL, VC_MOUSE_WHEEL, release);
+        }
+    }
+
+    static deadline_timer wheel_timer(release_wheel, nullptr);
 
 
 #ifdef _WIN32
@@ -43,6 +66,45 @@ namespace hook
     static pthread_cond_t hook_control_cond;
 #endif
 
+    /* Runs on the hook thread, so this has to stay cheap. The event
+     * is only copied into the ring, everything else happens in drain_events
+     */
+    static void queue_event(const uiohook_event* const event)
+    {
+        raw_event e = {};
+        e.time = os_gettime_ns();
+        e.type = event->type;
+
+        switch (event->type) {
+            case EVENT_KEY_PRESSED:
+            case EVENT_KEY_RELEASED:
+                e.code = event->data.keyboard.keycode;
+                break;
+            case EVENT_KEY_TYPED:
+                e.code = event->data.keyboard.keychar;
+                break;
+            case EVENT_MOUSE_PRESSED:
+            case EVENT_MOUSE_RELEASED:
+            case EVENT_MOUSE_MOVED:
+            case EVENT_MOUSE_DRAGGED:
+                e.code = event->data.mouse.button;
+                e.x = event->data.mouse.x;
+                e.y = event->data.mouse.y;
+                break;
+            case EVENT_MOUSE_WHEEL:
+                e.x = event->data.wheel.x;
+                e.y = event->data.wheel.y;
+                e.amount = event->data.wheel.amount;
+                e.rotation = event->data.wheel.rotation;
+                break;
+            default:
+                return; /* Hook state and click events aren't used */
+        }
+
+        /* Fails if the ring is full, which is counted by the ring itself */
+        event_ring.push(e);
+    }
+
     void dispatch_proc(uiohook_event* const event)
     {
         switch (event->type) {
@@ -78,12 +140,13 @@ namespace hook
 #endif
             default:; /* Prevent missing case error */
         }
-        process_event(event);
+        queue_event(event);
     }
 
 #ifdef _WIN32
     DWORD WINAPI hook_thread_proc(const LPVOID arg)
     {
+        trace::set_thread_name("uiohook");
         /* Set the hook status. */
         const auto status = hook_run();
         if (status != UIOHOOK_SUCCESS)
@@ -98,6 +161,7 @@ namespace hook
 #else
     void* hook_thread_proc(void* arg)
     {
+        trace::set_thread_name("uiohook");
         int status = hook_run();
         if (status != UIOHOOK_SUCCESS) {
             *(int*) arg = status;
@@ -136,9 +200,26 @@ namespace hook
 #endif
     }
 
+    void end_data_holder()
+    {
+        PROFILED_LOCK_MANUAL(mutex);
+        blog(LOG_INFO, "[input-overlay] Event queue: %llu events queued, %llu dropped, highest fill %llu/%llu",
+             static_cast<unsigned long long>(event_ring.pushed()),
+             static_cast<unsigned long long>(event_ring.dropped()),
+             static_cast<unsigned long long>(event_ring.high_water()),
+             static_cast<unsigned long long>(event_ring.capacity()));
+        blog(LOG_INFO, "[input-overlay] Folded events: %llu mouse moves, %llu gamepad axes",
+             static_cast<unsigned long long>(folded_moves.load()),
+             static_cast<unsigned long long>(folded_axes.load()));
+        frame_scheduler::timers.cancel(wheel_timer);
+        delete input_data;
+        input_data = nullptr;
+        data_initialized = false;
+        mutex.unlock();
+    }
+
     void end_hook()
     {
-        mutex.lock();
 #ifdef _WIN32
         /* Create event handles for the thread hook. */
         CloseHandle(hook_thread);
@@ -150,9 +231,7 @@ namespace hook
         pthread_mutex_destroy(&hook_control_mutex);
         pthread_cond_destroy(&hook_control_cond);
 #endif
-        delete input_data;
-        input_data = nullptr;
-        mutex.unlock();
+        hook_initialized = false;
     }
 
     void start_hook()
@@ -222,74 +301,119 @@ namespace hook
         }
     }
 
-    void process_event(uiohook_event* const event)
+    void drain_events()
     {
-        if (!input_data)
-            return;
-        mutex.lock();
+        TRACE_SCOPE("hook::drain_events");
+        if (input_data) {
+            /* Only the newest of consecutive mouse moves is applied. The position
+             * delta then covers the whole run instead of just the last step */
+            raw_event move = {};
+            auto has_move = false;
+            const auto record = recorder::active();
+            const auto now = os_gettime_ns();
+            const auto count = event_ring.drain([&](const raw_event &e)
+            {
+                latency_stats::record(latency_stats::ORIGIN_LOCAL, latency_stats::STAGE_CAPTURE_INGEST, e.time, now);
+
+                /* Recorded before folding, so the log has every event */
+                if (record)
+                    recorder::record_event(e);
+
+                if (e.type == EVENT_MOUSE_MOVED || e.type == EVENT_MOUSE_DRAGGED) {
+                    if (has_move)
+                        folded_moves.fetch_add(1, std::memory_order_relaxed);
+                    move = e;
+                    has_move = true;
+                    return;
+                }
 
-        element_data* d = nullptr;
-        element_data_wheel* wheel = nullptr;
-        wheel_direction dir;
+                if (has_move) {
+                    process_event(move, input_data);
+                    has_move = false;
+                }
+                process_event(e, input_data);
+            });
+
+            if (has_move)
+                process_event(move, input_data);
+            if (count > 0)
+                input_data->publish();
+            trace::counter("hook events", static_cast<int64_t>(count));
+        } else {
+            /* Nothing to apply the events to, just free up the ring */
+            event_ring.drain([](const raw_event &)
+                             {});
+        }
 
-        if (os_gettime_ns() - hook::last_wheel >= SCROLL_TIMEOUT) {
-            if (input_data) d = input_data->get_by_code(VC_MOUSE_WHEEL);
-            if (d) wheel = dynamic_cast<element_data_wheel*>(d);
-            if (wheel) wheel->set_dir(WHEEL_DIR_NONE);
+        const auto dropped = event_ring.dropped();
+        if (dropped != last_dropped) {
+            DEBUG_LOG(LOG_WARNING, "Event queue is full, dropped %llu events (%llu in total)",
+                      static_cast<unsigned long long>(dropped - last_dropped),
+                      static_cast<unsigned long long>(dropped));
+            last_dropped = dropped;
         }
+    }
 
-        switch (event->type) {
+    void process_event(const raw_event &event, element_data_holder* data)
+    {
+        TRACE_SCOPE("hook::process_event");
+        wheel_direction dir;
+
+        data->set_event_time(event.time);
+        switch (event.type) {
             case EVENT_KEY_PRESSED:
             case EVENT_KEY_RELEASED:/* Fallthrough */
-                input_data->add_data(event->data.keyboard.keycode, new element_data_button(
-                        event->type == EVENT_KEY_PRESSED ? STATE_PRESSED : STATE_RELEASED));
+                data->add_data(event.code, element_data_button(
+                        event.type == EVENT_KEY_PRESSED ? STATE_PRESSED : STATE_RELEASED));
                 break;
             case EVENT_MOUSE_WHEEL:
-                last_wheel = os_gettime_ns();
-                if (event->data.wheel.rotation >= WHEEL_DOWN)
+                /* Other holders (replays) get the release from the log */
+                if (data == input_data)
+                    frame_scheduler::timers.schedule(wheel_timer, event.time + SCROLL_TIMEOUT);
+                if (event.rotation >= WHEEL_DOWN)
                     dir = WHEEL_DIR_DOWN;
                 else
                     dir = WHEEL_DIR_UP;
 
-                input_data->add_data(VC_MOUSE_WHEEL, new element_data_wheel(dir));
-                input_data->add_data(VC_MOUSE_DATA, new element_data_mouse_stats(event->data.wheel.amount, dir, false));
+                data->add_data(VC_MOUSE_WHEEL, element_data_wheel(dir));
+                data->add_data(VC_MOUSE_DATA, element_data_mouse_stats(event.amount, dir, false));
                 break;
             case EVENT_MOUSE_PRESSED:
             case EVENT_MOUSE_RELEASED:
-                if (util_mouse_to_vc(event->data.mouse.button) == VC_MOUSE_BUTTON3)
+                if (util_mouse_to_vc(event.code) == VC_MOUSE_BUTTON3)
                     /* Special case :/ */
-                    input_data->add_data(VC_MOUSE_WHEEL, new element_data_wheel(
-                            event->type == EVENT_MOUSE_PRESSED ? STATE_PRESSED : STATE_RELEASED));
+                    data->add_data(VC_MOUSE_WHEEL, element_data_wheel(
+                            event.type == EVENT_MOUSE_PRESSED ? STATE_PRESSED : STATE_RELEASED));
                 else
-                    input_data->add_data(util_mouse_to_vc(event->data.mouse.button), new element_data_button(
-                            event->type == EVENT_MOUSE_PRESSED ? STATE_PRESSED : STATE_RELEASED));
+                    data->add_data(util_mouse_to_vc(event.code), element_data_button(
+                            event.type == EVENT_MOUSE_PRESSED ? STATE_PRESSED : STATE_RELEASED));
 
-                switch (event->data.mouse.button) {
+                switch (event.code) {
                     case MOUSE_BUTTON1:
-                        input_data->add_data(VC_MOUSE_DATA, new element_data_mouse_stats(stat_lmb));
+                        data->add_data(VC_MOUSE_DATA, element_data_mouse_stats(stat_lmb));
                         break;
                     case MOUSE_BUTTON2:
-                        input_data->add_data(VC_MOUSE_DATA, new element_data_mouse_stats(stat_rmb));
+                        data->add_data(VC_MOUSE_DATA, element_data_mouse_stats(stat_rmb));
                         break;
                     case MOUSE_BUTTON3:
-                        input_data->add_data(VC_MOUSE_DATA, new element_data_mouse_stats(stat_mmb));
+                        data->add_data(VC_MOUSE_DATA, element_data_mouse_stats(stat_mmb));
                         break;
                     default:;
                 }
 
                 break;
             case EVENT_KEY_TYPED:
-                last_character = event->data.keyboard.keychar;
+                /* Replayed events go into the replay's own holder
+                 * and mustn't show up as typed locally */
+                if (data == input_data)
+                    last_character = event.code;
                 break;
             case EVENT_MOUSE_DRAGGED:
             case EVENT_MOUSE_MOVED:
-                input_data->add_data(VC_MOUSE_DATA,
-                                     new element_data_mouse_stats(event->data.mouse.x, event->data.mouse.y));
+                data->add_data(VC_MOUSE_DATA, element_data_mouse_stats(event.x, event.y));
                 break;
             default:;
         }
-
-        mutex.unlock();
     }
 
     int hook_enable()
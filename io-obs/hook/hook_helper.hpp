@@ -8,8 +8,10 @@
 #pragma once
 
 #include <uiohook.h>
-#include <mutex>
+#include "../util/profiled_mutex.hpp"
+#include <atomic>
 #include "../util/util.hpp"
+#include "../util/spsc_ring.hpp"
 
 #ifdef LINUX
 #include <stdint.h>
@@ -19,16 +21,38 @@
 
 class element_data_holder;
 
+/* Amount of events the hook thread can queue between two frames */
+#define EVENT_RING_SIZE 4096
+
+/* Compact copy of an uiohook event. The hook thread only queues
+ * these, they're applied to the input data once per frame
+ */
+struct raw_event
+{
+    uint64_t time;      /* Capture time in ns (os_gettime_ns) */
+    uint16_t type;      /* uiohook event_type */
+    uint16_t code;      /* Keycode, mouse button or typed character */
+    int16_t x, y;       /* Mouse position */
+    uint16_t amount;    /* Scroll amount */
+    int16_t rotation;   /* Scroll rotation */
+};
+
 namespace hook
 {
     extern element_data_holder* input_data;
+    extern spsc_ring<raw_event, EVENT_RING_SIZE> event_ring;
 
-    extern uint64_t last_wheel;
     extern wint_t last_character;
     extern int16_t mouse_x, mouse_y, mouse_x_smooth, mouse_y_smooth, mouse_last_x, mouse_last_y;
     extern bool hook_initialized;
     extern bool data_initialized;
-    extern std::mutex mutex;
+    /* Guards changes to input_data (event ring drain and gamepad thread) */
+    extern profiled_mutex mutex;
+
+    /* Motion events that were folded into a newer one before being
+     * applied, button transitions are never folded */
+    extern std::atomic<uint64_t> folded_moves;
+    extern std::atomic<uint64_t> folded_axes;
 
 #ifdef _WIN32
     DWORD WINAPI hook_thread_proc(LPVOID arg);
@@ -44,11 +68,21 @@ namespace hook
 
     void init_data_holder();
 
+    /* Frees input_data, which is used by every input backend. Call this
+     * after all of them stopped, end_hook() only cleans up uiohook */
+    void end_data_holder();
+
     void start_hook();
 
     void end_hook();
 
     int hook_enable();
 
-    void process_event(uiohook_event* event);
+    /* Applies all queued events to input_data and publishes
+     * the result, caller has to hold the mutex */
+    void drain_events();
+
+    /* Applies one event to data, which is input_data for live
+     * input or the holder of a replay */
+    void process_event(const raw_event &event, element_data_holder* data);
 };
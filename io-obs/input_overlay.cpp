@@ -15,12 +15,22 @@
 #include "util/config.hpp"
 #include "sources/input_source.hpp"
 #include "sources/input_history.hpp"
+#include "sources/replay_source.hpp"
 #include "hook/hook_helper.hpp"
 #include "hook/gamepad_hook.hpp"
 #include "gui/io_settings_dialog.hpp"
 #include "network/remote_connection.hpp"
+#include "util/frame_scheduler.hpp"
+#include "util/recording/recorder.hpp"
+#include "util/recording/replay.hpp"
+#include "util/latency_stats.hpp"
+#include "util/trace.hpp"
+#include "util/profiled_mutex.hpp"
+#include "util/layout_cache.hpp"
+#include "util/file_watcher.hpp"
 
 #ifdef LINUX
+#include "hook/evdev_hook.hpp"
 
 extern void cleanupDisplay();
 
@@ -36,13 +46,22 @@ bool obs_module_load()
     io_config::load(cfg);
 
     if (io_config::history) sources::register_history();
-    if (io_config::overlay) sources::register_overlay_source();
+    if (io_config::overlay) {
+        sources::register_overlay_source();
+        sources::register_replay_source();
+    }
 
     if (io_config::uiohook || io_config::gamepad)
         hook::init_data_holder();
 
-    if (io_config::uiohook)
-        hook::start_hook();
+    if (io_config::uiohook) {
+#ifdef LINUX
+        if (io_config::evdev)
+            evdev::start_evdev_hook();
+        else
+#endif
+            hook::start_hook();
+    }
 
     if (io_config::gamepad)
         gamepad::start_pad_hook();
@@ -52,6 +71,9 @@ bool obs_module_load()
         network::start_network(io_config::port);
     }
 
+    /* Queued input is applied and snapshotted once per frame */
+    obs_add_tick_callback(frame_scheduler::tick_proc, nullptr);
+
     /* Input filtering via focused window title */
     if (io_config::control)
         io_config::io_window_filters.read_from_config(cfg);
@@ -78,12 +100,30 @@ void obs_module_unload()
     auto cfg = obs_frontend_get_global_config();
     io_config::save(cfg);
 
+    recorder::stop();
+    replay::stop();
+    layout_loader::stop();
+    file_watcher::stop();
+    latency_stats::log();
+    lock_stats::log();
+    trace::stop();
+
     if (gamepad::gamepad_hook_state)
         gamepad::end_pad_hook();
 
+#ifdef LINUX
+    if (evdev::evdev_hook_state)
+        evdev::end_evdev_hook();
+#endif
+
+    obs_remove_tick_callback(frame_scheduler::tick_proc, nullptr);
+
     if (hook::hook_initialized)
         hook::end_hook();
 
+    if (hook::data_initialized)
+        hook::end_data_holder();
+
 #ifdef LINUX
     cleanupDisplay();
 #endif
@@ -15,11 +15,13 @@
 #include "hook/xinput_fix.hpp"
 #include "util/util.hpp"
 #include "util/config.hpp"
+#include "util/latency_stats.hpp"
+#include <util/platform.h>
 #include <uiohook.h>
 
 namespace network
 {
-    io_client::io_client(char* name, tcp_socket socket, uint8_t id)
+    io_client::io_client(char* name, tcp_socket socket, uint8_t id) : m_holder(static_cast<uint8_t>(id + 1))
     {
         m_name = name;
         m_socket = socket;
@@ -72,17 +74,17 @@ namespace network
                         flag = false;
                         break;
                     }
-                    m_holder.add_data(vc, new element_data_button(STATE_PRESSED));
+                    m_holder.add_data(vc, element_data_button(STATE_PRESSED));
 
                     switch (vc) {
                         case VC_MOUSE_BUTTON1:
-                            m_holder.add_data(VC_MOUSE_DATA, new element_data_mouse_stats(stat_lmb));
+                            m_holder.add_data(VC_MOUSE_DATA, element_data_mouse_stats(stat_lmb));
                             break;
                         case VC_MOUSE_BUTTON2:
-                            m_holder.add_data(VC_MOUSE_DATA, new element_data_mouse_stats(stat_rmb));
+                            m_holder.add_data(VC_MOUSE_DATA, element_data_mouse_stats(stat_rmb));
                             break;
                         case VC_MOUSE_BUTTON3:
-                            m_holder.add_data(VC_MOUSE_DATA, new element_data_mouse_stats(stat_mmb));
+                            m_holder.add_data(VC_MOUSE_DATA, element_data_mouse_stats(stat_mmb));
                             break;
                         default:;
                     }
@@ -101,10 +103,10 @@ namespace network
                 if (dir >= WHEEL_DIR_UP && dir <= WHEEL_DIR_DOWN)
                     direction = wheel_direction(dir);
 
-                m_holder.add_data(VC_MOUSE_DATA, new element_data_mouse_stats(x, y));
-                m_holder.add_data(VC_MOUSE_DATA, new element_data_mouse_stats(amount, direction, false));
+                m_holder.add_data(VC_MOUSE_DATA, element_data_mouse_stats(x, y));
+                m_holder.add_data(VC_MOUSE_DATA, element_data_mouse_stats(amount, direction, false));
                 m_holder.add_data(VC_MOUSE_WHEEL,
-                                  new element_data_wheel(direction, pressed ? STATE_PRESSED : STATE_RELEASED));
+                                  element_data_wheel(direction, pressed ? STATE_PRESSED : STATE_RELEASED));
             }
         } else if (msg == MSG_GAMEPAD_DATA) {
             uint8_t pad_id = 0;/*, trigger_l = 0, trigger_r = 0;
@@ -116,22 +118,50 @@ namespace network
             if (flag) {
                 /* Add all buttons to the holder*/
                 for (auto &btn : xinput_fix::all_codes) {
-                    m_holder.add_gamepad_data(pad_id, xinput_fix::to_vc(btn), new element_data_button(
+                    m_holder.add_gamepad_data(pad_id, xinput_fix::to_vc(btn), element_data_button(
                             (pad_buttons & btn) > 0 ? STATE_PRESSED : STATE_RELEASED));
                 }
 
                 /* Analog sticks are sent before triggers */
-                auto temp = element_data_analog_stick::from_buffer(buffer);
-                if (temp)
-                    temp->set_state((pad_buttons & xinput_fix::CODE_LEFT_THUMB) > 0 ? STATE_PRESSED : STATE_RELEASED,
+                element_data_analog_stick stick;
+                if (element_data_analog_stick::from_buffer(buffer, stick)) {
+                    stick.set_state((pad_buttons & xinput_fix::CODE_LEFT_THUMB) > 0 ? STATE_PRESSED : STATE_RELEASED,
                                     (pad_buttons & xinput_fix::CODE_RIGHT_THUMB) > 0 ? STATE_PRESSED : STATE_RELEASED);
-                m_holder.add_gamepad_data(pad_id, VC_STICK_DATA, temp);
-
+                    m_holder.add_gamepad_data(pad_id, VC_STICK_DATA, stick);
+                }
 
-                m_holder.add_gamepad_data(pad_id, VC_TRIGGER_DATA, element_data_trigger::from_buffer(buffer));
+                element_data_trigger trigger;
+                if (element_data_trigger::from_buffer(buffer, trigger))
+                    m_holder.add_gamepad_data(pad_id, VC_TRIGGER_DATA, trigger);
             } else {
                 DEBUG_LOG(LOG_ERROR, "Couldn't read gamepad id from buffer");
             }
+        } else if (msg == MSG_TIME_DATA) {
+            uint32_t sent_high = 0, sent_low = 0, age = 0;
+
+            flag = netlib_read_uint32(buffer, &sent_high) && netlib_read_uint32(buffer, &sent_low) &&
+                   netlib_read_uint32(buffer, &age);
+            if (flag) {
+                const auto now = os_gettime_ns();
+                const auto sent = static_cast<uint64_t>(sent_high) << 32 | sent_low;
+
+                /* The clocks of client and server aren't related, the smallest
+                 * difference seen so far is used as offset. Delays are then
+                 * relative to the fastest transmission, so on a local network
+                 * this mostly shows how long input waited for MSG_REFRESH */
+                const auto offset = static_cast<int64_t>(now - sent);
+                if (!m_has_clock_offset || offset < m_clock_offset) {
+                    m_clock_offset = offset;
+                    m_has_clock_offset = true;
+                }
+
+                if (age != TIME_DATA_NO_INPUT) {
+                    const auto capture = sent + m_clock_offset - age * 1000ull;
+                    m_holder.set_event_time(capture);
+                    latency_stats::record(latency_stats::ORIGIN_REMOTE, latency_stats::STAGE_CAPTURE_INGEST, capture,
+                                          now);
+                }
+            }
         }
 
         if (!flag)
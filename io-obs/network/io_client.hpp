@@ -36,6 +36,9 @@ namespace network
 
     private:
         element_data_holder m_holder;
+        /* Difference between server and client clock (os_gettime_ns) */
+        int64_t m_clock_offset = 0;
+        bool m_has_clock_offset = false;
         tcp_socket m_socket;
         uint8_t m_id;
         /* Set to false if this client should be disconnected on next roundtrip */
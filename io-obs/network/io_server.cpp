@@ -9,6 +9,8 @@
 #include "remote_connection.hpp"
 #include "util/util.hpp"
 #include "util/config.hpp"
+#include "util/recording/recorder.hpp"
+#include "util/trace.hpp"
 #include <obs-module.h>
 #include <util/platform.h>
 #include <algorithm>
@@ -17,7 +19,7 @@ static netlib_socket_set sockets = nullptr;
 
 namespace network
 {
-    std::mutex mutex;
+    profiled_mutex mutex("network::mutex");
 
     io_server::io_server(const uint16_t port) : m_server(nullptr)
     {
@@ -72,10 +74,13 @@ namespace network
         return m_server;
     }
 
+    /* The client list is only changed on the network thread itself,
+     * so reading it here doesn't need the mutex. Client data is handed
+     * to the renderer through snapshots
+     */
     void io_server::update_clients()
     {
-        mutex.lock();
-
+        TRACE_SCOPE("io_server::update_clients");
         for (const auto &client : m_clients) {
             if (netlib_socket_ready(client->socket())) {
                 /* Receive input data */
@@ -96,9 +101,14 @@ namespace network
                         case MSG_MOUSE_DATA:
                         case MSG_BUTTON_DATA:
                         case MSG_GAMEPAD_DATA:
+                        case MSG_TIME_DATA:
                             if (!client->read_event(m_buffer, msg))
                                 DEBUG_LOG(LOG_ERROR, "Failed to receive event data from %s.", client->name());
                             break;
+                        case MSG_TIME_SUPPORTED:
+                            if (!send_message(client->socket(), MSG_TIME_SUPPORTED))
+                                client->mark_invalid();
+                            break;
                         case MSG_CLIENT_DC:
                             client->mark_invalid();
                             break;
@@ -108,9 +118,14 @@ namespace network
                             break;
                     }
                 }
+                const auto data = client->get_data();
+                data->publish();
+
+                /* Taken here, so it has exactly the changes recorded so far */
+                if (recorder::active() && recorder::keyframe_due(data->get_source()))
+                    recorder::record_keyframe(data->get_source(), *data);
             }
         }
-        mutex.unlock();
     }
 
     void io_server::get_clients(std::vector<const char*> &v)
@@ -148,7 +163,7 @@ namespace network
 
     void io_server::roundtrip()
     {
-        mutex.lock();
+        PROFILED_LOCK_MANUAL(mutex);
 
         if (!m_clients.empty()) {
             const auto old = server_instance->m_num_clients;
@@ -186,7 +201,7 @@ namespace network
 
     void io_server::add_client(tcp_socket socket, char* name)
     {
-        std::lock_guard<std::mutex> lock(mutex);
+        PROFILED_LOCK(lock, mutex);
 
         fix_name(name);
 
@@ -12,19 +12,20 @@
 #include <vector>
 #include <memory>
 #include <obs-module.h>
-#include <mutex>
+#include "util/profiled_mutex.hpp"
 
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 
-#define BUFFER_SIZE 90
+#define BUFFER_SIZE 131 /* Largest buffer io-client sends */
 #define LISTEN_TIMEOUT 25
 enum message;
 
 namespace network
 {
-    extern std::mutex mutex;
+    /* Guards the client list against readers on other threads */
+    extern profiled_mutex mutex;
 
     class io_server
     {
@@ -58,6 +59,11 @@ namespace network
 
         io_client* get_client(uint8_t id);
 
+        size_t client_count() const
+        {
+            return m_clients.size();
+        }
+
     private:
         bool unique_name(char* name);
 
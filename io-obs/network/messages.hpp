@@ -19,5 +19,11 @@ enum message
     MSG_CLIENT_DC,
     MSG_REFRESH,
     MSG_END_BUFFER,
+    MSG_TIME_DATA,  /* Client send time and age of the oldest input in this buffer */
+    MSG_TIME_SUPPORTED, /* Sent by the client after its name, the server answers with the same
+                         * message if it reads MSG_TIME_DATA. Servers which don't know it skip it */
     MSG_LAST
 };
+
+/* Age in MSG_TIME_DATA if the buffer has no new input */
+#define TIME_DATA_NO_INPUT 0xFFFFFFFFu
@@ -8,6 +8,7 @@
 #include "io_server.hpp"
 #include "util/config.hpp"
 #include "util/util.hpp"
+#include "util/trace.hpp"
 #include "remote_connection.hpp"
 #include "util/config.hpp"
 #include <obs-module.h>
@@ -101,6 +102,7 @@ namespace network
 #endif
     {
         tcp_socket sock;
+        trace::set_thread_name("network");
 
         while (network_flag) {
             int numready;
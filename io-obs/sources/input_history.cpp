@@ -13,13 +13,17 @@
 #include "util/history/input_queue.hpp"
 #include "util/config-file.h"
 #include "network/io_server.hpp"
+#include "util/frame_scheduler.hpp"
 #include <iomanip>
 #include <obs-frontend-api.h>
+#include <util/platform.h>
 #include <util/config.hpp>
 
 namespace sources
 {
     input_history_source::input_history_source(obs_source_t* source_, obs_data_t* settings)
+            : m_clear_timer([](void* data)
+                            { static_cast<input_history_source*>(data)->clear_history(); }, this)
     {
         m_settings.source = source_;
         m_settings.settings = settings;
@@ -29,6 +33,10 @@ namespace sources
 
     input_history_source::~input_history_source()
     {
+        {
+            PROFILED_LOCK(lock, hook::mutex);
+            frame_scheduler::timers.cancel(m_clear_timer);
+        }
         delete m_settings.queue;
     }
 
@@ -41,17 +49,15 @@ namespace sources
     inline void input_history_source::update(obs_data_t* settings)
     {
         /* Get the input source */
-        if (hook::data_initialized || network::network_flag) {
-            uint8_t source_id = obs_data_get_int(settings, S_INPUT_SOURCE);
-            if (source_id > 0)
-                m_settings.data = network::server_instance->get_client(source_id)->get_data();
-            else
-                m_settings.data = hook::input_data;
-        }
+        m_settings.selected_source = obs_data_get_int(settings, S_INPUT_SOURCE);
 
         SET_FLAG(FLAG_INCLUDE_MOUSE, obs_data_get_bool(settings, S_HISTORY_INCLUDE_MOUSE));
         SET_FLAG(FLAG_REPEAT_KEYS, obs_data_get_bool(settings, S_HISTORY_ENABLE_REPEAT_KEYS));
         SET_FLAG(FLAG_AUTO_CLEAR, obs_data_get_bool(settings, S_HISTORY_ENABLE_AUTO_CLEAR));
+        if (!GET_FLAG(FLAG_AUTO_CLEAR)) {
+            PROFILED_LOCK(lock, hook::mutex);
+            frame_scheduler::timers.cancel(m_clear_timer);
+        }
         SET_FLAG(FLAG_FIX_CUTTING, obs_data_get_bool(settings, S_HISTORY_FIX_CUTTING));
         SET_FLAG(FLAG_USE_FALLBACK, obs_data_get_bool(settings, S_HISTORY_USE_FALLBACK_NAME));
         SET_FLAG(FLAG_INCLUDE_PAD, obs_data_get_bool(settings, S_HISTORY_INCLUDE_PAD));
@@ -90,20 +96,16 @@ namespace sources
 
         m_settings.queue->tick(seconds);
 
-        if (GET_FLAG(FLAG_AUTO_CLEAR)) {
-            m_clear_timer += seconds;
-            if (m_settings.auto_clear_interval <= m_clear_timer) {
-                m_clear_timer = 0.f;
-                clear_history();
-            }
-        }
-
         m_collect_timer += seconds;
         if (m_collect_timer >= m_settings.update_interval) {
             m_collect_timer = 0.f;
-            m_clear_timer = 0.f;
-            /* Moves current input entry from collection into list */
-            m_settings.queue->swap();
+            /* Moves current input entry from collection into list,
+             * the history is cleared once no new entry came in for a while */
+            if (m_settings.queue->swap() && GET_FLAG(FLAG_AUTO_CLEAR)) {
+                const auto deadline = os_gettime_ns() + static_cast<uint64_t>(m_settings.auto_clear_interval * 1e9);
+                PROFILED_LOCK(lock, hook::mutex);
+                frame_scheduler::timers.schedule(m_clear_timer, deadline);
+            }
         } else {
             m_settings.queue->collect_input();
         }
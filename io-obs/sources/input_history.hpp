@@ -11,6 +11,7 @@
 #include "../util/layout_constants.hpp"
 #include "../hook/gamepad_hook.hpp"
 #include "../hook/hook_helper.hpp"
+#include "../util/util.hpp"
 #include <obs-module.h>
 
 class input_queue;
@@ -56,7 +57,7 @@ namespace sources
         const char* icon_cfg_path = nullptr;    /* Path to icon config file */
 
         /* General values */
-        element_data_holder* data = nullptr;    /* Points to selected input source */
+        uint8_t selected_source = 0;            /* 0 = Local input */
         obs_source_t* source = nullptr;         /* input-history source */
         obs_data_t* settings = nullptr;         /* input-history settings (includes text source settings) */
         uint16_t flags = 0x0;                   /* Contains all settings flags */
@@ -66,7 +67,7 @@ namespace sources
 
     class input_history_source
     {
-        double m_clear_timer = 0.f;
+        deadline_timer m_clear_timer;   /* Armed after every new entry while auto clear is on */
         double m_collect_timer = 0.f;
     public:
         history_settings m_settings;
@@ -10,8 +10,10 @@
 #include "../hook/gamepad_hook.hpp"
 #include "../util/element/element_data_holder.hpp"
 #include "../util/util.hpp"
-#include "../../ccl/ccl.hpp"
 #include "util/layout_constants.hpp"
+#include "util/layout_format.hpp"
+#include "util/layout_cache.hpp"
+#include "util/frame_scheduler.hpp"
 #include "util/config-file.h"
 #include "network/remote_connection.hpp"
 #include "network/io_server.hpp"
@@ -29,7 +31,7 @@ namespace sources
         if (m_settings.layout_file != config) /* Only reload config file if path changed */
         {
             m_settings.layout_file = config;
-            m_overlay->load();
+            m_overlay->load_async();
         }
 
         m_settings.gamepad = obs_data_get_int(settings, S_CONTROLLER_ID);
@@ -44,11 +46,13 @@ namespace sources
             m_settings.monitor_w = obs_data_get_int(settings, S_MONITOR_V_CENTER);
             m_settings.mouse_deadzone = obs_data_get_int(settings, S_MOUSE_DEAD_ZONE);
         }
+        m_overlay->invalidate();
     }
 
     inline void input_source::tick(float seconds)
     {
         UNUSED_PARAMETER(seconds);
+        m_overlay->swap_loaded();
         if (m_overlay->is_loaded()) {
             m_overlay->refresh_data();
         }
@@ -64,6 +68,7 @@ namespace sources
             gs_draw_sprite(m_overlay->get_texture()->texture, 0, cx, cy);
         } else {
             m_overlay->draw(effect);
+            frame_scheduler::source_rendered(m_settings.selected_source);
         }
     }
 
@@ -71,9 +76,9 @@ namespace sources
     {
         UNUSED_PARAMETER(p);
         const std::string cfg = obs_data_get_string(s, S_LAYOUT_FILE);
-        auto temp = ccl_config(cfg, "");
-
-        const auto flags = temp.get_int(CFG_FLAGS, true);
+        /* Shared with the source once it loads the same file */
+        const auto config = cfg.empty() ? nullptr : layout_cache::get_layout(cfg);
+        const auto flags = config ? config->flags : 0;
 
         obs_property_set_visible(GET_PROPS(S_CONTROLLER_L_DEAD_ZONE), flags & FLAG_LEFT_STICK);
         obs_property_set_visible(GET_PROPS(S_CONTROLLER_R_DEAD_ZONE), flags & FLAG_RIGHT_STICK);
@@ -137,7 +142,7 @@ namespace sources
         }
 
         auto filter_img = util_file_filter(T_FILTER_IMAGE_FILES, "*.jpg *.png *.bmp");
-        auto filter_text = util_file_filter(T_FILTER_TEXT_FILES, "*.ini");
+        auto filter_text = util_file_filter(T_FILTER_LAYOUTS, "*.ini *" IOLAYOUT_EXTENSION);
 
         /* Config and texture file path */
         obs_properties_add_path(props, S_OVERLAY_FILE, T_TEXTURE_FILE, OBS_PATH_FILE, filter_img.c_str(),
@@ -0,0 +1,170 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "replay_source.hpp"
+#include "../util/util.hpp"
+#include "../util/layout_format.hpp"
+
+namespace sources
+{
+    inline void replay_source::update(obs_data_t* settings)
+    {
+        const auto config = obs_data_get_string(settings, S_LAYOUT_FILE);
+        m_settings.image_file = obs_data_get_string(settings, S_OVERLAY_FILE);
+
+        if (m_settings.layout_file != config) /* Only reload config file if path changed */
+        {
+            m_settings.layout_file = config;
+            m_overlay->load_async();
+        }
+
+        m_settings.gamepad = obs_data_get_int(settings, S_CONTROLLER_ID);
+        m_settings.mouse_sens = obs_data_get_int(settings, S_MOUSE_SENS);
+        m_overlay->invalidate();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const std::string file = obs_data_get_string(settings, S_REPLAY_FILE);
+        if (m_replay_file != file) {
+            m_replay_file = file;
+            if (file.empty())
+                m_replay.close();
+            else
+                m_replay.open(file.c_str());
+            m_position = -1.0;
+        }
+
+        const auto recorded_source = static_cast<uint8_t>(obs_data_get_int(settings, S_REPLAY_SOURCE));
+        if (m_recorded_source != recorded_source) {
+            m_recorded_source = recorded_source;
+            m_position = -1.0;
+        }
+
+        m_replay.set_source(m_recorded_source);
+        m_replay.set_speed(static_cast<float>(obs_data_get_double(settings, S_REPLAY_SPEED)));
+        m_loop = obs_data_get_bool(settings, S_REPLAY_LOOP);
+
+        /* Only seek if the position was moved, other changes keep playing */
+        const auto position = obs_data_get_double(settings, S_REPLAY_POSITION);
+        if (position != m_position) {
+            m_position = position;
+            seek(position);
+        }
+    }
+
+    inline void replay_source::tick(const float seconds)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_replay.is_open()) {
+            m_replay.tick(seconds, &m_holder);
+            if (m_replay.finished() && m_loop)
+                seek(0.0);
+        }
+
+        m_overlay->swap_loaded();
+        if (m_overlay->is_loaded()) {
+            if (m_reset) {
+                m_overlay->reset_data();
+                m_reset = false;
+            }
+            m_overlay->refresh_data(&m_holder);
+        }
+    }
+
+    inline void replay_source::render(gs_effect_t* effect) const
+    {
+        if (!m_overlay->get_texture() || !m_overlay->get_texture()->texture)
+            return;
+
+        if (m_settings.layout_file.empty() || !m_overlay->is_loaded()) {
+            gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), m_overlay->get_texture()->texture);
+            gs_draw_sprite(m_overlay->get_texture()->texture, 0, m_settings.cx, m_settings.cy);
+        } else {
+            m_overlay->draw(effect);
+        }
+    }
+
+    void replay_source::seek(const double position)
+    {
+        const auto clamped = position < 0.0 ? 0.0 : (position > 100.0 ? 100.0 : position);
+        m_replay.seek(static_cast<uint64_t>(m_replay.duration() * (clamped / 100.0)), &m_holder);
+        m_reset = true;
+    }
+
+    obs_properties_t* get_properties_for_replay(void* data)
+    {
+        UNUSED_PARAMETER(data);
+        const auto props = obs_properties_create();
+
+        auto filter_log = util_file_filter(T_FILTER_INPUT_LOGS, "*.iolog");
+        auto filter_img = util_file_filter(T_FILTER_IMAGE_FILES, "*.jpg *.png *.bmp");
+        auto filter_text = util_file_filter(T_FILTER_LAYOUTS, "*.ini *" IOLAYOUT_EXTENSION);
+
+        obs_properties_add_path(props, S_REPLAY_FILE, T_REPLAY_FILE, OBS_PATH_FILE, filter_log.c_str(), "");
+        obs_properties_add_path(props, S_OVERLAY_FILE, T_TEXTURE_FILE, OBS_PATH_FILE, filter_img.c_str(), "");
+        obs_properties_add_path(props, S_LAYOUT_FILE, T_LAYOUT_FILE, OBS_PATH_FILE, filter_text.c_str(), "");
+
+        obs_properties_add_int(props, S_REPLAY_SOURCE, T_REPLAY_SOURCE, 0, 0xFE, 1);
+        obs_properties_add_float_slider(props, S_REPLAY_SPEED, T_REPLAY_SPEED, 0.1, 10.0, 0.1);
+        obs_properties_add_bool(props, S_REPLAY_LOOP, T_REPLAY_LOOP);
+        obs_properties_add_float_slider(props, S_REPLAY_POSITION, T_REPLAY_POSITION, 0.0, 100.0, 0.1);
+
+        obs_properties_add_int(props, S_CONTROLLER_ID, T_CONTROLLER_ID, 0, 3, 1);
+        obs_properties_add_int_slider(props, S_MOUSE_SENS, T_MOUSE_SENS, 1, 500, 1);
+        return props;
+    }
+
+    void register_replay_source()
+    {
+        /* Input Replay */
+        obs_source_info si = {};
+        si.id = "input-replay";
+        si.type = OBS_SOURCE_TYPE_INPUT;
+        si.output_flags = OBS_SOURCE_VIDEO;
+        si.get_properties = get_properties_for_replay;
+
+        si.get_name = [](void*)
+        { return obs_module_text("InputReplay"); };
+        si.create = [](obs_data_t* settings, obs_source_t* source)
+        {
+            return (void*) new replay_source(source, settings);
+        };
+        si.destroy = [](void* data)
+        {
+            delete reinterpret_cast<replay_source*>(data);
+        };
+        si.get_width = [](void* data)
+        {
+            return reinterpret_cast<replay_source*>(data)->m_settings.cx;
+        };
+        si.get_height = [](void* data)
+        {
+            return reinterpret_cast<replay_source*>(data)->m_settings.cy;
+        };
+
+        si.get_defaults = [](obs_data_t* settings)
+        {
+            obs_data_set_default_double(settings, S_REPLAY_SPEED, 1.0);
+            obs_data_set_default_bool(settings, S_REPLAY_LOOP, true);
+            obs_data_set_default_int(settings, S_MOUSE_SENS, 50);
+        };
+
+        si.update = [](void* data, obs_data_t* settings)
+        {
+            reinterpret_cast<replay_source*>(data)->update(settings);
+        };
+        si.video_tick = [](void* data, float seconds)
+        {
+            reinterpret_cast<replay_source*>(data)->tick(seconds);
+        };
+        si.video_render = [](void* data, gs_effect_t* effect)
+        {
+            reinterpret_cast<replay_source*>(data)->render(effect);
+        };
+        obs_register_source(&si);
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include "input_source.hpp"
+#include "../util/element/element_data_holder.hpp"
+#include "../util/recording/replay.hpp"
+#include <mutex>
+
+namespace sources
+{
+    /* Plays an input recording through an overlay layout instead
+     * of showing live input. The position can be changed at any
+     * time, seeking goes through the keyframe index of the log
+     */
+    class replay_source
+    {
+    public:
+        obs_source_t* m_source = nullptr;
+
+        std::unique_ptr<overlay> m_overlay{};
+        overlay_settings m_settings;
+
+        replay_source(obs_source_t* source, obs_data_t* settings) : m_source(source)
+        {
+            m_overlay = std::make_unique<overlay>(&m_settings);
+            m_settings.data = settings;
+            obs_source_update(m_source, settings);
+        }
+
+        ~replay_source() = default;
+
+        inline void update(obs_data_t* settings);
+
+        inline void tick(float seconds);
+
+        inline void render(gs_effect_t* effect) const;
+
+    private:
+        /* Position in % of the recording, caller has to hold the mutex */
+        void seek(double position);
+
+        input_replay m_replay;
+        element_data_holder m_holder{LOG_SOURCE_NONE};  /* Replayed input, never recorded */
+        std::string m_replay_file;
+        double m_position = -1.0;       /* Last position set in the properties */
+        uint8_t m_recorded_source = 0;
+        bool m_loop = false;
+        bool m_reset = false;           /* Overlay has to drop its data after a seek */
+        std::mutex m_mutex;             /* update() runs on the UI thread, tick() on the graphics thread */
+    };
+
+    static obs_properties_t* get_properties_for_replay(void* data);
+
+    void register_replay_source();
+}
@@ -19,6 +19,7 @@ namespace io_config
     bool remote = false;
     bool gamepad = true;
     bool uiohook = true;
+    bool evdev = false;
     bool overlay = true;
     bool history = true;
     bool regex = false;
@@ -31,6 +32,7 @@ namespace io_config
     {
         config_set_default_bool(cfg, S_REGION, S_UIOHOOK, io_config::uiohook);
         config_set_default_bool(cfg, S_REGION, S_GAMEPAD, io_config::gamepad);
+        config_set_default_bool(cfg, S_REGION, S_EVDEV, io_config::evdev);
         config_set_default_bool(cfg, S_REGION, S_OVERLAY, io_config::overlay);
         config_set_default_bool(cfg, S_REGION, S_HISTORY, io_config::history);
 
@@ -51,6 +53,7 @@ namespace io_config
     {
         io_config::uiohook = config_get_bool(cfg, S_REGION, S_UIOHOOK);
         io_config::gamepad = config_get_bool(cfg, S_REGION, S_GAMEPAD);
+        io_config::evdev = config_get_bool(cfg, S_REGION, S_EVDEV);
         io_config::remote = config_get_bool(cfg, S_REGION, S_REMOTE);
         io_config::control = config_get_bool(cfg, S_REGION, S_CONTROL);
         io_config::filter_mode = config_get_int(cfg, S_REGION, S_FILTER_MODE);
@@ -65,6 +68,7 @@ namespace io_config
         /* Window filters are directly saved in formAccept */
         config_set_bool(cfg, S_REGION, S_UIOHOOK, io_config::uiohook);
         config_set_bool(cfg, S_REGION, S_GAMEPAD, io_config::gamepad);
+        config_set_bool(cfg, S_REGION, S_EVDEV, io_config::evdev);
         config_set_bool(cfg, S_REGION, S_REMOTE, io_config::remote);
         config_set_bool(cfg, S_REGION, S_CONTROL, io_config::control);
         config_set_bool(cfg, S_REGION, S_HISTORY, io_config::history);
@@ -21,6 +21,7 @@ namespace io_config
     extern bool remote;
     extern bool gamepad;
     extern bool uiohook;
+    extern bool evdev;     /* Read keyboard, mouse and gamepads from evdev instead of uiohook & js (linux only) */
     extern bool overlay;
     extern bool history;
     extern bool regex;
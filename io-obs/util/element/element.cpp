@@ -6,18 +6,6 @@
  */
 
 #include "element.hpp"
-#include "../../../ccl/ccl.hpp"
-#include "util/layout_constants.hpp"
-
-element_data::element_data(const element_type type)
-{
-    m_type = type;
-}
-
-element_type element_data::get_type() const
-{
-    return m_type;
-}
 
 element::element() : m_keycode(0)
 {
@@ -43,19 +31,3 @@ data_source element::get_source()
 {
     return NONE;
 }
-
-void element::read_mapping(ccl_config* cfg, const std::string &id)
-{
-    const auto r = cfg->get_rect(id + CFG_MAPPING);
-    m_mapping.x = r.x;
-    m_mapping.y = r.y;
-    m_mapping.cx = r.w;
-    m_mapping.cy = r.h;
-}
-
-void element::read_pos(ccl_config* cfg, const std::string &id)
-{
-    const auto p = cfg->get_point(id + CFG_POS);
-    m_pos.x = p.x;
-    m_pos.y = p.y;
-}
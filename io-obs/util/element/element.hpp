@@ -7,6 +7,7 @@
 #pragma once
 
 #include <string>
+#include "element_data.hpp"
 #include "graphics/vec2.h"
 #include "graphics/graphics.h"
 
@@ -26,37 +27,15 @@ namespace sources
     class overlay_settings;
 }
 
-class ccl_config;
+struct iolayout_element;
 
-#ifdef _WIN32
-enum element_type;
-#else
+class sprite_batch;
 
-#include "../layout_constants.hpp"
-
-#endif
-
-class element_data
+/* Values an element remembers between frames. Elements are shared by
+ * all overlays using the same layout, so each overlay keeps these */
+struct element_state
 {
-public:
-    explicit element_data(element_type type);
-    virtual ~element_data() = default;
-
-    element_type get_type() const;
-
-    /* true if data should not me removed */
-    virtual bool is_persistent()
-    { return false; }
-
-    /* used if is persistent */
-    virtual void merge(element_data* other)
-    {
-        UNUSED_PARAMETER(other);
-        /* NO-OP */
-    }
-
-protected:
-    element_type m_type;
+    float angle = 0.f;  /* Last mouse arrow angle outside of the dead zone */
 };
 
 class element
@@ -68,10 +47,12 @@ public:
 
     element(element_type type);
 
-    virtual void load(ccl_config* cfg, const std::string &id) = 0;
+    /* Elements are loaded from flat records, which either come
+     * from an ini layout or straight from a compiled layout */
+    virtual void load(const iolayout_element &e) = 0;
 
-    virtual void
-    draw(gs_effect_t* effect, gs_image_file_t* m_image, element_data* data, sources::overlay_settings* settings) = 0;
+    virtual void draw(sprite_batch &batch, const element_data* data, sources::overlay_settings* settings,
+                      element_state &state) const = 0;
 
     element_type get_type() const;
 
@@ -80,10 +61,6 @@ public:
     virtual data_source get_source();
 
 protected:
-    void read_mapping(ccl_config* cfg, const std::string &id);
-
-    void read_pos(ccl_config* cfg, const std::string &id);
-
     vec2 m_pos = {};
     gs_rect m_mapping = {};
 
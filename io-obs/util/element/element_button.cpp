@@ -7,42 +7,33 @@
 
 #include "../../sources/input_source.hpp"
 #include "element_button.hpp"
-#include "../../../ccl/ccl.hpp"
+#include "util/layout_format.hpp"
 
-void element_data_button::merge(element_data* other)
+void element_button::load(const iolayout_element &e)
 {
-    if (other && other->get_type() == BUTTON) {
-        const auto other_btn = dynamic_cast<element_data_button*>(other);
-        if (other_btn) {
-            m_state = other_btn->m_state;
-        }
-    }
-}
-
-void element_button::load(ccl_config* cfg, const std::string &id)
-{
-    element_texture::load(cfg, id);
-    m_keycode = cfg->get_int(id + CFG_KEY_CODE);
+    element_texture::load(e);
+    m_keycode = e.keycode;
     m_pressed = m_mapping;
     m_pressed.y = m_mapping.y + m_mapping.cy + CFG_INNER_BORDER;
     /* Checks whether first 8 bits are equal */
     is_gamepad = (m_keycode >> 8) == (VC_PAD_MASK >> 8);
 }
 
-void element_button::draw(gs_effect_t* effect, gs_image_file_t* image, element_data* data,
-                          sources::overlay_settings* settings)
+void element_button::draw(sprite_batch &batch, const element_data* data, sources::overlay_settings* settings,
+                          element_state &state) const
 {
     UNUSED_PARAMETER(settings);
+    UNUSED_PARAMETER(state);
     if (data) {
-        const auto button = dynamic_cast<element_data_button*>(data);
+        const auto button = data->get_button();
         if (button) {
             if (button->get_state() == STATE_PRESSED) {
-                element_texture::draw(effect, image, &m_pressed);
+                element_texture::draw(batch, &m_pressed);
             } else {
-                element_texture::draw(effect, image, nullptr);
+                element_texture::draw(batch, nullptr);
             }
         }
     } else {
-        element_texture::draw(effect, image, nullptr);
+        element_texture::draw(batch, nullptr);
     }
 }
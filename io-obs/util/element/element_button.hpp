@@ -11,25 +11,6 @@
 #include "element_texture.hpp"
 #include <netlib.h>
 
-class element_data_button : public element_data
-{
-public:
-    element_data_button(const button_state state) : element_data(BUTTON)
-    {
-        m_state = state;
-    }
-
-    button_state get_state() const
-    {
-        return m_state;
-    }
-
-    void merge(element_data* other) override;
-
-private:
-    button_state m_state;
-};
-
 class element_button : public element_texture
 {
 public:
@@ -37,14 +18,20 @@ public:
     {
     }
 
-    void load(ccl_config* cfg, const std::string &id) override;
+    void load(const iolayout_element &e) override;
 
-    void
-    draw(gs_effect_t* effect, gs_image_file_t* image, element_data* data, sources::overlay_settings* settings) override;
+    void draw(sprite_batch &batch, const element_data* data, sources::overlay_settings* settings,
+              element_state &state) const override;
 
     data_source get_source() override
     { return is_gamepad ? GAMEPAD : DEFAULT; }
 
+    /* Part of the texture drawn while the button is pressed */
+    const gs_rect &get_pressed_mapping() const
+    {
+        return m_pressed;
+    }
+
 private:
     bool is_gamepad = false;
     gs_rect m_pressed;
@@ -0,0 +1,453 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "element_data.hpp"
+#include "../util.hpp"
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<element_data>::value, "element_data has to stay a plain value");
+
+void element_data::merge(const element_data &other)
+{
+    if (other.m_type != m_type)
+        return;
+
+    switch (m_type) {
+        case BUTTON:
+            m_button.merge(other.m_button);
+            break;
+        case MOUSE_SCROLLWHEEL:
+            m_wheel.merge(other.m_wheel);
+            break;
+        case MOUSE_STATS:
+            m_mouse_stats.merge(other.m_mouse_stats);
+            break;
+        case ANALOG_STICK:
+            m_stick.merge(other.m_stick);
+            break;
+        case TRIGGER:
+            m_trigger.merge(other.m_trigger);
+            break;
+        case DPAD_STICK:
+            m_dpad.merge(other.m_dpad);
+            break;
+        default:;
+    }
+}
+
+/* Button */
+
+void element_data_button::merge(const element_data_button &other)
+{
+    m_state = other.m_state;
+}
+
+/* Mouse wheel */
+
+element_data_wheel::element_data_wheel(const wheel_direction dir, const button_state state) : element_data_wheel(dir)
+{
+    m_data_type = WHEEL_BOTH;
+    m_middle_button = state;
+}
+
+element_data_wheel::element_data_wheel(const wheel_direction dir) : m_middle_button(STATE_RELEASED)
+{
+    m_data_type = WHEEL_STATE;
+    m_dir = dir;
+}
+
+element_data_wheel::element_data_wheel(const button_state state) : m_dir()
+{
+    m_data_type = BUTTON_STATE;
+    m_middle_button = state;
+}
+
+wheel_direction element_data_wheel::get_dir() const
+{
+    return m_dir;
+}
+
+void element_data_wheel::set_dir(const wheel_direction dir)
+{
+    m_dir = dir;
+}
+
+button_state element_data_wheel::get_state() const
+{
+    return m_middle_button;
+}
+
+void element_data_wheel::merge(const element_data_wheel &other)
+{
+    /* After the merge this data contains both the scroll wheel state and the button state */
+    if (m_data_type != other.m_data_type)
+        m_data_type = WHEEL_BOTH;
+
+    switch (other.m_data_type) {
+        case BUTTON_STATE:
+            m_middle_button = other.get_state();
+            break;
+        case WHEEL_STATE:
+            m_dir = other.get_dir();
+            break;
+        case WHEEL_BOTH:
+            m_dir = other.get_dir();
+            m_middle_button = other.get_state();
+        default:;
+    }
+}
+
+wheel_data_type element_data_wheel::get_data_type() const
+{
+    return m_data_type;
+}
+
+/* Mouse stats */
+
+element_data_mouse_stats::element_data_mouse_stats(const int16_t x, const int16_t y)
+{
+    m_type = stat_pos;
+    m_x = x;
+    m_y = y;
+}
+
+element_data_mouse_stats::element_data_mouse_stats(const stat_type type)
+{
+    m_type = type;
+}
+
+element_data_mouse_stats::element_data_mouse_stats(int scroll_amount, const wheel_direction dir, bool unused)
+{
+    UNUSED_PARAMETER(unused);
+    m_type = stat_scroll_amount;
+    m_wheel_current = scroll_amount;
+    m_dir = dir;
+}
+
+void element_data_mouse_stats::merge(const element_data_mouse_stats &other)
+{
+    switch (other.m_type) {
+        case stat_pos:
+            m_last_x = m_x;
+            m_last_y = m_y;
+            m_x = other.m_x;
+            m_y = other.m_y;
+            break;
+        case stat_scroll_amount:
+            if (other.m_wheel_current <= WHEEL_UP)
+                m_wheel_up_total += other.m_wheel_current;
+            else
+                m_wheel_down_total += other.m_wheel_current;
+            m_dir = other.m_dir;
+
+            if ((m_wheel_current < 0) == (other.m_wheel_current < 0))
+                m_wheel_current += other.m_wheel_current;
+            else
+                m_wheel_current = other.m_wheel_current;
+            break;
+        case stat_lmb:
+            m_lmbcount_total++;
+            m_rmbcount_current = 0;
+            m_mmbcount_current = 0;
+            break;
+        case stat_rmb:
+            m_lmbcount_current = 0;
+            m_rmbcount_total++;
+            m_mmbcount_current = 0;
+            break;
+        case stat_mmb:
+            m_lmbcount_current = 0;
+            m_rmbcount_current = 0;
+            m_mmbcount_total++;
+            break;
+        default:;
+    }
+}
+
+uint32_t element_data_mouse_stats::get_mmb_total() const
+{
+    return m_mmbcount_total;
+}
+
+uint32_t element_data_mouse_stats::get_mmb_current() const
+{
+    return m_mmbcount_current;
+}
+
+uint32_t element_data_mouse_stats::get_lmb_total() const
+{
+    return m_lmbcount_total;
+}
+
+uint32_t element_data_mouse_stats::get_lmb_current() const
+{
+    return m_lmbcount_current;
+}
+
+uint32_t element_data_mouse_stats::get_rmb_total() const
+{
+    return m_rmbcount_total;
+}
+
+uint32_t element_data_mouse_stats::get_rmb_current() const
+{
+    return m_rmbcount_current;
+}
+
+int16_t element_data_mouse_stats::get_mouse_x() const
+{
+    return m_x;
+}
+
+int16_t element_data_mouse_stats::get_mouse_y() const
+{
+    return m_y;
+}
+
+int16_t element_data_mouse_stats::get_last_x() const
+{
+    return m_last_x;
+}
+
+int16_t element_data_mouse_stats::get_last_y() const
+{
+    return m_last_y;
+}
+
+int32_t element_data_mouse_stats::get_wheel_current() const
+{
+    return m_wheel_current;
+}
+
+int32_t element_data_mouse_stats::get_wheel_total() const
+{
+    switch (m_dir) {
+        case WHEEL_DIR_DOWN:
+            return m_wheel_down_total;
+        case WHEEL_DIR_UP:
+            return m_wheel_up_total;
+        default:
+            return 0;
+    }
+}
+
+/* Analog stick */
+
+element_data_analog_stick::element_data_analog_stick(const button_state state, const element_side side)
+        : m_left_state(), m_right_state()
+{
+    if (side == SIDE_LEFT) {
+        m_left_state = state;
+        m_data_type = SD_PRESSED_STATE_LEFT;
+    } else {
+        m_right_state = state;
+        m_data_type = SD_PRESSED_STATE_RIGHT;
+    }
+}
+
+element_data_analog_stick::element_data_analog_stick(const float axis_value, const stick_data_type data_type)
+        : m_left_state(), m_right_state()
+{
+    switch (data_type) {
+        case SD_LEFT_X:
+            m_left_stick = {axis_value, -1};
+            break;
+        case SD_LEFT_Y:
+            m_left_stick = {-1, axis_value};
+            break;
+        case SD_RIGHT_X:
+            m_right_stick = {axis_value, -1};
+            break;
+        case SD_RIGHT_Y:
+            m_right_stick = {-1, axis_value};
+            break;
+        default:;
+    }
+    m_data_type = data_type;
+}
+
+element_data_analog_stick::element_data_analog_stick(const button_state left, const button_state right,
+                                                     const float l_x, const float l_y, const float r_x,
+                                                     const float r_y)
+{
+    m_left_stick = {l_x, l_y};
+    m_right_stick = {r_x, r_y};
+    m_left_state = left;
+    m_right_state = right;
+    m_data_type = SD_BOTH;
+}
+
+void element_data_analog_stick::set_state(const button_state left, const button_state right)
+{
+    m_left_state = left;
+    m_right_state = right;
+}
+
+void element_data_analog_stick::merge(const element_data_analog_stick &other)
+{
+    switch (other.m_data_type) {
+        case SD_BOTH:
+            m_left_stick = other.m_left_stick;
+            m_right_stick = other.m_right_stick;
+            m_left_state = other.m_left_state;
+            m_right_state = other.m_right_state;
+            break;
+        case SD_PRESSED_STATE_LEFT:
+            m_left_state = other.m_left_state;
+            if (m_data_type != SD_PRESSED_STATE_LEFT) m_data_type = SD_BOTH;
+            break;
+        case SD_PRESSED_STATE_RIGHT:
+            m_right_state = other.m_right_state;
+            if (m_data_type != SD_PRESSED_STATE_RIGHT) m_data_type = SD_BOTH;
+            break;
+        case SD_LEFT_X:
+            m_left_stick.x = other.m_left_stick.x;
+            if (m_data_type != SD_LEFT_X) m_data_type = SD_BOTH;
+            break;
+        case SD_LEFT_Y:
+            m_left_stick.y = other.m_left_stick.y;
+            if (m_data_type != SD_LEFT_Y) m_data_type = SD_BOTH;
+            break;
+        case SD_RIGHT_X:
+            m_right_stick.x = other.m_right_stick.x;
+            if (m_data_type != SD_RIGHT_X) m_data_type = SD_BOTH;
+            break;
+        case SD_RIGHT_Y:
+            m_right_stick.y = other.m_right_stick.y;
+            if (m_data_type != SD_RIGHT_Y) m_data_type = SD_BOTH;
+            break;
+        default:;
+    }
+}
+
+bool element_data_analog_stick::from_buffer(netlib_byte_buf* buffer, element_data_analog_stick &out)
+{
+    out = element_data_analog_stick();
+
+    if (!netlib_read_float(buffer, &out.m_left_stick.x) || !netlib_read_float(buffer, &out.m_left_stick.y) ||
+        !netlib_read_float(buffer, &out.m_right_stick.x) || !netlib_read_float(buffer, &out.m_right_stick.y)) {
+#ifdef _DEBUG
+        blog(LOG_INFO, "Reading of analog stick data failed: %s", netlib_get_error());
+#endif
+        return false;
+    }
+    return true;
+}
+
+/* Trigger */
+
+element_data_trigger::element_data_trigger(const trigger_data_type side, const float val)
+{
+    if (side == T_DATA_LEFT)
+        m_left_trigger = val;
+    else
+        m_right_trigger = val;
+    m_data_type = side;
+}
+
+element_data_trigger::element_data_trigger(const float left, const float right)
+{
+    m_left_trigger = left;
+    m_right_trigger = right;
+    m_data_type = T_DATA_BOTH;
+}
+
+float element_data_trigger::get_left() const
+{
+    return m_left_trigger;
+}
+
+float element_data_trigger::get_right() const
+{
+    return m_right_trigger;
+}
+
+void element_data_trigger::merge(const element_data_trigger &other)
+{
+    switch (other.m_data_type) {
+        case T_DATA_BOTH:
+            m_left_trigger = other.m_left_trigger;
+            m_right_trigger = other.m_right_trigger;
+            break;
+        case T_DATA_LEFT:
+            m_left_trigger = other.m_left_trigger;
+            if (m_data_type == T_DATA_RIGHT) /* Left merged with right = now contains both sides */
+                m_data_type = T_DATA_BOTH;
+            break;
+        case T_DATA_RIGHT:
+            m_right_trigger = other.m_right_trigger;
+            if (m_data_type == T_DATA_LEFT) /* Left merged with right = now contains both sides */
+                m_data_type = T_DATA_BOTH;
+            break;
+        default:;
+    }
+}
+
+bool element_data_trigger::from_buffer(netlib_byte_buf* buffer, element_data_trigger &out)
+{
+    uint8_t left, right;
+    if (!netlib_read_uint8(buffer, &left) || !netlib_read_uint8(buffer, &right)) {
+#ifdef _DEBUG
+        blog(LOG_INFO, "Failed to read trigger data: %s", netlib_get_error());
+#endif
+        return false;
+    }
+    out = element_data_trigger(left / TRIGGER_MAX_VAL, right / TRIGGER_MAX_VAL);
+    return true;
+}
+
+/* Dpad */
+
+element_data_dpad::element_data_dpad(const dpad_direction a, const dpad_direction b)
+{
+    m_direction = a | b;
+    m_state = STATE_RELEASED;
+}
+
+element_data_dpad::element_data_dpad(const dpad_direction d, const button_state state)
+{
+    m_direction = d;
+    m_state = state;
+}
+
+void element_data_dpad::merge(const element_data_dpad &other)
+{
+#ifdef _WIN32
+    m_direction = other.m_direction;
+#else
+    if (other.get_state() == STATE_PRESSED) {
+        m_direction |= other.m_direction;
+    } else {
+        m_direction &= ~other.m_direction;
+    }
+#endif /* !WINDOWS*/
+}
+
+dpad_texture element_data_dpad::get_direction() const
+{
+    if (m_direction & DPAD_UP && m_direction & DPAD_LEFT)
+        return DPAD_TEXTURE_TOP_LEFT;
+    else if (m_direction & DPAD_UP && m_direction & DPAD_RIGHT)
+        return DPAD_TEXTURE_TOP_RIGHT;
+    else if (m_direction & DPAD_DOWN && m_direction & DPAD_LEFT)
+        return DPAD_TEXTURE_BOTTOM_LEFT;
+    else if (m_direction & DPAD_DOWN && m_direction & DPAD_RIGHT)
+        return DPAD_TEXTURE_BOTTOM_RIGHT;
+    else if (m_direction & DPAD_UP)
+        return DPAD_TEXTURE_UP;
+    else if (m_direction & DPAD_DOWN)
+        return DPAD_TEXTURE_DOWN;
+    else if (m_direction & DPAD_LEFT)
+        return DPAD_TEXTURE_LEFT;
+    else
+        return DPAD_TEXTURE_RIGHT;
+}
+
+button_state element_data_dpad::get_state() const
+{
+    return m_state;
+}
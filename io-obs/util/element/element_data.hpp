@@ -0,0 +1,333 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include "../layout_constants.hpp"
+#include <graphics/vec2.h>
+#include <netlib.h>
+#include <stdint.h>
+
+/* Input data sent from the hooks to the elements. All types are
+ * plain values without any heap memory, so they can be copied
+ * around freely and stored in place
+ */
+
+enum stat_type
+{
+    stat_pos, stat_scroll_amount, stat_lmb, stat_rmb, stat_mmb
+};
+
+enum stick_data_type
+{
+    SD_BOTH, SD_PRESSED_STATE_LEFT, SD_PRESSED_STATE_RIGHT, SD_LEFT_X, SD_LEFT_Y, SD_RIGHT_X, SD_RIGHT_Y
+};
+
+enum trigger_data_type
+{
+    T_DATA_NONE = -1,
+    T_DATA_BOTH,
+    T_DATA_LEFT,
+    T_DATA_RIGHT
+};
+
+enum wheel_data_type
+{
+    WHEEL_BOTH, BUTTON_STATE, WHEEL_STATE
+};
+
+class element_data_button
+{
+public:
+    element_data_button(const button_state state) : m_state(state)
+    {
+    }
+
+    button_state get_state() const
+    {
+        return m_state;
+    }
+
+    void merge(const element_data_button &other);
+
+private:
+    button_state m_state;
+};
+
+class element_data_wheel
+{
+public:
+    element_data_wheel(wheel_direction dir, button_state state);
+
+    explicit element_data_wheel(wheel_direction dir);
+
+    explicit element_data_wheel(button_state state);
+
+    wheel_direction get_dir() const;
+
+    void set_dir(wheel_direction dir);
+
+    button_state get_state() const;
+
+    void merge(const element_data_wheel &other);
+
+    wheel_data_type get_data_type() const;
+
+private:
+    wheel_data_type m_data_type;
+    button_state m_middle_button;
+    wheel_direction m_dir;
+};
+
+/* Contains all information about mouse movement,
+ * button clicks and scroll motion
+ */
+class element_data_mouse_stats
+{
+public:
+    element_data_mouse_stats(int16_t x, int16_t y);
+
+    explicit element_data_mouse_stats(stat_type type);
+
+    element_data_mouse_stats(int scroll_amount, wheel_direction dir, bool unused);
+
+    void merge(const element_data_mouse_stats &other);
+
+    uint32_t get_mmb_total() const;
+
+    uint32_t get_mmb_current() const;
+
+    uint32_t get_lmb_total() const;
+
+    uint32_t get_lmb_current() const;
+
+    uint32_t get_rmb_total() const;
+
+    uint32_t get_rmb_current() const;
+
+    int16_t get_mouse_x() const;
+
+    int16_t get_mouse_y() const;
+
+    int16_t get_last_x() const;
+
+    int16_t get_last_y() const;
+
+    int32_t get_wheel_current() const;
+
+    int32_t get_wheel_total() const;
+
+private:
+    stat_type m_type;
+
+    int16_t m_x{}, m_y{};
+    int16_t m_last_x{}, m_last_y{};
+    uint32_t m_lmbcount_total{}, m_lmbcount_current{}, m_rmbcount_total{}, m_rmbcount_current{}, m_mmbcount_total{}, m_mmbcount_current{};
+    int32_t m_wheel_up_total{}, m_wheel_down_total{}, m_wheel_current{};
+    wheel_direction m_dir = WHEEL_DIR_NONE;
+};
+
+/* Contains data for both analog sticks
+ */
+class element_data_analog_stick
+{
+public:
+    element_data_analog_stick() : m_left_state(), m_right_state()
+    {
+    }
+
+    /*
+        Separate constructors are used on linux
+        because the values can't be queried together
+    */
+    element_data_analog_stick(button_state state, element_side side);
+
+    element_data_analog_stick(float axis_value, stick_data_type data_type);
+
+    element_data_analog_stick(button_state left, button_state right, float l_x, float l_y, float r_x, float r_y);
+
+    bool left_pressed() const
+    {
+        return m_left_state == STATE_PRESSED;
+    }
+
+    bool right_pressed() const
+    {
+        return m_right_state == STATE_PRESSED;
+    }
+
+    const vec2* get_left_stick() const
+    {
+        return &m_left_stick;
+    }
+
+    const vec2* get_right_stick() const
+    {
+        return &m_right_stick;
+    }
+
+    void set_state(button_state left, button_state right);
+
+    void merge(const element_data_analog_stick &other);
+
+    static bool from_buffer(netlib_byte_buf* buffer, element_data_analog_stick &out);
+
+private:
+    vec2 m_left_stick{}, m_right_stick{};
+    stick_data_type m_data_type = SD_BOTH;
+    button_state m_left_state, m_right_state;
+};
+
+/* Contains data for both trigger buttons
+ */
+class element_data_trigger
+{
+public:
+    element_data_trigger() = default;
+
+    /*
+        Separate constructors are used on linux
+        because the values can't be queried together
+    */
+    element_data_trigger(trigger_data_type side, float val);
+
+    element_data_trigger(float left, float right);
+
+    float get_left() const;
+
+    float get_right() const;
+
+    void merge(const element_data_trigger &other);
+
+    static bool from_buffer(netlib_byte_buf* buffer, element_data_trigger &out);
+
+private:
+    trigger_data_type m_data_type = T_DATA_BOTH;
+    float m_left_trigger = 0.f, m_right_trigger = 0.f;
+};
+
+class element_data_dpad
+{
+public:
+    /*
+        Separate constructors are used on linux
+        because the values can't be queried together
+    */
+
+    /* Xinput directly generates direction */
+    element_data_dpad(dpad_direction a, dpad_direction b);
+
+    element_data_dpad(dpad_direction d, button_state state);
+
+    void merge(const element_data_dpad &other);
+
+    dpad_texture get_direction() const;
+
+    button_state get_state() const;
+
+private:
+    uint16_t m_direction;
+    button_state m_state;
+};
+
+/* Holds one of the types above, selected by get_type().
+ * Default constructed data is empty (type INVALID)
+ */
+class element_data
+{
+public:
+    element_data() : m_type(INVALID), m_button(STATE_RELEASED)
+    {
+    }
+
+    element_data(const element_data_button &button) : m_type(BUTTON), m_button(button)
+    {
+    }
+
+    element_data(const element_data_wheel &wheel) : m_type(MOUSE_SCROLLWHEEL), m_wheel(wheel)
+    {
+    }
+
+    element_data(const element_data_mouse_stats &stats) : m_type(MOUSE_STATS), m_mouse_stats(stats)
+    {
+    }
+
+    element_data(const element_data_analog_stick &stick) : m_type(ANALOG_STICK), m_stick(stick)
+    {
+    }
+
+    element_data(const element_data_trigger &trigger) : m_type(TRIGGER), m_trigger(trigger)
+    {
+    }
+
+    element_data(const element_data_dpad &dpad) : m_type(DPAD_STICK), m_dpad(dpad)
+    {
+    }
+
+    element_type get_type() const
+    {
+        return m_type;
+    }
+
+    bool is_empty() const
+    {
+        return m_type == INVALID;
+    }
+
+    /* true if data should not me removed */
+    bool is_persistent() const
+    {
+        return m_type != INVALID && m_type != BUTTON;
+    }
+
+    /* Only does something if both are the same type */
+    void merge(const element_data &other);
+
+    /* These return nullptr if the data is a different type */
+    const element_data_button* get_button() const
+    {
+        return m_type == BUTTON ? &m_button : nullptr;
+    }
+
+    const element_data_wheel* get_wheel() const
+    {
+        return m_type == MOUSE_SCROLLWHEEL ? &m_wheel : nullptr;
+    }
+
+    const element_data_mouse_stats* get_mouse_stats() const
+    {
+        return m_type == MOUSE_STATS ? &m_mouse_stats : nullptr;
+    }
+
+    const element_data_analog_stick* get_stick() const
+    {
+        return m_type == ANALOG_STICK ? &m_stick : nullptr;
+    }
+
+    const element_data_trigger* get_trigger() const
+    {
+        return m_type == TRIGGER ? &m_trigger : nullptr;
+    }
+
+    const element_data_dpad* get_dpad() const
+    {
+        return m_type == DPAD_STICK ? &m_dpad : nullptr;
+    }
+
+private:
+    element_type m_type;
+
+    union
+    {
+        element_data_button m_button;
+        element_data_wheel m_wheel;
+        element_data_mouse_stats m_mouse_stats;
+        element_data_analog_stick m_stick;
+        element_data_trigger m_trigger;
+        element_data_dpad m_dpad;
+    };
+};
@@ -6,101 +6,250 @@
  */
 
 #include "element_data_holder.hpp"
-#include "element_trigger.hpp"
 #include "sources/input_history.hpp"
-#include "element_button.hpp"
-#include "element_analog_stick.hpp"
+#include "util/recording/recorder.hpp"
+#include <util/platform.h>
+#include <atomic>
+#include <cstring>
 
-element_data_holder::element_data_holder()
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* Shared button data, the holder only stores the state bit */
+static const element_data button_pressed = element_data_button(STATE_PRESSED);
+static const element_data button_released = element_data_button(STATE_RELEASED);
+
+static inline bool test_bit(const uint64_t* set, const uint16_t bit)
 {
-    m_button_data = std::map<uint16_t, std::unique_ptr<element_data>>();
+    return (set[bit >> 6] >> (bit & 63)) & 1;
 }
 
-element_data_holder::~element_data_holder()
+static inline void set_bit(uint64_t* set, const uint16_t bit, const bool value)
 {
-    clear_data();
+    if (value)
+        set[bit >> 6] |= 1ull << (bit & 63);
+    else
+        set[bit >> 6] &= ~(1ull << (bit & 63));
 }
 
-bool element_data_holder::is_empty() const
+static inline int lowest_bit(const uint64_t word)
 {
-    auto flag = true;
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
 
-    for (const auto &pad : m_gamepad_data) {
-        if (!pad.empty()) {
-            flag = false;
-            break;
+/* Calls f for every set bit in ascending order */
+template<class F>
+static void for_each_bit(const uint64_t* set, const size_t words, F f)
+{
+    for (size_t i = 0; i < words; i++) {
+        auto word = set[i];
+        while (word) {
+            f(static_cast<uint16_t>(i * 64 + lowest_bit(word)));
+            word &= word - 1;
         }
     }
+}
+
+/* Persistent data is merged into the existing slot, everything
+ * else replaces it
+ */
+static void store(element_data &slot, const element_data &data)
+{
+    if (slot.is_persistent())
+        slot.merge(data);
+    else
+        slot = data;
+}
 
-    return flag && m_button_data.empty();
+static inline bool is_pad_button(const uint16_t keycode)
+{
+    return (keycode & 0xFF00u) == VC_PAD_MASK;
+}
+
+/* Every state starts in its own range of generations */
+static std::atomic<uint64_t> next_generation(0);
+
+input_state::input_state() : m_generation(next_generation.fetch_add(1) << 32)
+{
+    clear_data();
 }
 
-void element_data_holder::add_data(const uint16_t keycode, element_data* data)
+bool input_state::is_empty() const
 {
-    if (data_exists(keycode)) {
-        if (m_button_data[keycode]->is_persistent()) {
-            m_button_data[keycode]->merge(data);
-            delete data; /* Existing data was used -> delete other one */
-        } else {
-            remove_data(keycode);
-            m_button_data[keycode] = std::unique_ptr<element_data>(data);
+    if (m_known_count > 0 || !m_wheel.is_empty() || !m_mouse.is_empty())
+        return false;
+
+    for (const auto &pad : m_pads) {
+        if (!pad.stick.is_empty() || !pad.trigger.is_empty() || !pad.dpad.is_empty())
+            return false;
+        for (const auto &word : pad.known) {
+            if (word)
+                return false;
         }
-    } else {
-        m_button_data[keycode] = std::unique_ptr<element_data>(data);
+    }
+    return true;
+}
+
+const element_data* input_state::get_slot(const uint16_t keycode) const
+{
+    switch (keycode) {
+        case VC_MOUSE_WHEEL:
+            return &m_wheel;
+        case VC_MOUSE_DATA:
+            return &m_mouse;
+        default:
+            return nullptr;
+    }
+}
+
+const element_data* input_state::get_pad_slot(const uint8_t gamepad, const uint16_t keycode) const
+{
+    switch (keycode) {
+        case VC_STICK_DATA:
+            return &m_pads[gamepad].stick;
+        case VC_TRIGGER_DATA:
+            return &m_pads[gamepad].trigger;
+        case VC_DPAD_DATA:
+            return &m_pads[gamepad].dpad;
+        default:
+            return nullptr;
     }
 }
 
-void element_data_holder::add_gamepad_data(const uint8_t gamepad, const uint16_t keycode, element_data* data)
+void input_state::add_data(const uint16_t keycode, const element_data &data)
 {
-    if (gamepad_data_exists(gamepad, keycode)) {
-        if (m_gamepad_data[gamepad][keycode]->is_persistent()) {
-            m_gamepad_data[gamepad][keycode]->merge(data);
+    m_generation++;
+    const auto slot = get_slot(keycode);
+    if (slot) {
+        store(*slot, data);
+        return;
+    }
 
-            delete data; /* Existing data was used -> delete other one */
-        } else {
-            remove_gamepad_data(gamepad, keycode);
-            m_gamepad_data[gamepad][keycode] = std::unique_ptr<element_data>(data);
+    const auto button = data.get_button();
+    if (button) {
+        if (!test_bit(m_known, keycode)) {
+            set_bit(m_known, keycode, true);
+            m_known_count++;
         }
-    } else {
-        m_gamepad_data[gamepad][keycode] = std::unique_ptr<element_data>(data);
+        set_bit(m_pressed, keycode, button->get_state() == STATE_PRESSED);
+    }
+}
+
+void input_state::restore(const input_state &snapshot)
+{
+    const auto generation = m_generation;
+    *this = snapshot;
+    m_generation = generation + 1;
+}
+
+void input_state::add_gamepad_data(const uint8_t gamepad, const uint16_t keycode, const element_data &data)
+{
+    if (gamepad >= PAD_COUNT)
+        return;
+
+    m_generation++;
+    const auto slot = get_pad_slot(gamepad, keycode);
+    if (slot) {
+        store(*slot, data);
+        return;
+    }
+
+    const auto button = data.get_button();
+    if (button && is_pad_button(keycode)) {
+        auto &pad = m_pads[gamepad];
+        set_bit(pad.known, keycode & 0xFFu, true);
+        set_bit(pad.pressed, keycode & 0xFFu, button->get_state() == STATE_PRESSED);
     }
 }
 
-bool element_data_holder::gamepad_data_exists(const uint8_t gamepad, const uint16_t keycode)
+void input_state::set_gamepad_time(const uint8_t gamepad, const uint64_t time)
+{
+    if (gamepad >= PAD_COUNT)
+        return;
+    if (time > m_pads[gamepad].time)
+        m_pads[gamepad].time = time;
+    set_event_time(time);
+}
+
+uint64_t input_state::get_gamepad_time(const uint8_t gamepad) const
 {
-    if (is_empty())
+    return gamepad < PAD_COUNT ? m_pads[gamepad].time : 0;
+}
+
+bool input_state::gamepad_data_exists(const uint8_t gamepad, const uint16_t keycode) const
+{
+    if (gamepad >= PAD_COUNT)
         return false;
-    return m_gamepad_data[gamepad][keycode] != nullptr;
+
+    const auto slot = get_pad_slot(gamepad, keycode);
+    if (slot)
+        return !slot->is_empty();
+    return is_pad_button(keycode) && test_bit(m_pads[gamepad].known, keycode & 0xFFu);
 }
 
-void element_data_holder::remove_gamepad_data(const uint8_t gamepad, const uint16_t keycode)
+void input_state::remove_gamepad_data(const uint8_t gamepad, const uint16_t keycode)
 {
-    if (gamepad_data_exists(gamepad, keycode)) {
-        m_gamepad_data[gamepad][keycode].reset();
-        m_gamepad_data[gamepad].erase(keycode);
+    if (gamepad >= PAD_COUNT)
+        return;
+
+    m_generation++;
+    const auto slot = get_pad_slot(gamepad, keycode);
+    if (slot) {
+        *slot = element_data();
+    } else if (is_pad_button(keycode)) {
+        set_bit(m_pads[gamepad].known, keycode & 0xFFu, false);
+        set_bit(m_pads[gamepad].pressed, keycode & 0xFFu, false);
     }
 }
 
-element_data* element_data_holder::get_by_gamepad(const uint8_t gamepad, const uint16_t keycode)
+const element_data* input_state::get_by_gamepad(const uint8_t gamepad, const uint16_t keycode) const
 {
-    auto result = m_gamepad_data[gamepad][keycode].get();
-    return result;
+    if (gamepad >= PAD_COUNT)
+        return nullptr;
+
+    const auto slot = get_pad_slot(gamepad, keycode);
+    if (slot)
+        return slot->is_empty() ? nullptr : slot;
+
+    if (!is_pad_button(keycode) || !test_bit(m_pads[gamepad].known, keycode & 0xFFu))
+        return nullptr;
+    return test_bit(m_pads[gamepad].pressed, keycode & 0xFFu) ? &button_pressed : &button_released;
 }
 
-void element_data_holder::clear_data()
+void input_state::clear_data()
 {
     clear_button_data();
     clear_gamepad_data();
 }
 
-void element_data_holder::clear_button_data()
+void input_state::clear_button_data()
 {
-    m_button_data.clear();
+    m_generation++;
+    memset(m_known, 0, sizeof(m_known));
+    memset(m_pressed, 0, sizeof(m_pressed));
+    m_known_count = 0;
+    m_wheel = element_data();
+    m_mouse = element_data();
 }
 
-void element_data_holder::clear_gamepad_data()
+void input_state::clear_gamepad_data()
 {
-    m_gamepad_data->clear();
+    m_generation++;
+    for (auto &pad : m_pads) {
+        memset(pad.known, 0, sizeof(pad.known));
+        memset(pad.pressed, 0, sizeof(pad.pressed));
+        pad.stick = element_data();
+        pad.trigger = element_data();
+        pad.dpad = element_data();
+        pad.time = 0;
+    }
 }
 
 bool inline is_new_key(const std::vector<uint16_t> &vec, uint16_t vc)
@@ -111,105 +260,130 @@ bool inline is_new_key(const std::vector<uint16_t> &vec, uint16_t vc)
     return true;
 }
 
-void element_data_holder::populate_vector(std::vector<uint16_t> &vec, sources::history_settings* settings)
+void input_state::populate_vector(std::vector<uint16_t> &vec, sources::history_settings* settings) const
 {
-    for (const auto &data : m_button_data) {
-        /* Mouse data is persistent and shouldn't be included
-         * Any mouse buttons should only be included if enabled
-         */
-        if (data.first == VC_MOUSE_DATA ||
-            ((data.first >> 8) == (VC_MOUSE_MASK >> 8) && !(settings->flags & sources::FLAG_INCLUDE_MOUSE)))
-            continue;
-
-        if (data.second->get_type() == BUTTON) {
-            if (dynamic_cast<element_data_button*>(data.second.get())->get_state() == STATE_RELEASED)
-                continue;
+    const auto include_mouse = (settings->flags & sources::FLAG_INCLUDE_MOUSE) != 0;
+    auto wheel_added = m_wheel.is_empty() || !include_mouse;
+
+    /* Only pressed keys are listed. The wheel has no pressed state, it's
+     * listed as long as there's data for it and sorted in by its keycode
+     * to keep the order of the keys the same as before
+     */
+    for_each_bit(m_pressed, KEY_WORDS, [&](const uint16_t code)
+    {
+        /* Any mouse buttons should only be included if enabled */
+        if ((code >> 8) == (VC_MOUSE_MASK >> 8) && !include_mouse)
+            return;
+
+        if (!wheel_added && code > VC_MOUSE_WHEEL) {
+            if (is_new_key(vec, VC_MOUSE_WHEEL))
+                vec.emplace_back(VC_MOUSE_WHEEL);
+            wheel_added = true;
         }
 
-        if (is_new_key(vec, data.first)) /* if not add it */
+        if (is_new_key(vec, code)) /* if not add it */
+            vec.emplace_back(code);
+    });
+
+    if (!wheel_added && is_new_key(vec, VC_MOUSE_WHEEL))
+        vec.emplace_back(VC_MOUSE_WHEEL);
+
+    /* Same procedure for the gamepad */
+    if (settings->flags & sources::FLAG_INCLUDE_PAD && settings->target_gamepad < PAD_COUNT) {
+        const auto &pad = m_pads[settings->target_gamepad];
+
+        for_each_bit(pad.pressed, PAD_KEY_WORDS, [&](const uint16_t code)
         {
-            vec.emplace_back(data.first);
+            if (is_new_key(vec, PAD_TO_VC(code)))
+                vec.emplace_back(PAD_TO_VC(code));
+        });
+
+        const auto stick = pad.stick.get_stick();
+        if (stick) {
+            if (stick->left_pressed() && is_new_key(vec, VC_PAD_L_ANALOG))
+                vec.emplace_back(VC_PAD_L_ANALOG);
+
+            if (stick->right_pressed() && is_new_key(vec, VC_PAD_R_ANALOG))
+                vec.emplace_back(VC_PAD_R_ANALOG);
         }
-    }
 
-    /* Same procedure for the gamepad */
-    if (settings->flags & sources::FLAG_INCLUDE_PAD) {
-        for (const auto &data : m_gamepad_data[settings->target_gamepad]) {
-            auto add = true;
-            auto code = data.first;
-            element_data_analog_stick* stick = nullptr;
-            element_data_button* button = nullptr;
-            element_data_trigger* trigger = nullptr;
-
-            if (data.second) {
-                switch (data.second->get_type()) {
-                    case BUTTON:
-                        button = dynamic_cast<element_data_button*>(data.second.get());
-                        if (button && button->get_state() == STATE_RELEASED)
-                            continue;
-                        break;
-                    case ANALOG_STICK:
-                        stick = dynamic_cast<element_data_analog_stick*>(data.second.get());
-                        if (stick) {
-                            if (stick->left_pressed() && is_new_key(vec, VC_PAD_L_ANALOG))
-                                vec.emplace_back(VC_PAD_L_ANALOG);
-
-                            if (stick->right_pressed() && is_new_key(vec, VC_PAD_R_ANALOG))
-                                vec.emplace_back(VC_PAD_R_ANALOG);
-                            add = false;
-                        }
-                        break;
-                    case TRIGGER:
-                        trigger = dynamic_cast<element_data_trigger*>(data.second.get());
-
-                        if (trigger) {
-                            if (trigger->get_left() > TRIGGER_THRESHOLD && is_new_key(vec, VC_PAD_LT))
-                                vec.emplace_back(VC_PAD_LT);
-
-                            if (trigger->get_right() > TRIGGER_THRESHOLD && is_new_key(vec, VC_PAD_RT))
-                                vec.emplace_back(VC_PAD_RT);
-                            add = false;
-                        }
-                    default:;
-                }
-            }
-
-            if (add && is_new_key(vec, code)) {
-                switch (code) {
-                    case VC_STICK_DATA:
-                    case VC_TRIGGER_DATA:
-                    case VC_DPAD_DATA:
-                        break;
-                    default:
-                        vec.emplace_back(code);
-                }
-            }
+        const auto trigger = pad.trigger.get_trigger();
+        if (trigger) {
+            if (trigger->get_left() > TRIGGER_THRESHOLD && is_new_key(vec, VC_PAD_LT))
+                vec.emplace_back(VC_PAD_LT);
+
+            if (trigger->get_right() > TRIGGER_THRESHOLD && is_new_key(vec, VC_PAD_RT))
+                vec.emplace_back(VC_PAD_RT);
         }
     }
 }
 
-bool element_data_holder::data_exists(const uint16_t keycode)
+bool input_state::data_exists(const uint16_t keycode) const
 {
-    if (is_empty())
-        return false;
-
-    return m_button_data[keycode] != nullptr;
+    const auto slot = get_slot(keycode);
+    if (slot)
+        return !slot->is_empty();
+    return test_bit(m_known, keycode);
 }
 
-void element_data_holder::remove_data(const uint16_t keycode)
+void input_state::remove_data(const uint16_t keycode)
 {
-    if (data_exists(keycode)) {
-
-        m_button_data[keycode].reset();
-        m_button_data.erase(keycode);
+    m_generation++;
+    const auto slot = get_slot(keycode);
+    if (slot) {
+        *slot = element_data();
+    } else if (test_bit(m_known, keycode)) {
+        set_bit(m_known, keycode, false);
+        set_bit(m_pressed, keycode, false);
+        m_known_count--;
     }
 }
 
-element_data* element_data_holder::get_by_code(const uint16_t keycode)
+const element_data* input_state::get_by_code(const uint16_t keycode) const
 {
+    const auto slot = get_slot(keycode);
+    if (slot)
+        return slot->is_empty() ? nullptr : slot;
 
-    if (!data_exists(keycode))
+    if (!test_bit(m_known, keycode))
         return nullptr;
+    return test_bit(m_pressed, keycode) ? &button_pressed : &button_released;
+}
+
+void element_data_holder::add_data(const uint16_t keycode, const element_data &data)
+{
+    input_state::add_data(keycode, data);
+    if (m_source != LOG_SOURCE_LOCAL && m_source != LOG_SOURCE_NONE && recorder::active())
+        recorder::record_data(m_source, keycode, data);
+}
+
+void element_data_holder::add_gamepad_data(const uint8_t gamepad, const uint16_t keycode, const element_data &data)
+{
+    input_state::add_gamepad_data(gamepad, keycode, data);
+    if (m_source != LOG_SOURCE_NONE && recorder::active())
+        recorder::record_gamepad_data(m_source, gamepad, keycode, data);
+}
+
+void element_data_holder::clear_button_data()
+{
+    input_state::clear_button_data();
+    if (m_source != LOG_SOURCE_NONE && recorder::active())
+        recorder::record_clear(m_source);
+}
 
-    return m_button_data[keycode].get();
+void element_data_holder::publish()
+{
+    /* Remote clients resend their state on every refresh,
+     * only batches with newer input than before are timed */
+    if (get_event_time() != m_published_event_time) {
+        m_published_event_time = get_event_time();
+        set_ingest_time(os_gettime_ns());
+    }
+    m_snapshots.back() = *this;
+    m_snapshots.publish();
+}
+
+const input_state &element_data_holder::snapshot()
+{
+    return m_snapshots.front();
 }
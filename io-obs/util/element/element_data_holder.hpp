@@ -8,8 +8,8 @@
 #pragma once
 
 #include "element.hpp"
-#include <map>
-#include <memory>
+#include "../util.hpp"
+#include "../triple_buffer.hpp"
 #include <vector>
 
 namespace sources
@@ -17,31 +17,37 @@ namespace sources
     struct history_settings;
 }
 
-/* Holds all input data for connected clients
- * and/or the local computer
+/* One bit per 16 bit keycode */
+#define KEY_WORDS       (0x10000 / 64)
+/* Gamepad buttons only use the lower byte, the upper one is VC_PAD_MASK */
+#define PAD_KEY_WORDS   (0x100 / 64)
+
+/* State of all inputs of one data source.
+ * Button states are kept in bitsets indexed by keycode and all other data
+ * (mouse, wheel, sticks, triggers and dpad) has a fixed slot, so
+ * lookups never search and adding a key never allocates.
+ * This is a plain value, copying it takes a snapshot
  */
-class element_data_holder
+class input_state
 {
 public:
-    element_data_holder();
+    input_state();
 
-    ~element_data_holder();
+    void add_data(uint16_t keycode, const element_data &data);
 
-    void add_data(uint16_t keycode, element_data* data);
-
-    bool data_exists(uint16_t keycode);
+    bool data_exists(uint16_t keycode) const;
 
     void remove_data(uint16_t keycode);
 
-    element_data* get_by_code(uint16_t keycode);
+    const element_data* get_by_code(uint16_t keycode) const;
 
-    void add_gamepad_data(uint8_t gamepad, uint16_t keycode, element_data* data);
+    void add_gamepad_data(uint8_t gamepad, uint16_t keycode, const element_data &data);
 
-    bool gamepad_data_exists(uint8_t gamepad, uint16_t keycode);
+    bool gamepad_data_exists(uint8_t gamepad, uint16_t keycode) const;
 
     void remove_gamepad_data(uint8_t gamepad, uint16_t keycode);
 
-    element_data* get_by_gamepad(uint8_t gamepad, uint16_t keycode);
+    const element_data* get_by_gamepad(uint8_t gamepad, uint16_t keycode) const;
 
     void clear_data();
 
@@ -49,11 +55,132 @@ public:
 
     void clear_gamepad_data();
 
-    void populate_vector(std::vector<uint16_t> &vec, sources::history_settings* settings);
+    /* Overwrites everything with a snapshot, e.g. one stored in a recording.
+     * The generation isn't taken from the snapshot, this state's own one
+     * moves on so readers never mistake it for one they've already seen */
+    void restore(const input_state &snapshot);
+
+    void populate_vector(std::vector<uint16_t> &vec, sources::history_settings* settings) const;
+
+    /* Capture time (os_gettime_ns) of the newest applied event,
+     * zero if there never was one */
+    void set_event_time(uint64_t time)
+    {
+        if (time > m_event_time)
+            m_event_time = time;
+    }
+
+    uint64_t get_event_time() const
+    {
+        return m_event_time;
+    }
+
+    /* Time (os_gettime_ns) the newest events were applied, set by
+     * element_data_holder when it publishes them. Zero if there never were any */
+    void set_ingest_time(uint64_t time)
+    {
+        m_ingest_time = time;
+    }
+
+    uint64_t get_ingest_time() const
+    {
+        return m_ingest_time;
+    }
+
+    void set_gamepad_time(uint8_t gamepad, uint64_t time);
+
+    uint64_t get_gamepad_time(uint8_t gamepad) const;
 
     bool is_empty() const;
 
+    /* Changes every time data is added, removed or cleared, so readers can
+     * tell whether a snapshot differs from one they've already seen.
+     * Generations of different states never overlap */
+    uint64_t get_generation() const
+    {
+        return m_generation;
+    }
+
+private:
+    struct pad_data
+    {
+        uint64_t known[PAD_KEY_WORDS];
+        uint64_t pressed[PAD_KEY_WORDS];
+        element_data stick;
+        element_data trigger;
+        element_data dpad;
+        uint64_t time;
+    };
+
+    const element_data* get_slot(uint16_t keycode) const;
+
+    const element_data* get_pad_slot(uint8_t gamepad, uint16_t keycode) const;
+
+    element_data* get_slot(const uint16_t keycode)
+    {
+        return const_cast<element_data*>(static_cast<const input_state*>(this)->get_slot(keycode));
+    }
+
+    element_data* get_pad_slot(const uint8_t gamepad, const uint16_t keycode)
+    {
+        return const_cast<element_data*>(static_cast<const input_state*>(this)->get_pad_slot(gamepad, keycode));
+    }
+
+    /* Keys which have any data, pressed or released */
+    uint64_t m_known[KEY_WORDS];
+    uint64_t m_pressed[KEY_WORDS];
+    uint32_t m_known_count = 0;
+    uint64_t m_event_time = 0;
+    uint64_t m_ingest_time = 0;
+    uint64_t m_generation;
+
+    element_data m_wheel;
+    element_data m_mouse;
+    pad_data m_pads[PAD_COUNT];
+};
+
+/* Holds all input data for connected clients
+ * and/or the local computer.
+ * The input_state methods are used by the thread feeding in input and
+ * have to be guarded by that source's mutex. Renderers only ever read
+ * snapshots, which never blocks the input side
+ */
+class element_data_holder : public input_state
+{
+public:
+    /* Source id used in input recordings, see input_log.hpp */
+    explicit element_data_holder(uint8_t source = 0) : m_source(source)
+    {
+    }
+
+    uint8_t get_source() const
+    {
+        return m_source;
+    }
+
+    /* Same as in input_state, but the change is also written to a running
+     * recording. Local keyboard and mouse input is recorded as raw events
+     * by the hook instead, so only gamepads are recorded here for it
+     */
+    void add_data(uint16_t keycode, const element_data &data);
+
+    void add_gamepad_data(uint8_t gamepad, uint16_t keycode, const element_data &data);
+
+    void clear_button_data();
+
+    /* Makes the current state visible to snapshot(). Call this after
+     * every batch of changes, with the same lock held. Batches that
+     * brought new events get the current time as ingest time
+     */
+    void publish();
+
+    /* Newest published state. Only called by the frame scheduler
+     * on the graphics thread, stays valid until the next call
+     */
+    const input_state &snapshot();
+
 private:
-    std::map<uint16_t, std::unique_ptr<element_data>> m_button_data;
-    std::map<uint16_t, std::unique_ptr<element_data>> m_gamepad_data[4];
+    triple_buffer<input_state> m_snapshots;
+    uint8_t m_source;
+    uint64_t m_published_event_time = 0;
 };
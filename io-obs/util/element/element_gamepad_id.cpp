@@ -6,7 +6,6 @@
  */
 
 #include "../../sources/input_source.hpp"
-#include "../../../ccl/ccl.hpp"
 #include "element_gamepad_id.hpp"
 #include "util/layout_constants.hpp"
 #include "element_button.hpp"
@@ -16,9 +15,9 @@ element_gamepad_id::element_gamepad_id() : element_texture(GAMEPAD_ID), m_mappin
     m_keycode = VC_PAD_GUIDE;
 }
 
-void element_gamepad_id::load(ccl_config* cfg, const std::string &id)
+void element_gamepad_id::load(const iolayout_element &e)
 {
-    element_texture::load(cfg, id);
+    element_texture::load(e);
     auto i = 1;
     for (auto &map : m_mappings) {
         map = m_mapping;
@@ -26,20 +25,21 @@ void element_gamepad_id::load(ccl_config* cfg, const std::string &id)
     }
 }
 
-void element_gamepad_id::draw(gs_effect_t* effect, gs_image_file_t* image, element_data* data,
-                              sources::overlay_settings* settings)
+void element_gamepad_id::draw(sprite_batch &batch, const element_data* data, sources::overlay_settings* settings,
+                              element_state &state) const
 {
+    UNUSED_PARAMETER(state);
     if (data) {
-        const auto d = dynamic_cast<element_data_button*>(data);
+        const auto d = data->get_button();
         if (d && d->get_state()) {
-            element_texture::draw(effect, image, &m_mappings[ID_PRESSED]);
+            element_texture::draw(batch, &m_mappings[ID_PRESSED]);
         }
     }
 
     if (settings->gamepad > 0) {
-        element_texture::draw(effect, image, &m_mappings[settings->gamepad - 1]);
+        element_texture::draw(batch, &m_mappings[settings->gamepad - 1]);
     } else {
-        element_texture::draw(effect, image, &m_mapping);
+        element_texture::draw(batch, &m_mapping);
     }
 }
 
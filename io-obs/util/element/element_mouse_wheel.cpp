@@ -17,9 +17,9 @@ element_wheel::element_wheel() : element_texture(MOUSE_SCROLLWHEEL), m_mappings{
     /* NO-OP */
 }
 
-void element_wheel::load(ccl_config* cfg, const std::string &id)
+void element_wheel::load(const iolayout_element &e)
 {
-    element_texture::load(cfg, id);
+    element_texture::load(e);
     m_keycode = VC_MOUSE_WHEEL;
     auto i = 1;
     for (auto &map : m_mappings) {
@@ -29,22 +29,22 @@ void element_wheel::load(ccl_config* cfg, const std::string &id)
     }
 }
 
-void element_wheel::draw(gs_effect_t* effect, gs_image_file_t* image, element_data* data,
-                         sources::overlay_settings* settings)
+void element_wheel::draw(sprite_batch &batch, const element_data* data, sources::overlay_settings* settings,
+                         element_state &state) const
 {
     if (data) {
-        const auto wheel = dynamic_cast<element_data_wheel*>(data);
+        const auto wheel = data->get_wheel();
 
         if (wheel) {
             if (wheel->get_state() == STATE_PRESSED)
-                element_texture::draw(effect, image, &m_mappings[WHEEL_MAP_MIDDLE]);
+                element_texture::draw(batch, &m_mappings[WHEEL_MAP_MIDDLE]);
 
             switch (wheel->get_dir()) {
                 case WHEEL_DIR_UP:
-                    element_texture::draw(effect, image, &m_mappings[WHEEL_MAP_UP]);
+                    element_texture::draw(batch, &m_mappings[WHEEL_MAP_UP]);
                     break;
                 case WHEEL_DIR_DOWN:
-                    element_texture::draw(effect, image, &m_mappings[WHEEL_MAP_DOWN]);
+                    element_texture::draw(batch, &m_mappings[WHEEL_MAP_DOWN]);
                     break;
                 default:
                 case WHEEL_DIR_NONE:;
@@ -52,81 +52,10 @@ void element_wheel::draw(gs_effect_t* effect, gs_image_file_t* image, element_da
         }
     }
 
-    element_texture::draw(effect, image, data, settings);
+    element_texture::draw(batch, data, settings, state);
 }
 
 data_source element_wheel::get_source()
 {
     return DEFAULT;
 }
-
-element_data_wheel::element_data_wheel(const wheel_direction dir, const button_state state) : element_data_wheel(dir)
-{
-    m_data_type = WHEEL_BOTH;
-    m_middle_button = state;
-}
-
-element_data_wheel::element_data_wheel(const wheel_direction dir) : element_data(MOUSE_SCROLLWHEEL),
-                                                                    m_middle_button(STATE_RELEASED)
-{
-    m_data_type = WHEEL_STATE;
-    m_dir = dir;
-}
-
-element_data_wheel::element_data_wheel(const button_state state) : element_data(MOUSE_SCROLLWHEEL), m_dir()
-{
-    m_data_type = BUTTON_STATE;
-    m_middle_button = state;
-}
-
-
-wheel_direction element_data_wheel::get_dir() const
-{
-    return m_dir;
-}
-
-void element_data_wheel::set_dir(const wheel_direction dir)
-{
-    m_dir = dir;
-}
-
-button_state element_data_wheel::get_state() const
-{
-    return m_middle_button;
-}
-
-bool element_data_wheel::is_persistent()
-{
-    return true;
-}
-
-void element_data_wheel::merge(element_data* other)
-{
-    if (other && other->get_type() == m_type) {
-        const auto other_wheel = dynamic_cast<element_data_wheel*>(other);
-
-        if (other_wheel) {
-            /* After the merge this data contains both the scroll wheel state and the button state */
-            if (m_data_type != other_wheel->m_data_type)
-                m_data_type = WHEEL_BOTH;
-
-            switch (other_wheel->m_data_type) {
-                case BUTTON_STATE:
-                    m_middle_button = other_wheel->get_state();
-                    break;
-                case WHEEL_STATE:
-                    m_dir = other_wheel->get_dir();
-                    break;
-                case WHEEL_BOTH:
-                    m_dir = other_wheel->get_dir();
-                    m_middle_button = other_wheel->get_state();
-                default:;
-            }
-        }
-    }
-}
-
-wheel_data_type element_data_wheel::get_data_type() const
-{
-    return m_data_type;
-}
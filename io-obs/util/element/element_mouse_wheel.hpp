@@ -14,47 +14,15 @@
 #define WHEEL_MAP_UP      1
 #define WHEEL_MAP_DOWN    2
 
-enum wheel_data_type
-{
-    WHEEL_BOTH, BUTTON_STATE, WHEEL_STATE
-};
-
-class element_data_wheel : public element_data
-{
-public:
-    element_data_wheel(wheel_direction dir, button_state state);
-
-    explicit element_data_wheel(wheel_direction dir);
-
-    explicit element_data_wheel(button_state state);
-
-    wheel_direction get_dir() const;
-
-    void set_dir(wheel_direction dir);
-
-    button_state get_state() const;
-
-    bool is_persistent() override;
-
-    void merge(element_data* other) override;
-
-    wheel_data_type get_data_type() const;
-
-private:
-    wheel_data_type m_data_type;
-    button_state m_middle_button;
-    wheel_direction m_dir;
-};
-
 class element_wheel : public element_texture
 {
 public:
     element_wheel();
 
-    void load(ccl_config* cfg, const std::string &id) override;
+    void load(const iolayout_element &e) override;
 
-    void
-    draw(gs_effect_t* effect, gs_image_file_t* image, element_data* data, sources::overlay_settings* settings) override;
+    void draw(sprite_batch &batch, const element_data* data, sources::overlay_settings* settings,
+              element_state &state) const override;
 
     data_source get_source() override;
 
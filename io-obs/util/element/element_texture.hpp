@@ -16,16 +16,26 @@ public:
 
     explicit element_texture(element_type type);
 
-    void load(ccl_config* cfg, const std::string &id) override;
+    void load(const iolayout_element &e) override;
 
-    void
-    draw(gs_effect_t* effect, gs_image_file_t* image, element_data* data, sources::overlay_settings* settings) override;
+    void draw(sprite_batch &batch, const element_data* data, sources::overlay_settings* settings,
+              element_state &state) const override;
 
-    void draw(gs_effect_t* effect, gs_image_file_t* image, const gs_rect* rect) const;
+    void draw(sprite_batch &batch, const gs_rect* rect) const;
 
-    static void draw(gs_effect_t* effect, gs_image_file_t* image, const gs_rect* rect, const vec2* pos);
+    static void draw(sprite_batch &batch, const gs_rect* rect, const vec2* pos);
 
-    static void draw(gs_effect* effect, gs_image_file_t* image, const gs_rect* rect, const vec2* pos, float angle);
+    static void draw(sprite_batch &batch, const gs_rect* rect, const vec2* pos, float angle);
 
     data_source get_source() override;
+
+    /* Area of the texture at its position. Elements that move
+     * or rotate their texture can draw outside of it */
+    gs_rect get_bounds() const;
+
+    /* Part of the texture the element is drawn with */
+    const gs_rect &get_mapping() const
+    {
+        return m_mapping;
+    }
 };
@@ -0,0 +1,275 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "file_watcher.hpp"
+#include "trace.hpp"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <sys/stat.h>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <climits>
+#include <cstdlib>
+#endif
+
+#ifdef LINUX
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+/* How often files are checked without inotify and
+ * how long the inotify wait is, both in ms */
+#define WATCH_POLL_INTERVAL 500
+
+namespace file_watcher
+{
+    struct watched_file
+    {
+        std::string dir;
+        uint64_t mtime = 0, size = 0;   /* Only used for polling */
+        std::vector<std::weak_ptr<listener>> listeners;
+    };
+
+    static std::mutex mutex;    /* Guards files, dirs and the thread */
+    static std::map<std::string, watched_file> files;
+    static std::thread thread;
+    static std::atomic<bool> running(false);
+
+#ifdef LINUX
+    static int inotify_fd = -1;
+    static std::map<int, std::string> dirs; /* Watched directories by watch descriptor */
+
+    static int find_dir(const std::string &dir)
+    {
+        for (const auto &d : dirs) {
+            if (d.second == dir)
+                return d.first;
+        }
+        return -1;
+    }
+#endif
+
+    bool stat_file(const std::string &path, uint64_t &mtime, uint64_t &size)
+    {
+        struct stat st{};
+        if (path.empty() || os_stat(path.c_str(), &st) != 0)
+            return false;
+
+#if defined(LINUX)
+        mtime = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000ull + st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+        mtime = static_cast<uint64_t>(st.st_mtimespec.tv_sec) * 1000000000ull + st.st_mtimespec.tv_nsec;
+#else
+        mtime = static_cast<uint64_t>(st.st_mtime) * 1000000000ull;
+#endif
+        size = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+
+    std::string absolute_path(const std::string &path)
+    {
+        const auto abs_path = os_get_abs_path_ptr(path.c_str());
+        std::string result = abs_path ? abs_path : path;
+        bfree(abs_path);
+        return result;
+    }
+
+    std::string canonical_path(const std::string &path)
+    {
+#ifdef _WIN32
+        /* The long name also has the case of the names on disk */
+        char full[MAX_PATH], canonical[MAX_PATH];
+        const auto length = GetFullPathNameA(path.c_str(), MAX_PATH, full, nullptr);
+        if (length > 0 && length < MAX_PATH) {
+            const auto long_length = GetLongPathNameA(full, canonical, MAX_PATH);
+            if (long_length > 0 && long_length < MAX_PATH)
+                return canonical;
+        }
+#else
+        char canonical[PATH_MAX];
+        if (realpath(path.c_str(), canonical))
+            return canonical;
+#endif
+        return absolute_path(path);
+    }
+
+    /* Sets the flag of all listeners of file, false if none are left. Needs mutex */
+    static bool notify(watched_file &file)
+    {
+        auto &listeners = file.listeners;
+        for (auto it = listeners.begin(); it != listeners.end();) {
+            const auto l = it->lock();
+            if (l) {
+                l->changed = true;
+                ++it;
+            } else {
+                it = listeners.erase(it);
+            }
+        }
+        return !listeners.empty();
+    }
+
+    /* Drops files without listeners. Needs mutex */
+    static void prune()
+    {
+        for (auto it = files.begin(); it != files.end();) {
+            auto &listeners = it->second.listeners;
+            for (auto l = listeners.begin(); l != listeners.end();) {
+                if (l->expired())
+                    l = listeners.erase(l);
+                else
+                    ++l;
+            }
+
+            if (listeners.empty()) {
+#ifdef LINUX
+                const auto dir = it->second.dir;
+                it = files.erase(it);
+
+                auto used = false;
+                for (const auto &f : files)
+                    used |= f.second.dir == dir;
+
+                const auto wd = find_dir(dir);
+                if (!used && wd >= 0) {
+                    inotify_rm_watch(inotify_fd, wd);
+                    dirs.erase(wd);
+                }
+#else
+                it = files.erase(it);
+#endif
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    static void poll_files()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &file : files) {
+            uint64_t mtime = 0, size = 0;
+            if (!stat_file(file.first, mtime, size))
+                continue; /* Replaced files are missing for a moment */
+
+            if (mtime != file.second.mtime || size != file.second.size) {
+                file.second.mtime = mtime;
+                file.second.size = size;
+                notify(file.second);
+            }
+        }
+        prune();
+    }
+
+#ifdef LINUX
+    static void read_events()
+    {
+        pollfd fd{inotify_fd, POLLIN, 0};
+        if (poll(&fd, 1, WATCH_POLL_INTERVAL) <= 0) {
+            /* Unused files are also dropped while nothing changes */
+            std::lock_guard<std::mutex> lock(mutex);
+            prune();
+            return;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        const auto length = read(inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto ptr = buffer; ptr < buffer + length;) {
+            const auto event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            const auto dir = dirs.find(event->wd);
+            if (dir == dirs.end() || !event->len)
+                continue;
+
+            const auto file = files.find(dir->second + "/" + event->name);
+            if (file != files.end())
+                notify(file->second);
+        }
+        prune();
+    }
+#endif
+
+    static void watcher_proc()
+    {
+        trace::set_thread_name("file watcher");
+        while (running) {
+#ifdef LINUX
+            if (inotify_fd >= 0) {
+                read_events();
+                continue;
+            }
+#endif
+            os_sleep_ms(WATCH_POLL_INTERVAL);
+            poll_files();
+        }
+    }
+
+    void watch(const std::string &path, const std::shared_ptr<listener> &l)
+    {
+        if (path.empty())
+            return;
+
+        const auto abs_path = absolute_path(path);
+        const auto separator = abs_path.find_last_of("/\\");
+        const auto dir = separator == std::string::npos ? std::string(".") : abs_path.substr(0, separator);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &file = files[abs_path];
+        file.dir = dir;
+        file.listeners.emplace_back(l);
+        stat_file(abs_path, file.mtime, file.size);
+
+#ifdef LINUX
+        if (inotify_fd < 0 && !running)
+            inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (inotify_fd >= 0 && find_dir(dir) < 0) {
+            /* Editors often save by replacing the file, so its directory is watched */
+            const auto wd = inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (wd >= 0)
+                dirs[wd] = dir;
+            else
+                blog(LOG_WARNING, "[input-overlay] Couldn't watch %s for changes", dir.c_str());
+        }
+#endif
+
+        if (!running) {
+            if (thread.joinable())
+                thread.join();
+            running = true;
+            thread = std::thread(watcher_proc);
+        }
+    }
+
+    void stop()
+    {
+        running = false;
+        if (thread.joinable())
+            thread.join();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        files.clear();
+#ifdef LINUX
+        dirs.clear();
+        if (inotify_fd >= 0)
+            close(inotify_fd);
+        inotify_fd = -1;
+#endif
+    }
+}
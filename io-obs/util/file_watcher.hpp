@@ -0,0 +1,40 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <stdint.h>
+
+/* One thread watching layout and texture files for all sources. Uses
+ * inotify on linux and checks modification times everywhere else */
+namespace file_watcher
+{
+    /* Set once any of the files it was added for changed. The
+     * watcher only keeps weak references, dropping it stops watching */
+    struct listener
+    {
+        std::atomic<bool> changed{false};
+    };
+
+    /* Modification time in ns and size of the file, false if it doesn't exist */
+    bool stat_file(const std::string &path, uint64_t &mtime, uint64_t &size);
+
+    /* Absolute path of the file, the path itself if it can't be resolved */
+    std::string absolute_path(const std::string &path);
+
+    /* Absolute path with links, "." and ".." resolved, so every way of naming
+     * a file gives the same string. absolute_path() if the file doesn't exist */
+    std::string canonical_path(const std::string &path);
+
+    void watch(const std::string &path, const std::shared_ptr<listener> &l);
+
+    /* Ends the thread, call this before the module is unloaded */
+    void stop();
+}
@@ -0,0 +1,126 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "frame_scheduler.hpp"
+#include "element/element_data_holder.hpp"
+#include "../hook/hook_helper.hpp"
+#include "../network/io_server.hpp"
+#include "../network/remote_connection.hpp"
+#include "recording/recorder.hpp"
+#include "recording/replay.hpp"
+#include "latency_stats.hpp"
+#include "trace.hpp"
+#include <util/platform.h>
+#include <vector>
+
+namespace frame_scheduler
+{
+    static const input_state* local_state = nullptr;
+    /* Remote clients can disconnect at any time,
+     * so their snapshots are copied */
+    static std::vector<input_state> remote_states;
+    static size_t remote_count = 0;
+    static uint64_t frames = 0;
+    timer_wheel timers(1000 * 1000); /* 1ms resolution */
+
+    /* Ingest time of the newest input each data source had and
+     * when it was snapshotted, to time the following stages */
+    struct source_timing
+    {
+        uint64_t ingest = 0;
+        uint64_t snapshot = 0;
+        bool pending = false;   /* Not rendered yet in this frame */
+    };
+
+    static std::vector<source_timing> timings;
+
+    static latency_stats::origin source_origin(const uint8_t source)
+    {
+        return source == 0 ? latency_stats::ORIGIN_LOCAL : latency_stats::ORIGIN_REMOTE;
+    }
+
+    static void track(const uint8_t source, const input_state &state, const uint64_t now)
+    {
+        if (timings.size() <= source)
+            timings.resize(source + 1u);
+
+        auto &timing = timings[source];
+        if (state.get_ingest_time() == timing.ingest)
+            return;
+
+        timing.ingest = state.get_ingest_time();
+        timing.snapshot = now;
+        timing.pending = true;
+        latency_stats::record(source_origin(source), latency_stats::STAGE_INGEST_SNAPSHOT, timing.ingest, now);
+    }
+
+    void tick_proc(void* data, const float seconds)
+    {
+        UNUSED_PARAMETER(data);
+        trace::set_thread_name("graphics");
+        TRACE_SCOPE("frame_scheduler::tick");
+        frames++;
+
+        /* Input that no source drew in its frame (hidden sources)
+         * isn't timed, it would only measure how long it was hidden */
+        for (auto &timing : timings)
+            timing.pending = false;
+
+        {
+            PROFILED_LOCK(lock, hook::mutex);
+            if (hook::input_data) {
+                hook::drain_events();
+                if (recorder::active() && recorder::keyframe_due(LOG_SOURCE_LOCAL))
+                    recorder::record_keyframe(LOG_SOURCE_LOCAL, *hook::input_data);
+            }
+            replay::tick(seconds);
+            timers.advance(os_gettime_ns());
+        }
+        local_state = hook::input_data ? &hook::input_data->snapshot() : nullptr;
+        const auto now = os_gettime_ns();
+        if (local_state)
+            track(0, *local_state, now);
+
+        remote_count = 0;
+        if (network::network_flag && network::server_instance) {
+            PROFILED_LOCK(lock, network::mutex);
+            remote_count = network::server_instance->client_count();
+            trace::counter("remote clients", static_cast<int64_t>(remote_count));
+
+            if (remote_states.size() < remote_count)
+                remote_states.resize(remote_count);
+
+            for (size_t i = 0; i < remote_count; i++) {
+                remote_states[i] = network::server_instance->get_client(i)->get_data()->snapshot();
+                track(static_cast<uint8_t>(i + 1), remote_states[i], now);
+            }
+        }
+    }
+
+    void source_rendered(const uint8_t source)
+    {
+        if (source < timings.size() && timings[source].pending) {
+            timings[source].pending = false;
+            latency_stats::record(source_origin(source), latency_stats::STAGE_SNAPSHOT_RENDER,
+                                  timings[source].snapshot, os_gettime_ns());
+        }
+    }
+
+    const input_state* get_state(const uint8_t source)
+    {
+        if (source == 0)
+            return local_state;
+        if (source - 1u < remote_count)
+            return &remote_states[source - 1];
+        return nullptr;
+    }
+
+    uint64_t frame_count()
+    {
+        return frames;
+    }
+}
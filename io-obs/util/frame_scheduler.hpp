@@ -0,0 +1,45 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include "util.hpp"
+#include <stdint.h>
+
+class input_state;
+
+/* Takes one snapshot of every input data source per video frame,
+ * which all overlay and history sources then share. The tick callback
+ * runs on the graphics thread before any source is ticked
+ */
+namespace frame_scheduler
+{
+    /* Registered as obs tick callback */
+    void tick_proc(void* data, float seconds);
+
+    /* State of a data source in the current frame. 0 is local
+     * input, everything above is a remote client (index + 1).
+     * nullptr if the source doesn't exist. Graphics thread only
+     */
+    const input_state* get_state(uint8_t source);
+
+    /* Number of frames that have been scheduled so far */
+    uint64_t frame_count();
+
+    /* Called by overlay sources when they drew the state of a data source. The
+     * first call per frame after new input arrived is timed as the
+     * snapshot to render latency. Graphics thread only
+     */
+    void source_rendered(uint8_t source);
+
+    /* Deadlines for input states that decay over time (wheel release,
+     * history auto clear). Deadlines are in os_gettime_ns() time and
+     * fire once per frame on the graphics thread. Guarded by hook::mutex,
+     * which is also held while the timer procs run
+     */
+    extern timer_wheel timers;
+}
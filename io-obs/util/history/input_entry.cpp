@@ -11,7 +11,7 @@
 #include "../element/element_data_holder.hpp"
 #include "key_names.hpp"
 #include "history_icons.hpp"
-#include "network/io_server.hpp"
+#include "../frame_scheduler.hpp"
 #include <algorithm>
 #include <sstream>
 
@@ -65,14 +65,9 @@ void input_entry::set_text(const char* text, obs_data_t* settings)
 
 void input_entry::collect_inputs(sources::history_settings* settings)
 {
-    if (settings->data) {
-        std::lock_guard<std::mutex> lck1(hook::mutex);
-        std::lock_guard<std::mutex> lck2(network::mutex);
-        if (settings->flags & FLAG_GAMEPAD)
-            std::lock_guard<std::mutex> lck3(gamepad::mutex);
-
-        settings->data->populate_vector(m_inputs, settings);
-    }
+    const auto state = frame_scheduler::get_state(settings->selected_source);
+    if (state)
+        state->populate_vector(m_inputs, settings);
 }
 
 std::string input_entry::build_string(key_names* names, const bool use_fallback)
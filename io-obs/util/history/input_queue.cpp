@@ -9,6 +9,7 @@
 #include "sources/input_history.hpp"
 #include "icon_handler.hpp"
 #include "text_handler.hpp"
+#include "util/trace.hpp"
 
 void input_queue::init_icon()
 {
@@ -67,16 +68,19 @@ void input_queue::collect_input()
     m_queued_entry.collect_inputs(m_settings);
 }
 
-void input_queue::swap()
+bool input_queue::swap()
 {
     if (!m_queued_entry.empty() && m_current_handler) {
         m_current_handler->swap(m_queued_entry);
         m_queued_entry.clear();
+        return true;
     }
+    return false;
 }
 
 void input_queue::tick(const float seconds)
 {
+    TRACE_SCOPE("input_queue::tick");
     m_handler_mutex.lock();
     if (m_current_handler)
         m_current_handler->tick(seconds);
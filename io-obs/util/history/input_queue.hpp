@@ -38,7 +38,7 @@ public:
     obs_source_t* get_fade_in() const;
 
     void collect_input(); /* Accumulates input events in current entry */
-    void swap(); /* Adds current entry to the list */
+    bool swap(); /* Adds current entry to the list, false if it was empty */
     void tick(float seconds);
 
     void update(sources::history_mode new_mode);
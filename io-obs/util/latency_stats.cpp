@@ -0,0 +1,206 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "latency_stats.hpp"
+#include <obs-module.h>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline int highest_bit(const uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+int latency_histogram::bucket(const uint64_t us)
+{
+    if (us < LATENCY_LINEAR_BUCKETS)
+        return static_cast<int>(us);
+
+    const auto bit = highest_bit(us);
+    if (bit >= LATENCY_MAX_BITS)
+        return LATENCY_BUCKETS - 1;
+
+    /* The bits below the highest one pick the sub bucket */
+    const auto shift = bit - LATENCY_SUB_BITS;
+    return LATENCY_LINEAR_BUCKETS + (bit - LATENCY_SUB_BITS - 1) * LATENCY_SUB_BUCKETS +
+           static_cast<int>((us >> shift) - LATENCY_SUB_BUCKETS);
+}
+
+uint64_t latency_histogram::bucket_limit(const int bucket)
+{
+    if (bucket < LATENCY_LINEAR_BUCKETS)
+        return static_cast<uint64_t>(bucket);
+
+    const auto index = bucket - LATENCY_LINEAR_BUCKETS;
+    const auto shift = index / LATENCY_SUB_BUCKETS + 1;
+    const auto lower = static_cast<uint64_t>(index % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS) << shift;
+    return lower + (1ull << shift) - 1;
+}
+
+void latency_histogram::record(const uint64_t ns)
+{
+    const auto us = ns / 1000;
+    m_buckets[bucket(us)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(us, std::memory_order_relaxed);
+
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void latency_histogram::reset()
+{
+    for (auto &b : m_buckets)
+        b.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t latency_histogram::percentile(const double p) const
+{
+    const auto total = count();
+    if (total == 0)
+        return 0;
+
+    auto rank = static_cast<uint64_t>(std::ceil(p * total));
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            /* The bucket limit can be above the highest sample */
+            const auto limit = (bucket_limit(i) + 1) * 1000;
+            return limit < max() ? limit : max();
+        }
+    }
+    return max();
+}
+
+uint64_t latency_histogram::mean() const
+{
+    const auto total = count();
+    return total ? m_sum.load(std::memory_order_relaxed) * 1000 / total : 0;
+}
+
+namespace latency_stats
+{
+    /* Two sets, recording uses the current one and counts itself in
+     * writers while doing so. reset() switches sets and waits for the
+     * count of the old one to drop to zero before clearing it */
+    static latency_histogram histograms[2][ORIGIN_COUNT][STAGE_COUNT];
+    static std::atomic<int> current(0);
+    static std::atomic<uint32_t> writers[2];
+    static std::mutex reset_mutex;
+
+    void record(const origin o, const stage s, const uint64_t start, const uint64_t end)
+    {
+        int set;
+        for (;;) {
+            set = current.load();
+            writers[set].fetch_add(1);
+            /* Switched in between, reset() might not have seen us */
+            if (current.load() == set)
+                break;
+            writers[set].fetch_sub(1);
+        }
+
+        histograms[set][o][s].record(end > start ? end - start : 0);
+        writers[set].fetch_sub(1, std::memory_order_release);
+    }
+
+    latency_histogram &get(const origin o, const stage s)
+    {
+        return histograms[current.load(std::memory_order_relaxed)][o][s];
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(reset_mutex);
+        const auto old = current.load();
+        current.store(old ^ 1);
+
+        while (writers[old].load(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        for (auto &o : histograms[old]) {
+            for (auto &h : o)
+                h.reset();
+        }
+    }
+
+    const char* origin_name(const origin o)
+    {
+        return o == ORIGIN_LOCAL ? "local" : "remote";
+    }
+
+    const char* stage_name(const stage s)
+    {
+        switch (s) {
+            case STAGE_CAPTURE_INGEST:
+                return "capture->ingest";
+            case STAGE_INGEST_SNAPSHOT:
+                return "ingest->snapshot";
+            case STAGE_SNAPSHOT_RENDER:
+                return "snapshot->render";
+            default:
+                return "";
+        }
+    }
+
+    std::string summary()
+    {
+        std::string text;
+        char line[256];
+
+        for (int o = 0; o < ORIGIN_COUNT; o++) {
+            for (int s = 0; s < STAGE_COUNT; s++) {
+                const auto &h = get(origin(o), stage(s));
+                if (!h.count())
+                    continue;
+
+                snprintf(line, sizeof(line), "%-6s %-16s %8llu samples  p50 %8.3f ms  p99 %8.3f ms  "
+                         "p99.9 %8.3f ms  max %8.3f ms\n", origin_name(origin(o)), stage_name(stage(s)),
+                         static_cast<unsigned long long>(h.count()), h.percentile(0.5) / 1e6,
+                         h.percentile(0.99) / 1e6, h.percentile(0.999) / 1e6, h.max() / 1e6);
+                text += line;
+            }
+        }
+        return text;
+    }
+
+    void log()
+    {
+        const auto text = summary();
+        if (text.empty()) {
+            blog(LOG_INFO, "[input-overlay] Latency: no input recorded");
+            return;
+        }
+
+        blog(LOG_INFO, "[input-overlay] Latency per stage:");
+        size_t start = 0, end;
+        while ((end = text.find('\n', start)) != std::string::npos) {
+            blog(LOG_INFO, "[input-overlay]   %s", text.substr(start, end - start).c_str());
+            start = end + 1;
+        }
+    }
+}
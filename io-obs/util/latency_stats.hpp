@@ -0,0 +1,115 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+/* Buckets per power of two, values are at most ~6% above their sample */
+#define LATENCY_SUB_BITS        4
+#define LATENCY_SUB_BUCKETS     (1 << LATENCY_SUB_BITS)
+/* Values below this (in microseconds) get one bucket each */
+#define LATENCY_LINEAR_BUCKETS  (2 * LATENCY_SUB_BUCKETS)
+/* Highest power of two covered, 2^26 us is about a minute */
+#define LATENCY_MAX_BITS        26
+#define LATENCY_BUCKETS         (LATENCY_LINEAR_BUCKETS + \
+                                 (LATENCY_MAX_BITS - LATENCY_SUB_BITS - 1) * LATENCY_SUB_BUCKETS)
+
+/* HDR style histogram with fixed log-linear buckets. Recording is a
+ * few relaxed atomic adds and never allocates or locks, so it can be
+ * called from any input thread. Readers may see a sample that's only
+ * partially counted, which doesn't matter for the percentiles
+ */
+class latency_histogram
+{
+public:
+    latency_histogram()
+    {
+        reset();
+    }
+
+    latency_histogram(const latency_histogram &) = delete;
+
+    latency_histogram &operator=(const latency_histogram &) = delete;
+
+    void record(uint64_t ns);
+
+    /* Nobody may record while this runs, or the counters won't add up */
+    void reset();
+
+    uint64_t count() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    /* Upper bound of the bucket holding the given
+     * fraction (0 - 1) of all samples, in ns */
+    uint64_t percentile(double p) const;
+
+    uint64_t mean() const;
+
+    uint64_t max() const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    static int bucket(uint64_t us);
+
+    /* Highest value in microseconds that falls into a bucket */
+    static uint64_t bucket_limit(int bucket);
+
+private:
+    std::atomic<uint64_t> m_buckets[LATENCY_BUCKETS];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;    /* In us */
+    std::atomic<uint64_t> m_max;    /* In ns */
+};
+
+/* Latency of input between the stages it passes. Every event carries
+ * its capture time (uiohook, kernel or io-client time) which input_state
+ * keeps along with the time it was applied, so each stage can be timed
+ * where it hands data to the next one
+ */
+namespace latency_stats
+{
+    enum origin
+    {
+        ORIGIN_LOCAL,   /* uiohook, evdev and gamepad hooks */
+        ORIGIN_REMOTE,  /* io-client connections */
+        ORIGIN_COUNT
+    };
+
+    enum stage
+    {
+        STAGE_CAPTURE_INGEST,   /* Captured until applied to the input data */
+        STAGE_INGEST_SNAPSHOT,  /* Applied until the frame scheduler took a snapshot with it */
+        STAGE_SNAPSHOT_RENDER,  /* Snapshot until the first source rendered it */
+        STAGE_COUNT
+    };
+
+    /* Records end - start, samples with end before start (clock
+     * differences between client and server) are counted as zero */
+    void record(origin o, stage s, uint64_t start, uint64_t end);
+
+    latency_histogram &get(origin o, stage s);
+
+    /* Recording goes on in a cleared set of histograms,
+     * the old one is cleared once nothing records into it */
+    void reset();
+
+    const char* origin_name(origin o);
+
+    const char* stage_name(stage s);
+
+    /* One line per stage with samples, for the settings dialog */
+    std::string summary();
+
+    /* Writes the summary to the obs log */
+    void log();
+}
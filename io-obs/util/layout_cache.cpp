@@ -0,0 +1,625 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "../../ccl/ccl.hpp"
+#include "layout_cache.hpp"
+#include "layout_constants.hpp"
+#include "layout_format.hpp"
+#include "element/element_analog_stick.hpp"
+#include "element/element_button.hpp"
+#include "element/element_dpad.hpp"
+#include "element/element_gamepad_id.hpp"
+#include "element/element_mouse_movement.hpp"
+#include "element/element_mouse_wheel.hpp"
+#include "element/element_texture.hpp"
+#include "element/element_trigger.hpp"
+#include "trace.hpp"
+#include "file_watcher.hpp"
+#include <obs-module.h>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <util/platform.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Read only view of a whole file */
+class mapped_file
+{
+public:
+    explicit mapped_file(const std::string &path)
+    {
+#ifdef _WIN32
+        wchar_t* wpath = nullptr;
+        os_utf8_to_wcs_ptr(path.c_str(), 0, &wpath);
+        const auto file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL, nullptr);
+        bfree(wpath);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                m_size = m_data ? static_cast<size_t>(size.QuadPart) : 0;
+                CloseHandle(mapping); /* The view keeps the mapping open */
+            }
+        }
+        CloseHandle(file);
+#else
+        const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            const auto data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                m_data = static_cast<const uint8_t*>(data);
+                m_size = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd); /* The mapping stays valid */
+#endif
+    }
+
+    ~mapped_file()
+    {
+        if (!m_data)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    }
+
+    mapped_file(const mapped_file &) = delete;
+
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    const uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+static bool is_compiled(const std::string &path)
+{
+    const auto length = strlen(IOLAYOUT_EXTENSION);
+    return path.size() > length && path.compare(path.size() - length, length, IOLAYOUT_EXTENSION) == 0;
+}
+
+std::unique_ptr<layout> layout::load(const std::string &path)
+{
+    if (is_compiled(path))
+        return load_compiled(path);
+
+    std::unique_ptr<layout> result(new layout);
+    const std::unique_ptr<ccl_config> cfg(new ccl_config(path, ""));
+
+    if (!cfg->has_fatal_errors()) {
+        result->cx = static_cast<uint32_t>(cfg->get_int(CFG_TOTAL_WIDTH, true));
+        result->cy = static_cast<uint32_t>(cfg->get_int(CFG_TOTAL_HEIGHT, true));
+        result->flags = cfg->get_int(CFG_FLAGS, true);
+
+        auto element_id = cfg->get_string(CFG_FIRST_ID);
+        const auto debug_mode = cfg->get_bool(CFG_DEBUG_FLAG, true);
+
+#ifndef _DEBUG
+        if (debug_mode)
+        {
+#else
+        {
+#endif
+            blog(LOG_INFO, "[input-overlay] Started loading of %s", path.c_str());
+        }
+
+        while (!element_id.empty()) {
+            const auto type = static_cast<element_type>(cfg->get_int(element_id + CFG_TYPE));
+            result->add_element(read_element(cfg.get(), element_id, type), element_id, debug_mode);
+            element_id = cfg->get_string(element_id + CFG_NEXT_ID, true);
+        }
+        result->bind_slots();
+    }
+
+    if (cfg->has_errors()) {
+        blog(LOG_WARNING, "[input-overlay] %s", cfg->get_error_message().c_str());
+        if (cfg->has_fatal_errors()) {
+            blog(LOG_WARNING, "[input-overlay] Fatal errors occured while loading config file");
+            return nullptr;
+        }
+    }
+    return result;
+}
+
+std::unique_ptr<layout> layout::load_compiled(const std::string &path)
+{
+    const mapped_file file(path);
+    if (!file.data()) {
+        blog(LOG_WARNING, "[input-overlay] Couldn't open layout %s", path.c_str());
+        return nullptr;
+    }
+
+    /* Records are copied out, the file doesn't have to be aligned */
+    iolayout_header header{};
+    if (file.size() >= sizeof(header))
+        memcpy(&header, file.data(), sizeof(header));
+
+    if (memcmp(header.magic, IOLAYOUT_MAGIC, IOLAYOUT_MAGIC_SIZE) != 0 || header.version != IOLAYOUT_VERSION) {
+        blog(LOG_WARNING, "[input-overlay] %s isn't a compiled layout of version %i", path.c_str(),
+             IOLAYOUT_VERSION);
+        return nullptr;
+    }
+
+    const auto elements_end = uint64_t(header.elements_offset) + uint64_t(header.element_count) *
+                                                                 sizeof(iolayout_element);
+    const auto atlas_end = uint64_t(header.atlas_offset) + header.atlas_length;
+    if (elements_end > file.size() || atlas_end > file.size()) {
+        blog(LOG_WARNING, "[input-overlay] Compiled layout %s is truncated", path.c_str());
+        return nullptr;
+    }
+
+    std::unique_ptr<layout> result(new layout);
+    result->cx = header.cx;
+    result->cy = header.cy;
+    result->flags = static_cast<uint8_t>(header.flags);
+
+    if (header.atlas_length) {
+        const auto separator = path.find_last_of("/\\");
+        result->atlas = separator == std::string::npos ? std::string() : path.substr(0, separator + 1);
+        result->atlas.append(reinterpret_cast<const char*>(file.data() + header.atlas_offset), header.atlas_length);
+    }
+
+    const std::string no_id;
+    const auto records = file.data() + header.elements_offset;
+    result->elements.reserve(header.element_count);
+    for (uint32_t i = 0; i < header.element_count; i++) {
+        iolayout_element e{};
+        memcpy(&e, records + i * sizeof(iolayout_element), sizeof(e));
+        result->add_element(e, no_id, false);
+    }
+    result->bind_slots();
+    return result;
+}
+
+element_data layout::idle_data(const element_type t)
+{
+    switch (t) {
+        case GAMEPAD_ID: /* Acts just like a button */
+        case BUTTON:
+            return element_data_button(STATE_RELEASED);
+        case MOUSE_SCROLLWHEEL:
+            return element_data_wheel(STATE_RELEASED);
+        case TRIGGER:
+            return element_data_trigger(0.f, 0.f);
+        case ANALOG_STICK:
+            return element_data_analog_stick(STATE_RELEASED, STATE_RELEASED, 0.f, 0.f, 0.f, 0.f);
+        case DPAD_STICK:
+            return element_data_dpad(DPAD_LEFT, STATE_RELEASED);
+        case MOUSE_STATS:
+            return element_data_mouse_stats(0, 0);
+        default:
+            return element_data();
+    }
+}
+
+void layout::bind_slots()
+{
+    const auto find_slot = [this](const uint16_t keycode)
+    {
+        for (size_t i = 0; i < data_keycodes.size(); i++) {
+            if (data_keycodes[i] == keycode)
+                return static_cast<int32_t>(i);
+        }
+        return -1;
+    };
+
+    /* Only elements with data get a slot, but every element with the
+     * same keycode uses it, like they did with the old keycode lookups */
+    for (auto const &element : elements) {
+        if (!idle_data(element->get_type()).is_empty() && find_slot(element->get_keycode()) < 0)
+            data_keycodes.emplace_back(element->get_keycode());
+    }
+
+    bindings.reserve(elements.size());
+    data_types.assign(data_keycodes.size(), INVALID);
+    for (auto const &element : elements) {
+        element_binding binding{};
+        binding.keycode = element->get_keycode();
+        binding.slot = find_slot(binding.keycode);
+        binding.gamepad = element->get_source() == GAMEPAD;
+        bindings.emplace_back(binding);
+
+        /* The last element of a keycode decides its data */
+        const auto data = idle_data(element->get_type());
+        if (binding.slot >= 0 && !data.is_empty())
+            data_types[binding.slot] = data.get_type();
+    }
+}
+
+static bool overlaps(const gs_rect &a, const gs_rect &b)
+{
+    return a.x < b.x + b.cx && b.x < a.x + a.cx && a.y < b.y + b.cy && b.y < a.y + a.cy;
+}
+
+static uint8_t alpha_at(const layout_texture &texture, const int32_t x, const int32_t y)
+{
+    const auto cx = static_cast<int32_t>(texture.image.cx), cy = static_cast<int32_t>(texture.image.cy);
+    if (x < 0 || y < 0 || x >= cx || y >= cy)
+        return 0;
+    return texture.alpha[static_cast<size_t>(y) * cx + x];
+}
+
+/* Whether the pressed look can be drawn over the released one baked into the
+ * background. That only works if it's nowhere more transparent than the
+ * released look, which would otherwise shine through */
+static bool hides_released(const layout_texture &texture, const gs_rect &released, const gs_rect &pressed)
+{
+    if (texture.alpha.empty())
+        return false;
+
+    for (int32_t y = 0; y < released.cy; y++) {
+        for (int32_t x = 0; x < released.cx; x++) {
+            if (alpha_at(texture, pressed.x + x, pressed.y + y) < alpha_at(texture, released.x + x, released.y + y))
+                return false;
+        }
+    }
+    return true;
+}
+
+std::vector<element_layer> layout::assign_layers(const layout_texture &texture) const
+{
+    /* The background ends up below everything else, so an element only goes into
+     * it if nothing that's drawn before it on top of the background can cover it.
+     * Elements other than textures and buttons move or change their size, they
+     * could cover anything */
+    std::vector<element_layer> layers(elements.size(), LAYER_INPUT);
+    std::vector<gs_rect> covered;
+    auto covered_all = false;
+
+    for (size_t i = 0; i < elements.size(); i++) {
+        const auto type = elements[i]->get_type();
+        const auto &binding = bindings[i];
+
+        if (type != TEXTURE && (type != BUTTON || data_types[binding.slot] != BUTTON)) {
+            covered_all = true;
+            continue;
+        }
+
+        const auto element = static_cast<const element_texture*>(elements[i].get());
+        const auto bounds = element->get_bounds();
+        auto free = !covered_all;
+        if (free && type == BUTTON) {
+            const auto button = static_cast<const element_button*>(element);
+            free = hides_released(texture, button->get_mapping(), button->get_pressed_mapping());
+        }
+        for (size_t j = 0; free && j < covered.size(); j++)
+            free = !overlaps(covered[j], bounds);
+
+        if (free)
+            layers[i] = type == TEXTURE ? LAYER_BACKGROUND : LAYER_RELEASED;
+        if (layers[i] != LAYER_BACKGROUND)
+            covered.emplace_back(bounds);
+    }
+    return layers;
+}
+
+iolayout_element layout::read_element(ccl_config* cfg, const std::string &id, const element_type type)
+{
+    iolayout_element e{};
+    e.type = static_cast<int8_t>(type);
+    if (type < TEXTURE || type > DPAD_STICK)
+        return e; /* Skipped by add_element() */
+
+    const auto pos = cfg->get_point(id + CFG_POS);
+    const auto mapping = cfg->get_rect(id + CFG_MAPPING);
+    e.x = pos.x;
+    e.y = pos.y;
+    e.u = mapping.x;
+    e.v = mapping.y;
+    e.w = mapping.w;
+    e.h = mapping.h;
+
+    switch (type) {
+        case BUTTON:
+            e.keycode = static_cast<uint16_t>(cfg->get_int(id + CFG_KEY_CODE));
+            break;
+        case ANALOG_STICK:
+            e.side = static_cast<int8_t>(cfg->get_int(id + CFG_SIDE));
+            e.radius = static_cast<uint16_t>(cfg->get_int(id + CFG_STICK_RADIUS));
+            break;
+        case TRIGGER:
+            e.trigger_mode = cfg->get_bool(id + CFG_TRIGGER_MODE);
+            e.side = static_cast<int8_t>(cfg->get_int(id + CFG_SIDE));
+            if (!e.trigger_mode)
+                e.direction = static_cast<uint8_t>(cfg->get_int(id + CFG_DIRECTION));
+            break;
+        case MOUSE_STATS:
+            e.radius = static_cast<uint16_t>(cfg->get_int(id + CFG_MOUSE_RADIUS));
+            e.mouse_type = static_cast<uint8_t>(cfg->get_int(id + CFG_MOUSE_TYPE));
+            break;
+        default:;
+    }
+    return e;
+}
+
+void layout::add_element(const iolayout_element &e, const std::string &id, const bool debug)
+{
+    const auto type = e.type;
+    element* new_element = nullptr;
+
+    switch (type) {
+        case TEXTURE:
+            new_element = new element_texture();
+            break;
+        case BUTTON:
+            new_element = new element_button();
+            break;
+        case MOUSE_SCROLLWHEEL:
+            new_element = new element_wheel();
+            break;
+        case TRIGGER:
+            new_element = new element_trigger();
+            break;
+        case ANALOG_STICK:
+            new_element = new element_analog_stick();
+            break;
+        case GAMEPAD_ID:
+            new_element = new element_gamepad_id();
+            break;
+        case DPAD_STICK:
+            new_element = new element_dpad();
+            break;
+        case MOUSE_STATS:
+            new_element = new element_mouse_movement();
+            break;
+        default:
+            if (debug)
+                blog(LOG_INFO, "[input-overlay] Invalid element type %i for %s", type, id.c_str());
+    }
+
+    if (new_element) {
+        new_element->load(e);
+        elements.emplace_back(new_element);
+
+#ifndef _DEBUG
+        if (debug) {
+#else
+        {
+#endif
+            blog(LOG_INFO, "[input-overlay]  Type: %14s, KEYCODE: 0x%04X ID: %s",
+                 element_type_to_string(static_cast<element_type>(type)), new_element->get_keycode(), id.c_str());
+        }
+    }
+}
+
+const char* layout::element_type_to_string(const element_type t)
+{
+    switch (t) {
+        case TEXTURE:
+            return "Texture";
+        case BUTTON:
+            return "Button";
+        case ANALOG_STICK:
+            return "Analog stick";
+        case MOUSE_SCROLLWHEEL:
+            return "Scroll wheel";
+        case MOUSE_STATS:
+            return "Mouse movement";
+        case TRIGGER:
+            return "Trigger";
+        case GAMEPAD_ID:
+            return "Gamepad ID";
+        case DPAD_STICK:
+            return "DPad";
+        default:
+        case INVALID:
+            return "Invalid";
+    }
+}
+
+namespace layout_cache
+{
+    template<class T>
+    struct entry
+    {
+        uint64_t mtime;
+        uint64_t size;  /* Catches changes within the file system's time resolution */
+        std::weak_ptr<T> value;
+        /* Valid while a thread loads this version, others wait for it */
+        std::shared_future<std::shared_ptr<T>> loading;
+    };
+
+    static std::mutex mutex;    /* Only held to look up and publish entries, not while loading */
+    static std::map<std::string, entry<const layout>> layouts;
+    static std::map<std::string, entry<const layout_texture>> textures;
+
+    /* Shared value for path, load is only called if
+     * there is none or the file changed since */
+    template<class T, class F>
+    static std::shared_ptr<T> get(std::map<std::string, entry<T>> &cache, const std::string &path, F load)
+    {
+        uint64_t mtime = 0, size = 0;
+        if (!file_watcher::stat_file(path, mtime, size))
+            return load(path); /* Fails and logs why */
+
+        const auto key = file_watcher::canonical_path(path);
+        std::unique_lock<std::mutex> lock(mutex);
+        auto &e = cache[key];
+        if (e.mtime == mtime && e.size == size) {
+            auto value = e.value.lock();
+            if (value)
+                return value;
+
+            if (e.loading.valid()) {
+                const auto loading = e.loading;
+                lock.unlock();
+                return loading.get();
+            }
+        }
+
+        std::promise<std::shared_ptr<T>> promise;
+        e.mtime = mtime;
+        e.size = size;
+        e.value.reset();
+        e.loading = promise.get_future().share();
+        lock.unlock();
+
+        const auto value = load(path);
+        promise.set_value(value);
+
+        lock.lock();
+        auto &published = cache[key];
+        /* Unless someone started loading a newer version in the meantime */
+        if (published.mtime == mtime && published.size == size) {
+            published.value = value;
+            published.loading = std::shared_future<std::shared_ptr<T>>();
+        }
+
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (it->second.value.expired() && !it->second.loading.valid())
+                it = cache.erase(it);
+            else
+                ++it;
+        }
+        return value;
+    }
+
+    static std::shared_ptr<const layout> load_layout(const std::string &path)
+    {
+        return std::shared_ptr<const layout>(layout::load(path));
+    }
+
+    static void free_texture(layout_texture* texture)
+    {
+        obs_enter_graphics();
+        gs_image_file_free(&texture->image);
+        obs_leave_graphics();
+        delete texture;
+    }
+
+    static std::shared_ptr<const layout_texture> load_texture(const std::string &path)
+    {
+        if (path.empty())
+            return nullptr;
+
+        const auto texture = new layout_texture();
+        auto &image = texture->image;
+        gs_image_file_init(&image, path.c_str());
+
+        /* The pixels are gone once the texture is created. Both formats
+         * images decode to have four bytes per pixel with alpha last */
+        if (image.loaded && image.texture_data && !image.is_animated_gif &&
+            (image.format == GS_RGBA || image.format == GS_BGRA)) {
+            const auto pixels = static_cast<size_t>(image.cx) * image.cy;
+            texture->alpha.resize(pixels);
+            for (size_t i = 0; i < pixels; i++)
+                texture->alpha[i] = image.texture_data[i * 4 + 3];
+        }
+
+        obs_enter_graphics();
+        gs_image_file_init_texture(&image);
+        obs_leave_graphics();
+
+        if (!image.loaded) {
+            blog(LOG_WARNING, "[input-overlay] Error: failed to load texture %s", path.c_str());
+            free_texture(texture);
+            return nullptr;
+        }
+        return std::shared_ptr<const layout_texture>(texture, free_texture);
+    }
+
+    std::shared_ptr<const layout> get_layout(const std::string &path)
+    {
+        return get(layouts, path, load_layout);
+    }
+
+    std::shared_ptr<const layout_texture> get_texture(const std::string &path)
+    {
+        return get(textures, path, load_texture);
+    }
+}
+
+namespace layout_loader
+{
+    static std::mutex mutex;
+    static std::condition_variable wake;
+    static std::deque<std::function<void()>> jobs;
+    static std::thread thread;
+    static bool running = false;
+
+    static void loader_proc()
+    {
+        trace::set_thread_name("layout loader");
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (running) {
+            if (jobs.empty()) {
+                wake.wait(lock);
+                continue;
+            }
+
+            const auto job = std::move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+            {
+                TRACE_SCOPE("layout_loader::job");
+                job();
+            }
+            lock.lock();
+        }
+    }
+
+    void queue(std::function<void()> job)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            if (thread.joinable())
+                thread.join();
+            running = true;
+            thread = std::thread(loader_proc);
+        }
+        jobs.emplace_back(std::move(job));
+        wake.notify_one();
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+            jobs.clear();
+            wake.notify_one();
+        }
+
+        if (thread.joinable())
+            thread.join();
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include "element/element.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <graphics/image-file.h>
+}
+
+class ccl_config;
+
+struct iolayout_element;
+
+enum element_layer : uint8_t
+{
+    LAYER_INPUT,        /* Drawn into the overlay cache every time it changes */
+    LAYER_BACKGROUND,   /* Only drawn into the background */
+    LAYER_RELEASED      /* Button that's drawn released into the background
+                         * and only drawn into the cache while it's pressed */
+};
+
+/* A decoded layout texture. The alpha channel is kept from decoding,
+ * it decides which buttons can be drawn into the background */
+struct layout_texture
+{
+    gs_image_file_t image;
+    std::vector<uint8_t> alpha; /* One value per pixel, row by row. Empty if it couldn't be read */
+};
+
+/* Where an element gets its data from in the overlays using its layout */
+struct element_binding
+{
+    int32_t slot;   /* Index into the overlay's data, -1 if the element has no data */
+    uint16_t keycode;
+    bool gamepad;   /* Data comes from the selected gamepad */
+};
+
+/* A parsed ini layout or compiled .iolayout file. Nothing changes once it's
+ * loaded, so all overlays using the same file share one, see layout_cache */
+class layout
+{
+public:
+    /* nullptr if the file has fatal errors */
+    static std::unique_ptr<layout> load(const std::string &path);
+
+    /* Data an element of this type starts with, empty if it has none */
+    static element_data idle_data(element_type t);
+
+    /* Decides which elements can be drawn into the background when the
+     * layout is used with texture, one layer per element */
+    std::vector<element_layer> assign_layers(const layout_texture &texture) const;
+
+    std::vector<std::unique_ptr<element>> elements;
+    std::vector<element_binding> bindings;  /* Same index as elements */
+    /* One data slot per keycode, elements with the same keycode share it */
+    std::vector<uint16_t> data_keycodes;
+    /* Type of data in each slot. Buttons sharing their keycode
+     * with another type never get button data */
+    std::vector<element_type> data_types;
+
+    uint32_t cx = 0, cy = 0;
+    uint8_t flags = 0;      /* See overlay_flags in layout_constants.hpp */
+    /* Texture referenced by a compiled layout, empty for ini layouts */
+    std::string atlas;
+
+private:
+    /* Maps the file and creates the elements right from its records */
+    static std::unique_ptr<layout> load_compiled(const std::string &path);
+
+    /* Reads the values of one element of an ini layout into a record */
+    static iolayout_element read_element(ccl_config* cfg, const std::string &id, element_type type);
+
+    void add_element(const iolayout_element &e, const std::string &id, bool debug);
+
+    /* Gives every element its data slot */
+    void bind_slots();
+
+    static const char* element_type_to_string(element_type t);
+};
+
+/* Layouts and textures shared by all sources. Entries are keyed by
+ * canonical path, modification time and size, so changed files are
+ * loaded again, and are freed once no overlay uses them */
+namespace layout_cache
+{
+    /* nullptr if the layout couldn't be loaded */
+    std::shared_ptr<const layout> get_layout(const std::string &path);
+
+    /* nullptr if the image couldn't be loaded. The texture
+     * is freed in the graphics context once it's unused */
+    std::shared_ptr<const layout_texture> get_texture(const std::string &path);
+}
+
+/* One thread for loading layouts and textures in the background */
+namespace layout_loader
+{
+    /* Runs job on the loader thread, which is started on first use */
+    void queue(std::function<void()> job);
+
+    /* Waits for the current job, drops the remaining ones and
+     * ends the thread. Call this before the module is unloaded */
+    void stop();
+}
@@ -0,0 +1,58 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Compiled layouts, written by io-cct next to the ini layout and
+ * mapped into memory by io-obs. The file starts with the header,
+ * followed by the element records and the name of the texture.
+ * Everything is little endian, records are read as they are */
+#define IOLAYOUT_EXTENSION  ".iolayout"
+#define IOLAYOUT_MAGIC      "IOLAYOUT"
+#define IOLAYOUT_MAGIC_SIZE 8
+/* Increase this whenever the layout of the records changes,
+ * files of other versions are rejected */
+#define IOLAYOUT_VERSION    1
+
+#pragma pack(push, 1)
+
+struct iolayout_header
+{
+    char magic[IOLAYOUT_MAGIC_SIZE];
+    uint16_t version;
+    uint16_t flags;             /* See overlay_flags in layout_constants.hpp */
+    uint32_t cx, cy;            /* Full overlay size */
+    uint32_t element_count;
+    uint32_t elements_offset;   /* Offsets are from the start of the file */
+    uint32_t atlas_offset;      /* File name of the texture, relative to the */
+    uint32_t atlas_length;      /* layout and not null terminated. 0 if there's none */
+};
+
+/* Everything the ini layout stores for one element, values
+ * an element type doesn't use are zero. Drawing order is the
+ * order of the records */
+struct iolayout_element
+{
+    int8_t type;                /* element_type */
+    uint8_t z_level;
+    int8_t side;                /* element_side of sticks and triggers */
+    uint8_t mouse_type;         /* mouse_movement_type */
+    uint8_t trigger_mode;       /* Trigger is drawn like a button */
+    uint8_t direction;          /* trigger_direction */
+    uint16_t keycode;
+    int32_t x, y;               /* Position in the overlay */
+    int32_t u, v, w, h;         /* Mapping in the texture */
+    uint16_t radius;            /* Stick or mouse movement radius */
+    uint16_t reserved;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(iolayout_header) == 36, "iolayout_header is written as is");
+static_assert(sizeof(iolayout_element) == 36, "iolayout_element is written as is");
@@ -5,23 +5,15 @@
  * github.com/univrsal/input-overlay
  */
 
-#include "gui/io_settings_dialog.hpp"
-#include "../../ccl/ccl.hpp"
 #include "overlay.hpp"
-#include "layout_constants.hpp"
-#include "element/element_button.hpp"
 #include "element/element_data_holder.hpp"
-#include "element/element.hpp"
-#include "element/element_mouse_wheel.hpp"
-#include "element/element_trigger.hpp"
-#include "element/element_analog_stick.hpp"
 #include "../sources/input_source.hpp"
-#include "element/element_gamepad_id.hpp"
-#include "element/element_dpad.hpp"
-#include "network/remote_connection.hpp"
-#include "network/io_server.hpp"
-#include "element/element_mouse_movement.hpp"
 #include "config.hpp"
+#include "frame_scheduler.hpp"
+#include "trace.hpp"
+#include <graphics/vec4.h>
+#include <cstring>
+#include <type_traits>
 
 extern "C" {
 #include <graphics/image-file.h>
@@ -46,153 +38,333 @@ overlay::overlay(sources::overlay_settings* settings)
 bool overlay::load()
 {
     unload();
-    const auto image_loaded = load_texture();
-    m_is_loaded = image_loaded && load_cfg();
-
-    if (!m_is_loaded) {
-        m_settings->gamepad = 0;
-        if (!image_loaded) {
-            m_settings->cx = 100; /* Default size */
-            m_settings->cy = 100;
+    loaded_files files;
+    load_files(m_settings->image_file, m_settings->layout_file, files);
+    return apply(files);
+}
+
+void overlay::load_async()
+{
+    load_async(m_settings->image_file, m_settings->layout_file);
+}
+
+void overlay::load_async(const std::string &image_file, const std::string &layout_file)
+{
+    const auto async = m_async;
+    const auto id = ++async->requested;
+
+    layout_loader::queue([async, id, image_file, layout_file]
+    {
+        /* Skipped if a newer load was requested in the meantime */
+        if (async->requested != id)
+            return;
+
+        const auto files = std::make_shared<loaded_files>();
+        load_files(image_file, layout_file, *files);
+
+        if (async->requested == id) {
+            std::atomic_store(&async->done, std::shared_ptr<const loaded_files>(files));
+            async->ready = true;
+        }
+    });
+}
+
+void overlay::swap_loaded()
+{
+    /* Reloading goes through the layout cache, which only
+     * parses and uploads the files that actually changed */
+    if (m_watch && m_watch->changed.exchange(false))
+        load_async(m_image_file, m_layout_file);
+
+    if (!m_async->ready.exchange(false))
+        return;
+
+    const auto files = std::atomic_exchange(&m_async->done, std::shared_ptr<const loaded_files>());
+    if (files)
+        apply(*files);
+}
+
+void overlay::load_files(const std::string &image_file, const std::string &layout_file, loaded_files &files)
+{
+    files.image_file = image_file;
+    files.layout_file = layout_file;
+
+    if (!layout_file.empty())
+        files.config = layout_cache::get_layout(layout_file);
+
+    /* Compiled layouts can bring their own texture */
+    if (image_file.empty() && files.config)
+        files.atlas_file = files.config->atlas;
+    const auto &texture_file = image_file.empty() ? files.atlas_file : image_file;
+    if (!texture_file.empty())
+        files.texture = layout_cache::get_texture(texture_file);
+
+    /* The layout is only used with a texture. Which buttons can be baked
+     * depends on its pixels, which are looked at here on the loader thread */
+    if (!files.texture)
+        files.config.reset();
+    else if (files.config)
+        files.layers = files.config->assign_layers(*files.texture);
+}
+
+bool overlay::apply(const loaded_files &files)
+{
+    /* The atlas can change with the same paths, once the compiled layout is rebuilt */
+    if (files.image_file != m_image_file || files.layout_file != m_layout_file ||
+        files.atlas_file != m_atlas_file || !m_watch) {
+        m_image_file = files.image_file;
+        m_layout_file = files.layout_file;
+        m_atlas_file = files.atlas_file;
+        /* The old listener is dropped by the watcher once it's unused */
+        m_watch = std::make_shared<file_watcher::listener>();
+        file_watcher::watch(m_image_file, m_watch);
+        file_watcher::watch(m_layout_file, m_watch);
+        file_watcher::watch(m_atlas_file, m_watch);
+    }
+
+    /* Unchanged files come back as the same shared instance */
+    const auto old_layout = m_layout;
+    auto old_data = std::move(m_data);
+    const auto layout_changed = files.config != m_layout;
+    if (files.texture != m_texture || layout_changed)
+        m_background_ready = false; /* The cache itself is kept and resized if needed */
+
+    m_texture = files.texture;
+    m_layout = files.config;
+    m_layers = files.layers;
+    m_data.clear();
+    m_state_settled = false;
+    m_dirty = true;
+
+    if (m_texture) {
+        m_settings->cx = m_texture->image.cx;
+        m_settings->cy = m_texture->image.cy;
+    } else {
+        m_settings->cx = 100; /* Default size */
+        m_settings->cy = 100;
+    }
+
+    if (m_layout) {
+        m_settings->cx = m_layout->cx;
+        m_settings->cy = m_layout->cy;
+        m_settings->layout_flags = m_layout->flags;
+        m_data.assign(m_layout->data_keycodes.size(), element_data());
+        if (layout_changed || m_states.size() != m_layout->elements.size())
+            m_states.assign(m_layout->elements.size(), element_state());
+
+        /* Every slot starts out idle, whatever kind of file the layout came from */
+        reset_data();
+
+        /* Slots with the same keycode and type keep their data, so
+         * held buttons stay pressed when the layout is edited on air */
+        if (old_layout) {
+            for (size_t i = 0; i < m_data.size(); i++) {
+                if (m_data[i].is_empty())
+                    continue;
+                for (size_t j = 0; j < old_data.size(); j++) {
+                    if (old_layout->data_keycodes[j] == m_layout->data_keycodes[i] &&
+                        old_layout->data_types[j] == m_layout->data_types[i]) {
+                        m_data[i] = old_data[j];
+                        break;
+                    }
+                }
+            }
         }
+    } else {
+        m_states.clear();
     }
 
+    m_is_loaded = m_texture && m_layout;
     return m_is_loaded;
 }
 
 void overlay::unload()
 {
-    unload_texture();
-    unload_elements();
+    m_watch.reset();
+    m_image_file.clear();
+    m_layout_file.clear();
+    m_atlas_file.clear();
+    m_texture.reset();
+    m_layout.reset();
+    m_layers.clear();
     m_data.clear();
+    m_states.clear();
+    free_cache();
+    m_state_settled = false;
+    m_dirty = true;
     m_settings->gamepad = 0;
     m_settings->cx = 100;
     m_settings->cy = 100;
 }
 
-bool overlay::load_cfg()
+void overlay::reset_data()
 {
-    if (!m_settings || m_settings->layout_file.empty())
-        return false;
-
-    auto cfg = new ccl_config(m_settings->layout_file, "");
-    auto flag = true;
-
-    if (!cfg->has_fatal_errors()) {
-        m_settings->cx = static_cast<uint32_t>(cfg->get_int(CFG_TOTAL_WIDTH, true));
-        m_settings->cy = static_cast<uint32_t>(cfg->get_int(CFG_TOTAL_HEIGHT, true));
-        m_settings->layout_flags = cfg->get_int(CFG_FLAGS, true);
-
-        auto element_id = cfg->get_string(CFG_FIRST_ID);
-        const auto debug_mode = cfg->get_bool(CFG_DEBUG_FLAG, true);
-
-#ifndef _DEBUG
-        if (debug_mode)
-        {
-#else
-        {
-#endif
-            blog(LOG_INFO, "[input-overlay] Started loading of %s", m_settings->layout_file.c_str());
-        }
-
-        while (!element_id.empty()) {
-            load_element(cfg, element_id, debug_mode);
-            element_id = cfg->get_string(element_id + CFG_NEXT_ID, true);
+    for (auto &data : m_data)
+        data = element_data();
+
+    if (m_layout) {
+        /* The last element of a keycode decides its data */
+        for (size_t i = 0; i < m_layout->elements.size(); i++) {
+            const auto slot = m_layout->bindings[i].slot;
+            const auto data = layout::idle_data(m_layout->elements[i]->get_type());
+            if (slot >= 0 && !data.is_empty())
+                m_data[slot] = data;
         }
     }
+    m_state_settled = false;
+    m_dirty = true;
+}
 
-    if (cfg->has_errors()) {
-        blog(LOG_WARNING, "[input-overlay] %s", cfg->get_error_message().c_str());
-        if (cfg->has_fatal_errors()) {
-            blog(LOG_WARNING, "[input-overlay] Fatal errors occured while loading config file");
-            flag = false;
-        } else {
-            /* Populate data map */
-            for (auto const &element : m_elements) {
-                element_data* data = nullptr;
-
-                switch (element->get_type()) {
-                    case GAMEPAD_ID: /* Acts just like a button */
-                    case BUTTON:
-                        data = new element_data_button(STATE_RELEASED);
-                        break;
-                    case MOUSE_SCROLLWHEEL:
-                        data = new element_data_wheel(STATE_RELEASED);
-                        break;
-                    case TRIGGER:
-                        data = new element_data_trigger(0.f, 0.f);
-                        break;
-                    case ANALOG_STICK:
-                        data = new element_data_analog_stick(STATE_RELEASED, STATE_RELEASED, 0.f, 0.f, 0.f, 0.f);
-                        break;
-                    case DPAD_STICK:
-                        data = new element_data_dpad(DPAD_LEFT, STATE_RELEASED);
-                        break;
-                    case MOUSE_STATS:
-                        data = new element_data_mouse_stats(0, 0);
-                        break;
-                    default:;
-                }
+const element_data* overlay::get_data(const uint16_t keycode) const
+{
+    if (!m_layout)
+        return nullptr;
 
-                if (data)
-                    m_data[element->get_keycode()] = std::unique_ptr<element_data>(data);
+    for (size_t i = 0; i < m_layout->data_keycodes.size(); i++) {
+        if (m_layout->data_keycodes[i] == keycode)
+            return m_data[i].is_empty() ? nullptr : &m_data[i];
+    }
+    return nullptr;
+}
 
-            }
-        }
+void overlay::free_cache()
+{
+    if (m_cache || m_background) {
+        obs_enter_graphics();
+        gs_texrender_destroy(m_cache);
+        gs_texrender_destroy(m_background);
+        obs_leave_graphics();
     }
+    m_cache = nullptr;
+    m_background = nullptr;
+    m_background_ready = false;
+    m_cache_cx = m_cache_cy = 0;
+}
 
-    delete cfg;
-    return flag;
+/* Layers have premultiplied alpha, which this blends accordingly */
+static void draw_layer(gs_effect_t* effect, gs_texture_t* texture, const uint32_t cx, const uint32_t cy)
+{
+    gs_blend_state_push();
+    gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+    gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture);
+    gs_draw_sprite(texture, 0, cx, cy);
+    gs_blend_state_pop();
 }
 
-bool overlay::load_texture()
+bool overlay::begin_layer(gs_texrender_t* target) const
 {
-    if (!m_settings || m_settings->image_file.empty())
+    gs_texrender_reset(target);
+    if (!gs_texrender_begin(target, m_cache_cx, m_cache_cy))
         return false;
 
-    auto flag = true;
+    vec4 clear_color;
+    vec4_zero(&clear_color);
+    gs_clear(GS_CLEAR_COLOR, &clear_color, 0.f, 0);
+    gs_ortho(0.f, static_cast<float>(m_cache_cx), 0.f, static_cast<float>(m_cache_cy), -100.f, 100.f);
 
-    if (m_image == nullptr) {
-        m_image = new gs_image_file_t();
-    }
+    /* Layers end up with premultiplied alpha, so blitting them
+     * gives the same result as drawing the elements directly */
+    gs_blend_state_push();
+    gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+    return true;
+}
 
-    gs_image_file_init(m_image, m_settings->image_file.c_str());
+void overlay::end_layer(gs_texrender_t* target)
+{
+    gs_blend_state_pop();
+    gs_texrender_end(target);
+}
 
-    obs_enter_graphics();
-    gs_image_file_init_texture(m_image);
-    obs_leave_graphics();
+bool overlay::draw_background(gs_effect_t* effect)
+{
+    TRACE_SCOPE("overlay::draw_background");
+    if (!begin_layer(m_background))
+        return false;
 
-    if (!m_image->loaded) {
-        blog(LOG_WARNING, "[input-overlay] Error: failed to load texture %s", m_settings->image_file.c_str());
-        flag = false;
-    } else {
-        m_settings->cx = m_image->cx;
-        m_settings->cy = m_image->cy;
+    /* Buttons without data are drawn released */
+    const auto &elements = m_layout->elements;
+    m_batch.begin(m_texture->image.cx, m_texture->image.cy);
+    for (size_t i = 0; i < elements.size(); i++) {
+        if (m_layers[i] != LAYER_INPUT)
+            elements[i]->draw(m_batch, nullptr, m_settings, m_states[i]);
     }
+    m_batch.draw(effect, m_texture->image.texture);
 
-    return flag;
+    end_layer(m_background);
+    return true;
 }
 
-void overlay::unload_texture() const
+void overlay::draw_cache(gs_effect_t* effect)
 {
-    obs_enter_graphics();
-    gs_image_file_free(m_image);
-    obs_leave_graphics();
-}
+    TRACE_SCOPE("overlay::draw_cache");
+    if (!begin_layer(m_cache)) {
+        m_dirty = true;
+        return;
+    }
 
-void overlay::unload_elements()
-{
-    m_elements.clear();
+    if (m_background_ready) {
+        const auto background = gs_texrender_get_texture(m_background);
+        if (background)
+            draw_layer(effect, background, m_cache_cx, m_cache_cy);
+    }
+
+    const auto &elements = m_layout->elements;
+    m_batch.begin(m_texture->image.cx, m_texture->image.cy);
+    for (size_t i = 0; i < elements.size(); i++) {
+        const auto &binding = m_layout->bindings[i];
+        const auto data = binding.slot >= 0 && !m_data[binding.slot].is_empty() ? &m_data[binding.slot] : nullptr;
+
+        if (m_background_ready) {
+            if (m_layers[i] == LAYER_BACKGROUND)
+                continue;
+            if (m_layers[i] == LAYER_RELEASED) {
+                const auto button = data ? data->get_button() : nullptr;
+                if (!button || button->get_state() != STATE_PRESSED)
+                    continue;
+            }
+        }
+        elements[i]->draw(m_batch, data, m_settings, m_states[i]);
+    }
+    m_batch.draw(effect, m_texture->image.texture);
+
+    end_layer(m_cache);
 }
 
 void overlay::draw(gs_effect_t* effect)
 {
-    if (m_is_loaded) {
-        for (auto const &element : m_elements) {
-            const auto data = m_data[element->get_keycode()].get();
-            element->draw(effect, m_image, data, m_settings);
+    TRACE_SCOPE("overlay::draw");
+    if (!m_is_loaded || !m_layout || !m_texture || !m_settings->cx || !m_settings->cy)
+        return;
+
+    if (!m_cache) {
+        m_cache = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+        m_background = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+        if (!m_cache || !m_background) {
+            gs_texrender_destroy(m_cache);
+            gs_texrender_destroy(m_background);
+            m_cache = m_background = nullptr;
+            return;
         }
     }
+
+    if (m_cache_cx != m_settings->cx || m_cache_cy != m_settings->cy) {
+        m_cache_cx = m_settings->cx;
+        m_cache_cy = m_settings->cy;
+        m_background_ready = false;
+    }
+
+    /* Elements are drawn without the background until it worked */
+    if (!m_background_ready) {
+        m_background_ready = draw_background(effect);
+        m_dirty = true;
+    }
+
+    if (m_dirty.exchange(false))
+        draw_cache(effect);
+
+    const auto texture = gs_texrender_get_texture(m_cache);
+    if (texture)
+        draw_layer(effect, texture, m_cache_cx, m_cache_cy);
 }
 
 void overlay::refresh_data()
@@ -206,110 +378,45 @@ void overlay::refresh_data()
      */
     if (io_config::io_window_filters.input_blocked())
         return;
-    element_data_holder* source = nullptr;
-    std::lock_guard<std::mutex> lck1(hook::mutex);
-    std::lock_guard<std::mutex> lck2(network::mutex);
-
-    if (hook::data_initialized || network::network_flag) {
-        if (network::server_instance && m_settings->selected_source > 0) {
-            source = network::server_instance->get_client(m_settings->selected_source - 1)->get_data();
-        } else {
-            source = hook::input_data;
-        }
-    }
-
-    if (source) {
-        for (auto const &element : m_elements) {
-            element_data* data = nullptr;
-
-             if (m_data[element->get_keycode()] != nullptr) {
-                switch (element->get_source()) {
-                    case GAMEPAD:
-                        data = source->get_by_gamepad(m_settings->gamepad, element->get_keycode());
-                        break;
-                    default:
-                    case MOUSE_POS:
-                    case DEFAULT:
-                        data = source->get_by_code(element->get_keycode());
-                        break;
-                }
-                m_data[element->get_keycode()]->merge(data);
-            }
-        }
-    }
+    refresh_data(frame_scheduler::get_state(m_settings->selected_source));
 }
 
-void overlay::load_element(ccl_config* cfg, const std::string &id, const bool debug)
+void overlay::refresh_data(const input_state* state)
 {
-    const auto type = cfg->get_int(id + CFG_TYPE);
-    element* new_element = nullptr;
-
-    switch (type) {
-        case TEXTURE:
-            new_element = new element_texture();
-            break;
-        case BUTTON:
-            new_element = new element_button();
-            break;
-        case MOUSE_SCROLLWHEEL:
-            new_element = new element_wheel();
-            break;
-        case TRIGGER:
-            new_element = new element_trigger();
-            break;
-        case ANALOG_STICK:
-            new_element = new element_analog_stick();
-            break;
-        case GAMEPAD_ID:
-            new_element = new element_gamepad_id();
-            break;
-        case DPAD_STICK:
-            new_element = new element_dpad();
-            break;
-        case MOUSE_STATS:
-            new_element = new element_mouse_movement();
-            break;
-        default:
-            if (debug)
-                blog(LOG_INFO, "[input-overlay] Invalid element type %i for %s", type, id.c_str());
-    }
+    /* Data is compared bytewise before and after merging */
+    static_assert(std::is_trivially_copyable<element_data>::value, "element_data has to be trivially copyable");
+
+    TRACE_SCOPE("overlay::refresh_data");
+    if (!state || !m_layout)
+        return;
+
+    /* Merging is only skipped once it stopped changing anything, mouse movement
+     * and scroll amounts still need one more merge to settle after the last event.
+     * Changed settings can select other data, like a different gamepad */
+    if (m_state_settled && !m_dirty && state->get_generation() == m_state_generation)
+        return;
 
-    if (new_element) {
-        new_element->load(cfg, id);
-        m_elements.emplace_back(new_element);
-
-#ifndef _DEBUG
-        if (debug) {
-#else
-        {
-#endif
-            blog(LOG_INFO, "[input-overlay]  Type: %14s, KEYCODE: 0x%04X ID: %s",
-                 element_type_to_string(static_cast<element_type>(type)), new_element->get_keycode(), id.c_str());
+    auto changed = false;
+    for (auto const &binding : m_layout->bindings) {
+        if (binding.slot < 0)
+            continue;
+
+        auto &slot = m_data[binding.slot];
+        if (slot.is_empty())
+            continue;
+
+        const auto data = binding.gamepad ? state->get_by_gamepad(m_settings->gamepad, binding.keycode)
+                                          : state->get_by_code(binding.keycode);
+        if (data) {
+            element_data old;
+            memcpy(&old, &slot, sizeof(element_data));
+            slot.merge(*data);
+            changed |= memcmp(&old, &slot, sizeof(element_data)) != 0;
         }
     }
-}
 
-const char* overlay::element_type_to_string(const element_type t)
-{
-    switch (t) {
-        case TEXTURE:
-            return "Texture";
-        case BUTTON:
-            return "Button";
-        case ANALOG_STICK:
-            return "Analog stick";
-        case MOUSE_SCROLLWHEEL:
-            return "Scroll wheel";
-        case MOUSE_STATS:
-            return "Mouse movement";
-        case TRIGGER:
-            return "Trigger";
-        case GAMEPAD_ID:
-            return "Gamepad ID";
-        case DPAD_STICK:
-            return "DPad";
-        default:
-        case INVALID:
-            return "Invalid";
-    }
+    m_state_generation = state->get_generation();
+    m_state_settled = !changed;
+    if (changed)
+        m_dirty = true;
 }
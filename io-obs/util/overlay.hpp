@@ -13,17 +13,16 @@
 
 #endif
 
+#include <atomic>
 #include <memory>
 #include <vector>
-#include <map>
 #include "element/element.hpp"
+#include "sprite_batch.hpp"
+#include "layout_cache.hpp"
+#include "file_watcher.hpp"
 #include "../hook/hook_helper.hpp"
 
-class ccl_config;
-
-class element_data;
-
-typedef struct gs_image_file gs_image_file_t;
+class input_state;
 
 class overlay
 {
@@ -34,44 +33,130 @@ public:
 
     explicit overlay(sources::overlay_settings* settings);
 
+    /* Loads the layout and texture of the current settings */
     bool load();
 
+    /* Same on the loader thread, so decoding and parsing don't block the
+     * caller. The old layout is drawn until swap_loaded() picks up the new one */
+    void load_async();
+
+    /* Switches to the newest finished load_async() if there is one and
+     * loads the files again if they were changed on disk. Only call
+     * this on the graphics thread, before refreshing and drawing */
+    void swap_loaded();
+
     void unload();
 
+    /* Blits the cached overlay, which is only redrawn if its
+     * data, layout or settings changed since the last frame */
     void draw(gs_effect_t* effect);
 
+    /* Redraws the cache next frame, call this after changing settings */
+    void invalidate()
+    {
+        m_dirty = true;
+    }
+
     void refresh_data();
 
+    /* Takes the data from state instead of the selected source */
+    void refresh_data(const input_state* state);
+
+    /* Puts all elements back into their idle state */
+    void reset_data();
+
+    /* Data the element with this keycode is drawn with,
+     * nullptr if no element uses the keycode */
+    const element_data* get_data(uint16_t keycode) const;
+
     bool is_loaded() const
     {
         return m_is_loaded;
     }
 
-    gs_image_file_t* get_texture() const
+    const gs_image_file_t* get_texture() const
     {
-        return m_image;
+        return m_texture ? &m_texture->image : nullptr;
+    }
+
+    /* Quads of the last redraw of the cache, only input driven elements end up in it */
+    size_t cache_quads() const
+    {
+        return m_batch.quads();
     }
 
 private:
-    bool load_cfg();
+    /* Texture and layout of one load, either is nullptr if it failed */
+    struct loaded_files
+    {
+        std::string image_file, layout_file;
+        std::string atlas_file;     /* Texture named by a compiled layout, if it's used */
+        std::shared_ptr<const layout_texture> texture;
+        std::shared_ptr<const layout> config;
+        std::vector<element_layer> layers;  /* Of the layout's elements with this texture */
+    };
+
+    /* Shared with the loader thread, which can still be
+     * loading something after the overlay was destroyed */
+    struct async_load
+    {
+        std::atomic<uint64_t> requested{0};     /* Id of the newest request */
+        std::atomic<bool> ready{false};
+        std::shared_ptr<const loaded_files> done; /* Only accessed with std::atomic_* */
+    };
+
+    void load_async(const std::string &image_file, const std::string &layout_file);
+
+    static void load_files(const std::string &image_file, const std::string &layout_file, loaded_files &files);
+
+    /* Switches to the loaded files. Only what depends on a file that
+     * changed is reset, data of slots that are still there is kept */
+    bool apply(const loaded_files &files);
+
+    /* Clears target and sets it up for drawing elements into it,
+     * false if it couldn't be bound. Call end_layer() afterwards */
+    bool begin_layer(gs_texrender_t* target) const;
 
-    bool load_texture();
+    static void end_layer(gs_texrender_t* target);
 
-    void unload_texture() const;
+    /* Draws everything that doesn't depend on input into m_background */
+    bool draw_background(gs_effect_t* effect);
 
-    void unload_elements();
+    /* Draws the background and all input driven elements into m_cache */
+    void draw_cache(gs_effect_t* effect);
 
-    void load_element(ccl_config* cfg, const std::string &id, bool debug);
+    void free_cache();
 
-    static const char* element_type_to_string(element_type t);
+    /* Both are shared with all other overlays using the same files */
+    std::shared_ptr<const layout_texture> m_texture;
+    std::shared_ptr<const layout> m_layout;
+    std::vector<element_layer> m_layers;    /* Same index as the layout's elements */
+    std::shared_ptr<async_load> m_async = std::make_shared<async_load>();
+    /* Files of the last load, reloaded once the watcher reports a change */
+    std::string m_image_file, m_layout_file, m_atlas_file;
+    std::shared_ptr<file_watcher::listener> m_watch;
 
-    gs_image_file_t* m_image = nullptr;
+    /* All elements share the layout texture, so they're drawn at once */
+    sprite_batch m_batch;
+    gs_texrender_t* m_cache = nullptr;
+    /* Elements that never change, drawn once per layout and size */
+    gs_texrender_t* m_background = nullptr;
+    bool m_background_ready = false;
+    uint32_t m_cache_cx = 0, m_cache_cy = 0;
+    /* Set by anything that changes how the overlay looks,
+     * settings are changed outside of the graphics thread */
+    std::atomic<bool> m_dirty{true};
 
     sources::overlay_settings* m_settings = nullptr;
 
     bool m_is_loaded = false;
-    std::vector<std::unique_ptr<element>> m_elements;
-    std::map<uint16_t, std::unique_ptr<element_data>> m_data;
+    /* Data slots of the layout, slots stay empty until reset_data() */
+    std::vector<element_data> m_data;
+    std::vector<element_state> m_states;  /* Same index as the layout's elements */
+    /* Generation of the state m_data was last refreshed from and whether that
+     * refresh was a no-op. Merging the same state again then won't change anything */
+    uint64_t m_state_generation = 0;
+    bool m_state_settled = false;
 
     uint16_t m_track_radius{};
     uint16_t m_max_mouse_movement{};
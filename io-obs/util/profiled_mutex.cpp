@@ -0,0 +1,187 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "profiled_mutex.hpp"
+#include "trace.hpp"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace lock_stats
+{
+    /* Function local, so sites of global mutexes can
+     * register during static initialization */
+    static std::mutex &sites_mutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<lock_site*> &sites()
+    {
+        static std::vector<lock_site*> list;
+        return list;
+    }
+
+    static void add_site(lock_site* site)
+    {
+        std::lock_guard<std::mutex> lock(sites_mutex());
+        sites().emplace_back(site);
+    }
+
+    static const char* file_name(const char* path)
+    {
+        const char* name = path;
+        for (auto c = path; *c; c++) {
+            if (*c == '/' || *c == '\\')
+                name = c + 1;
+        }
+        return name;
+    }
+
+    void reset()
+    {
+        /* Sites can be created while their thread holds another mutex,
+         * so that one isn't waited for with the list locked */
+        std::vector<lock_site*> list;
+        {
+            std::lock_guard<std::mutex> lock(sites_mutex());
+            list = sites();
+        }
+
+        for (auto site : list) {
+            site->mutex->lock_uncounted();
+            site->reset();
+            site->mutex->unlock();
+        }
+    }
+
+    std::string summary()
+    {
+        std::vector<lock_site*> list;
+        {
+            std::lock_guard<std::mutex> lock(sites_mutex());
+            list = sites();
+        }
+
+        /* Sites of one mutex next to each other, in the order they were created */
+        std::stable_sort(list.begin(), list.end(), [](const lock_site* a, const lock_site* b)
+        {
+            return strcmp(a->mutex->name(), b->mutex->name()) < 0;
+        });
+
+        std::string text;
+        char line[256];
+        for (size_t i = 0; i < list.size();) {
+            const auto mutex = list[i]->mutex;
+            uint64_t acquisitions = 0, contended = 0, wait = 0, max_wait = 0;
+            auto end = i;
+
+            for (; end < list.size() && list[end]->mutex == mutex; end++) {
+                acquisitions += list[end]->acquisitions.load(std::memory_order_relaxed);
+                contended += list[end]->contended.load(std::memory_order_relaxed);
+                wait += list[end]->wait_ns.load(std::memory_order_relaxed);
+                max_wait = std::max(max_wait, list[end]->max_wait_ns.load(std::memory_order_relaxed));
+            }
+
+            if (acquisitions) {
+                snprintf(line, sizeof(line), "%-28s %10llu locks %8llu contended  wait %9.3f ms  max %8.3f ms\n",
+                         mutex->name(), static_cast<unsigned long long>(acquisitions),
+                         static_cast<unsigned long long>(contended), wait / 1e6, max_wait / 1e6);
+                text += line;
+
+                for (; i < end; i++) {
+                    const auto site = list[i];
+                    const auto count = site->acquisitions.load(std::memory_order_relaxed);
+                    if (!count)
+                        continue;
+
+                    char name[64];
+                    if (site->line)
+                        snprintf(name, sizeof(name), "%s:%i", file_name(site->file), site->line);
+                    else
+                        snprintf(name, sizeof(name), "%s", site->file);
+                    snprintf(line, sizeof(line), "  %-26s %10llu locks %8llu contended  wait %9.3f ms  max %8.3f ms\n",
+                             name, static_cast<unsigned long long>(count),
+                             static_cast<unsigned long long>(site->contended.load(std::memory_order_relaxed)),
+                             site->wait_ns.load(std::memory_order_relaxed) / 1e6,
+                             site->max_wait_ns.load(std::memory_order_relaxed) / 1e6);
+                    text += line;
+                }
+            }
+            i = end;
+        }
+        return text;
+    }
+
+    void log()
+    {
+        const auto text = summary();
+        if (text.empty())
+            return;
+
+        blog(LOG_INFO, "[input-overlay] Lock contention:");
+        size_t start = 0, end;
+        while ((end = text.find('\n', start)) != std::string::npos) {
+            blog(LOG_INFO, "[input-overlay]   %s", text.substr(start, end - start).c_str());
+            start = end + 1;
+        }
+    }
+}
+
+lock_site::lock_site(profiled_mutex &m, const char* file, const int line) : mutex(&m), file(file), line(line)
+{
+    reset();
+    lock_stats::add_site(this);
+}
+
+/* Counters are only written while their mutex is held, so
+ * they don't need atomic read-modify-write operations */
+static inline void add(std::atomic<uint64_t> &counter, const uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void lock_site::record_wait(const uint64_t ns)
+{
+    add(contended, 1);
+    add(wait_ns, ns);
+    if (ns > max_wait_ns.load(std::memory_order_relaxed))
+        max_wait_ns.store(ns, std::memory_order_relaxed);
+}
+
+void lock_site::reset()
+{
+    acquisitions.store(0, std::memory_order_relaxed);
+    contended.store(0, std::memory_order_relaxed);
+    wait_ns.store(0, std::memory_order_relaxed);
+    max_wait_ns.store(0, std::memory_order_relaxed);
+}
+
+profiled_mutex::profiled_mutex(const char* name) : m_name(name), m_unknown(*this, "other", 0)
+{
+}
+
+void profiled_mutex::lock(lock_site &site)
+{
+    if (m_mutex.try_lock()) {
+        add(site.acquisitions, 1);
+        return;
+    }
+
+    const auto start = os_gettime_ns();
+    m_mutex.lock();
+    const auto end = os_gettime_ns();
+    add(site.acquisitions, 1);
+    site.record_wait(end - start);
+
+    if (trace::active())
+        trace::complete(m_name, start, end);
+}
@@ -0,0 +1,132 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <stdint.h>
+
+class profiled_mutex;
+
+/* Contention counters of one place that takes a lock. Sites are
+ * created once per call site by PROFILED_LOCK and live until unload.
+ * Counters are atomic so the settings dialog can read them at any time */
+struct lock_site
+{
+    profiled_mutex* mutex;
+    const char* file;
+    int line;
+    std::atomic<uint64_t> acquisitions;
+    std::atomic<uint64_t> contended;    /* Acquisitions that had to wait */
+    std::atomic<uint64_t> wait_ns;
+    std::atomic<uint64_t> max_wait_ns;
+
+    lock_site(profiled_mutex &m, const char* file, int line);
+
+    void record_wait(uint64_t ns);
+
+    /* Caller has to hold the mutex, the counters are
+     * only ever changed by whoever holds it */
+    void reset();
+};
+
+/* std::mutex that counts how often and how long threads wait for it.
+ * Uncontended locking only adds an increment, the clock is only read
+ * if the lock is already held. Waits also show up as spans named
+ * after the mutex while tracing (see trace.hpp)
+ */
+class profiled_mutex
+{
+    std::mutex m_mutex;
+    const char* m_name;
+    lock_site m_unknown;    /* Locks without a site (std::lock_guard etc.) */
+
+public:
+    explicit profiled_mutex(const char* name);
+
+    profiled_mutex(const profiled_mutex &) = delete;
+
+    profiled_mutex &operator=(const profiled_mutex &) = delete;
+
+    void lock(lock_site &site);
+
+    void lock()
+    {
+        lock(m_unknown);
+    }
+
+    bool try_lock()
+    {
+        return m_mutex.try_lock();
+    }
+
+    void unlock()
+    {
+        m_mutex.unlock();
+    }
+
+    /* Locks without counting it, for clearing the counters of its sites */
+    void lock_uncounted()
+    {
+        m_mutex.lock();
+    }
+
+    const char* name() const
+    {
+        return m_name;
+    }
+};
+
+class profiled_lock
+{
+    profiled_mutex &m_mutex;
+
+public:
+    profiled_lock(profiled_mutex &mutex, lock_site &site) : m_mutex(mutex)
+    {
+        m_mutex.lock(site);
+    }
+
+    ~profiled_lock()
+    {
+        m_mutex.unlock();
+    }
+
+    profiled_lock(const profiled_lock &) = delete;
+
+    profiled_lock &operator=(const profiled_lock &) = delete;
+};
+
+#define PROFILED_SITE_(name) name##_site
+#define PROFILED_SITE(name)  PROFILED_SITE_(name)
+
+/* Declares a call site for mutex and locks it until the end of the block,
+ * like std::lock_guard<std::mutex> name(mutex) */
+#define PROFILED_LOCK(name, mutex)                                        \
+    static lock_site PROFILED_SITE(name)((mutex), __FILE__, __LINE__);    \
+    profiled_lock name((mutex), PROFILED_SITE(name))
+
+/* Same for mutex.lock(), the caller unlocks */
+#define PROFILED_LOCK_MANUAL(mutex)                                       \
+    do {                                                                  \
+        static lock_site site((mutex), __FILE__, __LINE__);               \
+        (mutex).lock(site);                                               \
+    } while (0)
+
+namespace lock_stats
+{
+    /* Clears the counters of all sites */
+    void reset();
+
+    /* Per mutex totals followed by their call sites, for the settings dialog */
+    std::string summary();
+
+    /* Writes the summary to the obs log */
+    void log();
+}
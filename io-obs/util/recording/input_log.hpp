@@ -0,0 +1,69 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Binary input log. A file starts with a log_header, followed by records
+ * until the end of the file. Each record is a log_record followed by its
+ * payload, which is padded so the next record starts eight byte aligned.
+ * The file is only ever appended to and has no footer, so a log that was
+ * cut off (crash, full disk) can still be read up to its last complete
+ * record. All values are stored in the byte order of the recording machine
+ */
+
+#define IO_LOG_MAGIC    0x474C4F49 /* "IOLG" */
+#define IO_LOG_VERSION  1
+#define IO_LOG_ALIGN    8
+
+/* Source id of local input, remote clients are their id + 1 */
+#define LOG_SOURCE_LOCAL 0
+/* Holders with this source are never recorded (replays) */
+#define LOG_SOURCE_NONE 0xFF
+
+/* Time between two keyframes of the same source in ns */
+#define LOG_KEYFRAME_INTERVAL (5ull * 1000 * 1000 * 1000)
+
+struct log_header
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;   /* Offset of the first record */
+    uint64_t start_time;    /* os_gettime_ns() when the recording was started */
+};
+
+enum log_record_type
+{
+    LOG_RAW_EVENT,      /* Local keyboard and mouse event, payload is a raw_event */
+    LOG_DATA,           /* add_data(keycode, payload), payload is an element_data */
+    LOG_PAD_DATA,       /* add_gamepad_data(gamepad, keycode, payload) */
+    LOG_CLEAR_BUTTONS,  /* clear_button_data(), no payload */
+    LOG_KEYFRAME        /* Complete input_state of the source, everything recorded
+                         * after it applies on top of it. Only valid in logs written
+                         * by the same build, readers skip keyframes of another size */
+};
+
+struct log_record
+{
+    uint64_t time;      /* Capture time in ns (os_gettime_ns) */
+    uint8_t type;       /* log_record_type */
+    uint8_t source;     /* LOG_SOURCE_LOCAL or remote client id + 1 */
+    uint8_t gamepad;
+    uint8_t reserved;
+    uint16_t keycode;
+    uint16_t size;      /* Payload size without padding */
+};
+
+static_assert(sizeof(log_record) == 16, "log_record has to stay 16 bytes");
+
+/* Payload size including padding */
+inline size_t log_padded_size(const size_t size)
+{
+    return (size + IO_LOG_ALIGN - 1) & ~static_cast<size_t>(IO_LOG_ALIGN - 1);
+}
@@ -0,0 +1,224 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "recorder.hpp"
+#include "../element/element_data_holder.hpp"
+#include "../../hook/hook_helper.hpp"
+#include <util/platform.h>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+
+namespace recorder
+{
+    std::atomic<bool> recording(false);
+
+    /* Records are dropped once this much is waiting for the writer */
+    static const size_t max_pending = 8 * 1024 * 1024;
+    static const std::chrono::milliseconds flush_interval(50);
+
+    static std::mutex mutex; /* Guards pending, file and stop_flag */
+    static std::condition_variable cond;
+    static std::vector<uint8_t> pending;
+    static FILE* file = nullptr;
+    static bool stop_flag = false;
+    static std::thread writer;
+    static std::atomic<uint64_t> written(0);
+    static std::atomic<uint64_t> dropped(0);
+    static uint64_t keyframe_times[0x100] = {}; /* Last keyframe of each source */
+
+    static_assert(sizeof(input_state) <= UINT16_MAX, "Keyframes have to fit into a record");
+
+    /* Swaps out the pending records and writes them without holding the
+     * lock, so producers only ever wait for a vector swap
+     */
+    static void writer_proc()
+    {
+        std::vector<uint8_t> batch;
+        std::unique_lock<std::mutex> lock(mutex);
+
+        for (;;) {
+            cond.wait_for(lock, flush_interval, []
+            { return stop_flag; });
+            batch.swap(pending);
+            const auto done = stop_flag;
+            lock.unlock();
+
+            if (!batch.empty()) {
+                if (fwrite(batch.data(), 1, batch.size(), file) != batch.size())
+                    blog(LOG_WARNING, "[input-overlay] Failed to write %llu bytes to input log",
+                         static_cast<unsigned long long>(batch.size()));
+                fflush(file);
+                /* Keeps the capacity, the buffers just trade places */
+                batch.clear();
+            }
+
+            if (done)
+                break;
+            lock.lock();
+        }
+    }
+
+    static void push(const log_record &record, const void* payload)
+    {
+        const auto size = sizeof(log_record) + log_padded_size(record.size);
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!file)
+            return;
+
+        if (pending.size() + size > max_pending) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        /* resize() zeroes the padding */
+        const auto offset = pending.size();
+        pending.resize(offset + size);
+        memcpy(&pending[offset], &record, sizeof(log_record));
+        /* Records without payload pass nullptr, which memcpy must never see */
+        if (payload && record.size > 0)
+            memcpy(&pending[offset + sizeof(log_record)], payload, record.size);
+        written.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool start(const char* path)
+    {
+        stop();
+
+        const auto f = os_fopen(path, "wb");
+        if (!f) {
+            blog(LOG_ERROR, "[input-overlay] Couldn't create input log at %s", path);
+            return false;
+        }
+
+        log_header header = {};
+        header.magic = IO_LOG_MAGIC;
+        header.version = IO_LOG_VERSION;
+        header.header_size = sizeof(log_header);
+        header.start_time = os_gettime_ns();
+        fwrite(&header, sizeof(header), 1, f);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            file = f;
+            stop_flag = false;
+            pending.clear();
+            memset(keyframe_times, 0, sizeof(keyframe_times));
+        }
+
+        written = 0;
+        dropped = 0;
+        writer = std::thread(writer_proc);
+        recording = true;
+        blog(LOG_INFO, "[input-overlay] Recording input to %s", path);
+        return true;
+    }
+
+    void stop()
+    {
+        if (!writer.joinable())
+            return;
+
+        recording = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop_flag = true;
+        }
+        cond.notify_one();
+        writer.join();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fclose(file);
+            file = nullptr;
+            pending.clear();
+        }
+
+        blog(LOG_INFO, "[input-overlay] Input recording stopped, %llu records written, %llu dropped",
+             static_cast<unsigned long long>(written.load()),
+             static_cast<unsigned long long>(dropped.load()));
+    }
+
+    void record_event(const raw_event &event)
+    {
+        log_record record = {};
+        record.time = event.time;
+        record.type = LOG_RAW_EVENT;
+        record.source = LOG_SOURCE_LOCAL;
+        record.size = sizeof(raw_event);
+        push(record, &event);
+    }
+
+    void record_data(const uint8_t source, const uint16_t keycode, const element_data &data)
+    {
+        log_record record = {};
+        record.time = os_gettime_ns();
+        record.type = LOG_DATA;
+        record.source = source;
+        record.keycode = keycode;
+        record.size = sizeof(element_data);
+        push(record, &data);
+    }
+
+    void record_gamepad_data(const uint8_t source, const uint8_t gamepad, const uint16_t keycode,
+                             const element_data &data)
+    {
+        log_record record = {};
+        record.time = os_gettime_ns();
+        record.type = LOG_PAD_DATA;
+        record.source = source;
+        record.gamepad = gamepad;
+        record.keycode = keycode;
+        record.size = sizeof(element_data);
+        push(record, &data);
+    }
+
+    void record_clear(const uint8_t source)
+    {
+        log_record record = {};
+        record.time = os_gettime_ns();
+        record.type = LOG_CLEAR_BUTTONS;
+        record.source = source;
+        push(record, nullptr);
+    }
+
+    bool keyframe_due(const uint8_t source)
+    {
+        const auto now = os_gettime_ns();
+        std::lock_guard<std::mutex> lock(mutex);
+
+        /* The first keyframe is taken right away, it has the
+         * state from before the recording was started */
+        if (!file || (keyframe_times[source] != 0 && now - keyframe_times[source] < LOG_KEYFRAME_INTERVAL))
+            return false;
+        keyframe_times[source] = now;
+        return true;
+    }
+
+    void record_keyframe(const uint8_t source, const input_state &state)
+    {
+        log_record record = {};
+        record.time = os_gettime_ns();
+        record.type = LOG_KEYFRAME;
+        record.source = source;
+        record.size = sizeof(input_state);
+        push(record, &state);
+    }
+
+    uint64_t written_records()
+    {
+        return written.load();
+    }
+
+    uint64_t dropped_records()
+    {
+        return dropped.load();
+    }
+}
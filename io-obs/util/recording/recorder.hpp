@@ -0,0 +1,59 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include "input_log.hpp"
+#include <atomic>
+
+struct raw_event;
+class element_data;
+class input_state;
+
+/* Records all input into a binary log (see input_log.hpp).
+ * The record_* functions can be called from any thread and only copy
+ * the record into a buffer, a writer thread flushes it to disk every
+ * few milliseconds. If the disk can't keep up records are dropped
+ * instead of blocking the input threads
+ */
+namespace recorder
+{
+    extern std::atomic<bool> recording;
+
+    /* Cheap enough to check for every event */
+    inline bool active()
+    {
+        return recording.load(std::memory_order_relaxed);
+    }
+
+    /* Starts a new log at path, overwriting existing files.
+     * Returns false if the file couldn't be created */
+    bool start(const char* path);
+
+    /* Writes out everything that's left and closes the log */
+    void stop();
+
+    void record_event(const raw_event &event);
+
+    void record_data(uint8_t source, uint16_t keycode, const element_data &data);
+
+    void record_gamepad_data(uint8_t source, uint8_t gamepad, uint16_t keycode, const element_data &data);
+
+    void record_clear(uint8_t source);
+
+    /* True once every LOG_KEYFRAME_INTERVAL per source, the caller then
+     * records a keyframe. It has to be taken by the thread that changes
+     * the state, so no change is missing or recorded twice */
+    bool keyframe_due(uint8_t source);
+
+    void record_keyframe(uint8_t source, const input_state &state);
+
+    /* Statistics of the current or last recording */
+    uint64_t written_records();
+
+    uint64_t dropped_records();
+}
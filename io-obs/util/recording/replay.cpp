@@ -0,0 +1,325 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "replay.hpp"
+#include "../element/element_data_holder.hpp"
+#include "../../hook/hook_helper.hpp"
+#include <util/platform.h>
+#include <util/bmem.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+input_replay::~input_replay()
+{
+    close();
+}
+
+bool input_replay::open(const char* path)
+{
+    close();
+    size_t length = 0;
+
+#ifdef _WIN32
+    wchar_t* wpath = nullptr;
+    os_utf8_to_wcs_ptr(path, 0, &wpath);
+    m_file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL, nullptr);
+    bfree(wpath);
+
+    LARGE_INTEGER file_size = {};
+    if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &file_size) ||
+        file_size.QuadPart < static_cast<LONGLONG>(sizeof(log_header))) {
+        blog(LOG_ERROR, "[input-overlay] Couldn't open input log %s", path);
+        close();
+        return false;
+    }
+
+    length = static_cast<size_t>(file_size.QuadPart);
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping)
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    const auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st = {};
+
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size < static_cast<off_t>(sizeof(log_header))) {
+        blog(LOG_ERROR, "[input-overlay] Couldn't open input log %s", path);
+        if (fd >= 0)
+            ::close(fd);
+        return false;
+    }
+
+    /* The mapping stays valid after the descriptor is closed */
+    length = static_cast<size_t>(st.st_size);
+    const auto map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (map != MAP_FAILED) {
+        madvise(map, length, MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t*>(map);
+        m_map_size = length;
+    }
+#endif
+
+    if (!m_data) {
+        blog(LOG_ERROR, "[input-overlay] Couldn't map input log %s", path);
+        close();
+        return false;
+    }
+
+    log_header header;
+    memcpy(&header, m_data, sizeof(header));
+    if (header.magic != IO_LOG_MAGIC || header.version != IO_LOG_VERSION ||
+        header.header_size < sizeof(log_header) || header.header_size > length) {
+        blog(LOG_ERROR, "[input-overlay] %s is not a supported input log", path);
+        close();
+        return false;
+    }
+
+    /* Count the records and cut off an incomplete last one. Records
+     * aren't strictly sorted by time, threads queue them out of order */
+    m_start = log_padded_size(header.header_size);
+    auto offset = m_start;
+    m_first_time = UINT64_MAX;
+    m_last_time = 0;
+
+    while (offset + sizeof(log_record) <= length) {
+        const auto record = reinterpret_cast<const log_record*>(m_data + offset);
+        const auto end = offset + sizeof(log_record) + log_padded_size(record->size);
+        if (end > length)
+            break;
+
+        if (record->time < m_first_time)
+            m_first_time = record->time;
+        if (record->time > m_last_time)
+            m_last_time = record->time;
+        if (record->type == LOG_KEYFRAME && record->size == sizeof(input_state))
+            m_keyframes.push_back({record->time, offset, record->source});
+        m_count++;
+        offset = end;
+    }
+
+    if (m_count == 0)
+        m_first_time = 0;
+
+    /* Keyframes are taken by different threads, so they can be slightly out of order */
+    for (auto &key : m_keyframes)
+        key.time -= m_first_time;
+    std::stable_sort(m_keyframes.begin(), m_keyframes.end(), [](const keyframe &a, const keyframe &b)
+    {
+        return a.time < b.time;
+    });
+
+    if (offset < length)
+        blog(LOG_WARNING, "[input-overlay] Input log %s is cut off, ignoring the last %llu bytes", path,
+             static_cast<unsigned long long>(length - offset));
+
+    m_length = offset;
+    rewind();
+    return true;
+}
+
+void input_replay::close()
+{
+#ifdef _WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_data)
+        munmap(const_cast<uint8_t*>(m_data), m_map_size);
+    m_map_size = 0;
+#endif
+    m_data = nullptr;
+    m_length = 0;
+    m_start = 0;
+    m_offset = 0;
+    m_count = 0;
+    m_first_time = 0;
+    m_last_time = 0;
+    m_clock = 0;
+    m_keyframes.clear();
+}
+
+void input_replay::rewind()
+{
+    m_offset = m_start;
+    m_clock = 0;
+}
+
+const log_record* input_replay::next_record() const
+{
+    if (m_offset >= m_length)
+        return nullptr;
+    return reinterpret_cast<const log_record*>(m_data + m_offset);
+}
+
+size_t input_replay::tick(const float seconds, element_data_holder* target)
+{
+    if (!m_data)
+        return 0;
+
+    if (m_speed > 0.f)
+        m_clock += static_cast<uint64_t>(static_cast<double>(seconds) * m_speed * 1000000000.0);
+    else
+        m_clock = duration();
+    return play(target);
+}
+
+void input_replay::seek(const uint64_t position, element_data_holder* target)
+{
+    if (!m_data)
+        return;
+
+    /* Newest keyframe of the played source at or before the position */
+    auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), position,
+                               [](const uint64_t pos, const keyframe &key)
+                               {
+                                   return pos < key.time;
+                               });
+    while (it != m_keyframes.begin() && (it - 1)->source != m_source)
+        --it;
+
+    if (it != m_keyframes.begin()) {
+        const auto &key = *(it - 1);
+        const auto record = reinterpret_cast<const log_record*>(m_data + key.offset);
+        input_state snapshot;
+        memcpy(static_cast<void*>(&snapshot), record + 1, sizeof(input_state));
+        target->input_state::restore(snapshot);
+        m_offset = key.offset + sizeof(log_record) + log_padded_size(record->size);
+    } else {
+        target->input_state::clear_data();
+        m_offset = m_start;
+    }
+
+    m_clock = position;
+    play(target);
+}
+
+size_t input_replay::play(element_data_holder* target)
+{
+    const auto now = os_gettime_ns();
+    const log_record* record;
+    size_t applied = 0;
+
+    while ((record = next_record()) && record->time - m_first_time <= m_clock) {
+        m_offset += sizeof(log_record) + log_padded_size(record->size);
+        if (record->source == m_source) {
+            apply(record, target, now);
+            applied++;
+        }
+    }
+    return applied;
+}
+
+void input_replay::apply(const log_record* record, element_data_holder* target, const uint64_t now) const
+{
+    const auto payload = reinterpret_cast<const uint8_t*>(record + 1);
+
+    /* The input_state methods are called directly, replayed
+     * data shouldn't end up in a running recording again */
+    switch (record->type) {
+        case LOG_RAW_EVENT:
+            if (record->size == sizeof(raw_event)) {
+                raw_event event;
+                memcpy(&event, payload, sizeof(event));
+                event.time = now;
+                hook::process_event(event, target);
+            }
+            break;
+        case LOG_DATA:
+            if (record->size == sizeof(element_data)) {
+                element_data data;
+                memcpy(&data, payload, sizeof(data));
+                target->input_state::add_data(record->keycode, data);
+                target->set_event_time(now);
+            }
+            break;
+        case LOG_PAD_DATA:
+            if (record->size == sizeof(element_data) && record->gamepad < PAD_COUNT) {
+                element_data data;
+                memcpy(&data, payload, sizeof(data));
+                target->input_state::add_gamepad_data(record->gamepad, record->keycode, data);
+                target->set_gamepad_time(record->gamepad, now);
+            }
+            break;
+        case LOG_CLEAR_BUTTONS:
+            target->input_state::clear_button_data();
+            break;
+        case LOG_KEYFRAME:
+            /* Only needed for seeking, played
+             * records already have the same state */
+            break;
+        default:; /* Newer record type */
+    }
+}
+
+namespace replay
+{
+    static input_replay player;
+    static std::atomic<bool> running(false);
+
+    bool start(const char* path, const float speed)
+    {
+        PROFILED_LOCK(lock, hook::mutex);
+        running = false;
+
+        if (!hook::input_data) {
+            blog(LOG_WARNING, "[input-overlay] Can't replay input, local input isn't enabled");
+            return false;
+        }
+
+        if (!player.open(path))
+            return false;
+
+        player.set_speed(speed);
+        running = true;
+        blog(LOG_INFO, "[input-overlay] Replaying %llu records (%.1f s) from %s",
+             static_cast<unsigned long long>(player.size()), player.duration() / 1000000000.0, path);
+        return true;
+    }
+
+    void stop()
+    {
+        PROFILED_LOCK(lock, hook::mutex);
+        running = false;
+        player.close();
+    }
+
+    bool active()
+    {
+        return running;
+    }
+
+    void tick(const float seconds)
+    {
+        if (!running || !hook::input_data)
+            return;
+
+        if (player.tick(seconds, hook::input_data) > 0)
+            hook::input_data->publish();
+
+        if (player.finished()) {
+            running = false;
+            player.close();
+            blog(LOG_INFO, "[input-overlay] Input replay finished");
+        }
+    }
+}
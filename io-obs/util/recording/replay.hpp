@@ -0,0 +1,157 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include "input_log.hpp"
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+class element_data_holder;
+
+/* Plays an input log back into an element_data_holder. The file is
+ * memory mapped and read in place, so opening even long recordings is
+ * cheap and the records are never copied into memory as a whole.
+ * Raw events go through hook::process_event, so they're applied exactly
+ * like they were when they came from the hook.
+ * Opening indexes all keyframes, seeking then restores the closest one
+ * before the position and only applies the records after it
+ */
+class input_replay
+{
+public:
+    input_replay() = default;
+
+    input_replay(const input_replay &) = delete;
+
+    input_replay &operator=(const input_replay &) = delete;
+
+    ~input_replay();
+
+    bool open(const char* path);
+
+    void close();
+
+    bool is_open() const
+    {
+        return m_data != nullptr;
+    }
+
+    /* Amount of complete records in the log */
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    /* Time between the first and last record in ns */
+    uint64_t duration() const
+    {
+        return m_last_time - m_first_time;
+    }
+
+    /* Replay time since the first record in ns */
+    uint64_t position() const
+    {
+        return m_clock;
+    }
+
+    bool finished() const
+    {
+        return m_offset >= m_length;
+    }
+
+    /* 1 is real time, 2 twice as fast and so on. Zero or
+     * less applies everything that's left on the next tick */
+    void set_speed(float speed)
+    {
+        m_speed = speed;
+    }
+
+    float get_speed() const
+    {
+        return m_speed;
+    }
+
+    /* Only records of this source are played, defaults to local input */
+    void set_source(uint8_t source)
+    {
+        m_source = source;
+    }
+
+    /* Amount of usable keyframes of all sources */
+    size_t keyframe_count() const
+    {
+        return m_keyframes.size();
+    }
+
+    void rewind();
+
+    /* Sets target to the state at position (ns since the first record)
+     * and continues playing from there. Binary searches the keyframe
+     * index, so the cost doesn't depend on the position */
+    void seek(uint64_t position, element_data_holder* target);
+
+    /* Moves the replay clock forward by seconds (times the speed) and
+     * applies all records up to it to target. Event times are moved
+     * to the time of the replay, so latency is measured correctly.
+     * Returns how many records were applied
+     */
+    size_t tick(float seconds, element_data_holder* target);
+
+private:
+    struct keyframe
+    {
+        uint64_t time;      /* Since the first record */
+        size_t offset;
+        uint8_t source;
+    };
+
+    const log_record* next_record() const;
+
+    /* Applies all records up to the replay clock */
+    size_t play(element_data_holder* target);
+
+    void apply(const log_record* record, element_data_holder* target, uint64_t now) const;
+
+    const uint8_t* m_data = nullptr;
+    size_t m_length = 0;    /* Mapped size up to the end of the last complete record */
+    size_t m_start = 0;     /* Offset of the first record */
+    size_t m_offset = 0;    /* Offset of the next record */
+    size_t m_count = 0;
+
+    uint64_t m_first_time = 0, m_last_time = 0;
+    uint64_t m_clock = 0;
+    float m_speed = 1.f;
+    uint8_t m_source = LOG_SOURCE_LOCAL;
+    std::vector<keyframe> m_keyframes;  /* Sorted by time */
+
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    size_t m_map_size = 0;
+#endif
+};
+
+/* Replay of a log into the local input data, driven by the frame
+ * scheduler. Used for reproducing recorded input on the overlays.
+ * Graphics thread only, except for start and stop
+ */
+namespace replay
+{
+    bool start(const char* path, float speed);
+
+    void stop();
+
+    bool active();
+
+    /* Called once per frame with hook::mutex held */
+    void tick(float seconds);
+}
@@ -0,0 +1,126 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "sprite_batch.hpp"
+#include <obs-module.h>
+#include <cmath>
+#include <cstring>
+
+sprite_batch::~sprite_batch()
+{
+    if (m_buffer) {
+        obs_enter_graphics();
+        free();
+        obs_leave_graphics();
+    }
+}
+
+void sprite_batch::begin(const uint32_t texture_width, const uint32_t texture_height)
+{
+    m_points.clear();
+    m_uvs.clear();
+    m_texel_u = texture_width ? 1.f / texture_width : 0.f;
+    m_texel_v = texture_height ? 1.f / texture_height : 0.f;
+}
+
+void sprite_batch::add_quad(const vec2* corners, const gs_rect &rect)
+{
+    const auto u0 = rect.x * m_texel_u, v0 = rect.y * m_texel_v;
+    const auto u1 = (rect.x + rect.cx) * m_texel_u, v1 = (rect.y + rect.cy) * m_texel_v;
+    const float u[] = {u0, u1, u0, u1}, v[] = {v0, v0, v1, v1};
+    /* Two triangles with the same winding as obs' sprite triangle strip */
+    static const int order[SPRITE_VERTICES] = {0, 1, 2, 2, 1, 3};
+
+    const auto start = m_points.size();
+    m_points.resize(start + SPRITE_VERTICES);
+    m_uvs.resize(start + SPRITE_VERTICES);
+    auto point = &m_points[start];
+    auto uv = &m_uvs[start];
+
+    for (const auto corner : order) {
+        point->x = corners[corner].x;
+        point->y = corners[corner].y;
+        uv->x = u[corner];
+        uv->y = v[corner];
+        point++;
+        uv++;
+    }
+}
+
+void sprite_batch::add(const gs_rect &rect, const vec2 &pos)
+{
+    vec2 corners[4];
+    corners[0].x = corners[2].x = pos.x;
+    corners[1].x = corners[3].x = pos.x + rect.cx;
+    corners[0].y = corners[1].y = pos.y;
+    corners[2].y = corners[3].y = pos.y + rect.cy;
+    add_quad(corners, rect);
+}
+
+void sprite_batch::add(const gs_rect &rect, const vec2 &pos, const float angle)
+{
+    /* Rotated around the sprite center, which then sits at
+     * (pos.x - cx / 2, pos.y + cy / 2). That's where the old
+     * translate, rotate, translate matrix stack put it */
+    const auto half_w = rect.cx / 2.f, half_h = rect.cy / 2.f;
+    const auto center_x = pos.x - half_w, center_y = pos.y + half_h;
+    const auto c = cosf(angle), s = sinf(angle);
+
+    vec2 corners[4];
+    for (int i = 0; i < 4; i++) {
+        const auto x = (i & 1) ? half_w : -half_w;
+        const auto y = (i & 2) ? half_h : -half_h;
+        corners[i].x = center_x + x * c - y * s;
+        corners[i].y = center_y + x * s + y * c;
+    }
+    add_quad(corners, rect);
+}
+
+void sprite_batch::draw(gs_effect_t* effect, gs_texture_t* texture)
+{
+    const auto count = m_points.size();
+    if (!count || !texture)
+        return;
+
+    if (count > m_capacity) {
+        free();
+        m_capacity = count * 2;
+
+        const auto data = gs_vbdata_create();
+        data->num = m_capacity;
+        data->points = static_cast<vec3*>(bzalloc(sizeof(vec3) * m_capacity));
+        data->num_tex = 1;
+        data->tvarray = static_cast<gs_tvertarray*>(bzalloc(sizeof(gs_tvertarray)));
+        data->tvarray[0].width = 2;
+        data->tvarray[0].array = bzalloc(sizeof(vec2) * m_capacity);
+        m_buffer = gs_vertexbuffer_create(data, GS_DYNAMIC);
+
+        if (!m_buffer) {
+            m_capacity = 0;
+            return;
+        }
+    }
+
+    /* The whole buffer is uploaded, but only the used part is drawn */
+    const auto data = gs_vertexbuffer_get_data(m_buffer);
+    memcpy(data->points, m_points.data(), sizeof(vec3) * count);
+    memcpy(data->tvarray[0].array, m_uvs.data(), sizeof(vec2) * count);
+    gs_vertexbuffer_flush(m_buffer);
+
+    gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture);
+    gs_load_vertexbuffer(m_buffer);
+    gs_load_indexbuffer(nullptr);
+    gs_draw(GS_TRIS, 0, static_cast<uint32_t>(count));
+}
+
+void sprite_batch::free()
+{
+    if (m_buffer)
+        gs_vertexbuffer_destroy(m_buffer);
+    m_buffer = nullptr;
+    m_capacity = 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <graphics/graphics.h>
+#include <graphics/vec2.h>
+#include <graphics/vec3.h>
+#include <vector>
+
+/* Vertices per quad, drawn as a triangle list */
+#define SPRITE_VERTICES 6
+
+/* Collects textured quads of one texture and draws them with a single
+ * draw call. Building the quads only touches the cpu side vectors, so
+ * it works without obs and the graphics context. draw() copies them
+ * into one dynamic vertex buffer, which only grows.
+ * Quads are drawn in the order they're added, same as separate sprites
+ */
+class sprite_batch
+{
+public:
+    sprite_batch() = default;
+
+    ~sprite_batch();
+
+    sprite_batch(const sprite_batch &) = delete;
+
+    sprite_batch &operator=(const sprite_batch &) = delete;
+
+    /* Starts a new batch for a texture of that size in pixels */
+    void begin(uint32_t texture_width, uint32_t texture_height);
+
+    /* Part rect of the texture with its top left corner at pos */
+    void add(const gs_rect &rect, const vec2 &pos);
+
+    /* Same, rotated by angle (radians) like the old matrix based
+     * drawing of mouse arrows did it */
+    void add(const gs_rect &rect, const vec2 &pos, float angle);
+
+    size_t quads() const
+    {
+        return m_points.size() / SPRITE_VERTICES;
+    }
+
+    const std::vector<vec3> &points() const
+    {
+        return m_points;
+    }
+
+    const std::vector<vec2> &uvs() const
+    {
+        return m_uvs;
+    }
+
+    /* Uploads and draws all quads, needs the graphics context */
+    void draw(gs_effect_t* effect, gs_texture_t* texture);
+
+    /* Frees the vertex buffer, needs the graphics context */
+    void free();
+
+private:
+    /* Adds the two triangles of a quad from its corners in the
+     * order top left, top right, bottom left, bottom right */
+    void add_quad(const vec2* corners, const gs_rect &rect);
+
+    std::vector<vec3> m_points;
+    std::vector<vec2> m_uvs;
+    float m_texel_u = 0.f, m_texel_v = 0.f; /* Size of one pixel in texture coordinates */
+
+    gs_vertbuffer_t* m_buffer = nullptr;
+    size_t m_capacity = 0;  /* Vertices m_buffer can hold */
+};
@@ -0,0 +1,124 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/* Bounded lock-free queue for exactly one producer thread and
+ * one consumer thread. The producer only ever writes m_head and
+ * the consumer only writes m_tail, so neither side has to wait
+ * for the other. If the queue is full new items are dropped and
+ * counted, they never overwrite unread items.
+ * Capacity has to be a power of two. Instances should have static
+ * storage duration or be allocated with proper alignment, since
+ * both indices sit on their own cache line.
+ */
+template<class T, size_t N>
+class spsc_ring
+{
+    static_assert(N > 1 && (N & (N - 1)) == 0, "spsc_ring capacity has to be a power of two");
+
+public:
+    /* Producer side */
+    bool push(const T &item)
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+
+        if (head - m_tail_cache >= N) {
+            /* Only reload the consumer index if the cached one says we're full */
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            if (head - m_tail_cache >= N) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        m_items[head & (N - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+
+        const auto fill = head + 1 - m_tail_cache;
+        if (fill > m_high_water.load(std::memory_order_relaxed))
+            m_high_water.store(fill, std::memory_order_relaxed);
+        return true;
+    }
+
+    /* Consumer side */
+    bool pop(T &out)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail == m_head_cache) {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail == m_head_cache)
+                return false;
+        }
+
+        out = m_items[tail & (N - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Consumer side. Hands every item that was queued at the time of
+     * the call to f and frees all slots at once. Items pushed while
+     * draining are left for the next call, so this always terminates.
+     * Returns the amount of consumed items
+     */
+    template<class F>
+    size_t drain(F &&f)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        m_head_cache = m_head.load(std::memory_order_acquire);
+
+        for (auto i = tail; i != m_head_cache; i++)
+            f(m_items[i & (N - 1)]);
+
+        m_tail.store(m_head_cache, std::memory_order_release);
+        return static_cast<size_t>(m_head_cache - tail);
+    }
+
+    size_t size() const
+    {
+        return static_cast<size_t>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+    }
+
+    static constexpr size_t capacity()
+    {
+        return N;
+    }
+
+    /* Statistics, safe to read from any thread */
+    uint64_t pushed() const
+    {
+        return m_head.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    /* Highest fill level the queue has seen. Measured against the
+     * producer's cached consumer index, so this may overestimate */
+    uint64_t high_water() const
+    {
+        return m_high_water.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    uint64_t m_tail_cache = 0;                  /* Producer's copy of m_tail */
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_high_water{0};
+
+    alignas(64) std::atomic<uint64_t> m_tail{0};
+    uint64_t m_head_cache = 0;                  /* Consumer's copy of m_head */
+
+    alignas(64) T m_items[N];
+};
@@ -0,0 +1,162 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#include "trace.hpp"
+#include <obs-module.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+
+namespace trace
+{
+    std::atomic<bool> tracing(false);
+
+    enum event_type : uint8_t
+    {
+        EVENT_SPAN,
+        EVENT_COUNTER
+    };
+
+    struct event
+    {
+        const char* name;
+        uint64_t time;
+        int64_t value;  /* Duration of spans in ns */
+        event_type type;
+    };
+
+    /* Only the owning thread writes events and head,
+     * write() reads them once tracing is off */
+    struct thread_ring
+    {
+        event events[TRACE_RING_SIZE];
+        std::atomic<uint64_t> head;
+        std::atomic<const char*> name;
+        uint64_t first = 0;     /* Head when tracing started, guarded by mutex */
+        uint32_t id = 0;
+    };
+
+    static std::mutex mutex; /* Guards rings and start_time */
+    /* Rings outlive their threads, so spans of threads that
+     * exited while tracing still end up in the trace */
+    static std::vector<std::unique_ptr<thread_ring>> rings;
+    static uint64_t start_time = 0;
+    static thread_local thread_ring* local_ring = nullptr;
+    static thread_local const char* local_name = nullptr;
+
+    /* Rings are only created once a thread records something,
+     * threads that never run while tracing don't use any memory */
+    static thread_ring* get_ring()
+    {
+        if (!local_ring) {
+            std::unique_ptr<thread_ring> ring(new thread_ring);
+            ring->head.store(0, std::memory_order_relaxed);
+            ring->name.store(local_name, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            ring->id = static_cast<uint32_t>(rings.size() + 1);
+            local_ring = ring.get();
+            rings.emplace_back(std::move(ring));
+        }
+        return local_ring;
+    }
+
+    static void push(const event &e)
+    {
+        const auto ring = get_ring();
+        const auto head = ring->head.load(std::memory_order_relaxed);
+        ring->events[head & (TRACE_RING_SIZE - 1)] = e;
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &ring : rings)
+            ring->first = ring->head.load(std::memory_order_acquire);
+        start_time = os_gettime_ns();
+        tracing = true;
+        blog(LOG_INFO, "[input-overlay] Tracing started");
+    }
+
+    void stop()
+    {
+        if (tracing.exchange(false))
+            blog(LOG_INFO, "[input-overlay] Tracing stopped");
+    }
+
+    bool write(const char* path)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto f = os_fopen(path, "wb");
+        if (!f) {
+            blog(LOG_ERROR, "[input-overlay] Couldn't create trace at %s", path);
+            return false;
+        }
+
+        fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        fprintf(f, R"({"name": "process_name", "ph": "M", "pid": 1, "tid": 0, "args": {"name": "input-overlay"}})");
+
+        uint64_t written = 0;
+        for (const auto &ring : rings) {
+            const auto name = ring->name.load(std::memory_order_relaxed);
+            if (name)
+                fprintf(f, ",\n" R"({"name": "thread_name", "ph": "M", "pid": 1, "tid": %u, "args": {"name": "%s"}})",
+                        ring->id, name);
+
+            /* A thread can still be writing one event that it started before
+             * tracing was turned off, which lands in the oldest slot */
+            const auto head = ring->head.load(std::memory_order_acquire);
+            auto first = ring->first;
+            if (head - first >= TRACE_RING_SIZE)
+                first = head - TRACE_RING_SIZE + 1;
+
+            for (auto i = first; i < head; i++) {
+                const auto &e = ring->events[i & (TRACE_RING_SIZE - 1)];
+                const auto ts = (static_cast<int64_t>(e.time - start_time)) / 1000.0;
+
+                if (e.type == EVENT_SPAN)
+                    fprintf(f, ",\n" R"({"name": "%s", "ph": "X", "pid": 1, "tid": %u, "ts": %.3f, "dur": %.3f})",
+                            e.name, ring->id, ts, e.value / 1000.0);
+                else
+                    fprintf(f, ",\n" R"({"name": "%s", "ph": "C", "pid": 1, "tid": %u, "ts": %.3f, "args": {"value": %lld}})",
+                            e.name, ring->id, ts, static_cast<long long>(e.value));
+                written++;
+            }
+        }
+
+        fprintf(f, "\n]}\n");
+        const auto ok = !ferror(f);
+        fclose(f);
+
+        if (ok)
+            blog(LOG_INFO, "[input-overlay] Wrote %llu trace events to %s", static_cast<unsigned long long>(written),
+                 path);
+        else
+            blog(LOG_ERROR, "[input-overlay] Failed to write trace to %s", path);
+        return ok;
+    }
+
+    void complete(const char* name, const uint64_t start, const uint64_t end)
+    {
+        push({ name, start, static_cast<int64_t>(end - start), EVENT_SPAN });
+    }
+
+    void counter(const char* name, const int64_t value)
+    {
+        if (active())
+            push({ name, os_gettime_ns(), value, EVENT_COUNTER });
+    }
+
+    void set_thread_name(const char* name)
+    {
+        local_name = name;
+        if (local_ring)
+            local_ring->name.store(name, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <util/platform.h>
+
+/* Events each thread keeps, older ones are overwritten */
+#define TRACE_RING_SIZE     (1 << 16)
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b)  TRACE_CONCAT_(a, b)
+/* Times the rest of the enclosing block, name has to be a string literal */
+#define TRACE_SCOPE(name)   trace::scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+/* Opt-in tracing of the input threads, written as Chrome trace event
+ * json which Perfetto and chrome://tracing can open.
+ * Every thread writes into its own ring, so recording a span is two
+ * clock reads and a store without any locking. While tracing is off
+ * spans only cost the check of active()
+ */
+namespace trace
+{
+    extern std::atomic<bool> tracing;
+
+    inline bool active()
+    {
+        return tracing.load(std::memory_order_relaxed);
+    }
+
+    /* Discards everything recorded so far and starts tracing */
+    void start();
+
+    void stop();
+
+    /* Writes what the rings still hold of the last trace to path,
+     * only call once tracing stopped. Returns false if the file
+     * couldn't be written */
+    bool write(const char* path);
+
+    /* Records a finished span, times from os_gettime_ns */
+    void complete(const char* name, uint64_t start, uint64_t end);
+
+    void counter(const char* name, int64_t value);
+
+    /* Name the calling thread shows up with in the trace,
+     * has to be a string literal */
+    void set_thread_name(const char* name);
+
+    class scope
+    {
+        const char* m_name;
+        uint64_t m_start;
+
+    public:
+        explicit scope(const char* name) : m_name(name), m_start(active() ? os_gettime_ns() : 0)
+        {
+        }
+
+        ~scope()
+        {
+            /* Spans that were running when tracing stopped are dropped */
+            if (m_start && active())
+                complete(m_name, m_start, os_gettime_ns());
+        }
+
+        scope(const scope &) = delete;
+
+        scope &operator=(const scope &) = delete;
+    };
+}
@@ -0,0 +1,57 @@
+/**
+ * This file is part of input-overlay
+ * which is licensed under the GPL v2.0
+ * See LICENSE or http://www.gnu.org/licenses
+ * github.com/univrsal/input-overlay
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/* Hands the newest value of T from one writer thread to one reader
+ * thread without either of them ever waiting. The writer fills back()
+ * and publishes it, the reader gets the newest published value from
+ * front(). Values that were published but never read are skipped.
+ * Three buffers are needed so the writer always has one to fill while
+ * the reader holds one and one is waiting in between
+ */
+template<class T>
+class triple_buffer
+{
+public:
+    /* Writer side, the buffer that will be published next. Its content
+     * is whatever was published two or more calls ago, so writers
+     * should overwrite it entirely
+     */
+    T &back()
+    {
+        return m_buffers[m_back];
+    }
+
+    void publish()
+    {
+        m_back = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel) & INDEX;
+    }
+
+    /* Reader side, stays valid until the next call */
+    const T &front()
+    {
+        if (m_middle.load(std::memory_order_relaxed) & FRESH)
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return m_buffers[m_front];
+    }
+
+private:
+    static const uint8_t INDEX = 0x3;
+    static const uint8_t FRESH = 0x4;
+
+    T m_buffers[3];
+    /* Each index is only touched by one thread, padding keeps them apart */
+    uint8_t m_back = 0;
+    char m_pad0[63] = {};
+    std::atomic<uint8_t> m_middle{1};
+    char m_pad1[63] = {};
+    uint8_t m_front = 2;
+};
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stddef.h>
+
 #ifndef CCT
 
 #ifdef LINUX
@@ -50,6 +53,7 @@
 #define S_REGION                        "input-overlay"
 #define S_UIOHOOK                       "iohook"
 #define S_GAMEPAD                       "gamepad"
+#define S_EVDEV                         "evdev"
 #define S_OVERLAY                       "overlay"
 #define S_HISTORY                       "history"
 #define S_REMOTE                        "remote"
@@ -113,6 +117,7 @@
 #define T_FILTER_IMAGE_FILES            T_("Filter.ImageFiles")
 #define T_FILTER_TEXT_FILES             T_("Filter.TextFiles")
 #define T_FILTER_ALL_FILES              T_("Filter.AllFiles")
+#define T_FILTER_LAYOUTS                T_("Filter.Layouts")
 #define T_RELOAD_PAD_DEVICES            T_("Gamepad.Reload")
 #define T_CONTROLLER_ID                 T_("Gamepad.Id")
 #define T_CONROLLER_L_DEADZONE          T_("Gamepad.LeftDeadZone")
@@ -123,6 +128,20 @@
 #define T_MONITOR_H_CENTER              T_("Monitor.CenterX")
 #define T_MONITOR_V_CENTER              T_("Monitor.CenterY")
 
+/* Lang Input Replay */
+#define S_REPLAY_FILE                   "io.replay_file"
+#define S_REPLAY_SOURCE                 "io.replay_source"
+#define S_REPLAY_SPEED                  "io.replay_speed"
+#define S_REPLAY_LOOP                   "io.replay_loop"
+#define S_REPLAY_POSITION               "io.replay_position"
+
+#define T_REPLAY_FILE                   T_("Replay.File")
+#define T_REPLAY_SOURCE                 T_("Replay.Source")
+#define T_REPLAY_SPEED                  T_("Replay.Speed")
+#define T_REPLAY_LOOP                   T_("Replay.Loop")
+#define T_REPLAY_POSITION               T_("Replay.Position")
+#define T_FILTER_INPUT_LOGS             T_("Filter.InputLogs")
+
 /* Lang Input History */
 #define S_HISTORY_SIZE                  "io.history_size"
 #define S_HISTORY_FIX_CUTTING           "io.fix_cutting"
@@ -183,6 +202,14 @@
 
 #define T_MENU_OPEN_SETTINGS            T_("Menu.InputOverlay.OpenSettings")
 #define T_REFRESH_RATE_TOOLTIP          T_("Dialog.InputOverlay.RemoteRefreshRate.Tooltip")
+#define T_RECORDING_START               T_("Dialog.Recording.Start")
+#define T_RECORDING_STOP                T_("Dialog.Recording.Stop")
+#define T_RECORDING_REPLAY              T_("Dialog.Recording.Replay")
+#define T_RECORDING_STOP_REPLAY         T_("Dialog.Recording.StopReplay")
+#define T_RECORDING_STATUS              T_("Dialog.Recording.Status")
+#define T_LATENCY_EMPTY                 T_("Dialog.Latency.Empty")
+#define T_LATENCY_TRACE_START           T_("Dialog.Latency.TraceStart")
+#define T_LATENCY_TRACE_STOP            T_("Dialog.Latency.TraceStop")
 
 #define WHEEL_UP       -1
 #define WHEEL_DOWN      1
@@ -265,3 +292,158 @@ inline bool ends_with(std::string const &value, std::string const &ending)
 extern void GetWindowList(std::vector<std::string> &windows);
 
 extern void GetCurrentWindowTitle(std::string &title);
+
+/* Amount of slots in a timer wheel, has to be a power of two */
+#define TIMER_WHEEL_SLOTS 256
+
+class timer_wheel;
+
+/* A timer that can be armed on a timer_wheel. The owner keeps the
+ * timer alive, the wheel only links it into one of its slots, so
+ * arming and disarming never allocates
+ */
+class deadline_timer
+{
+public:
+    typedef void (*timer_proc)(void* data);
+
+    deadline_timer(timer_proc proc, void* data) : m_proc(proc), m_data(data)
+    {
+    }
+
+    deadline_timer(const deadline_timer &) = delete;
+
+    deadline_timer &operator=(const deadline_timer &) = delete;
+
+    bool armed() const
+    {
+        return m_link != nullptr;
+    }
+
+    uint64_t get_deadline() const
+    {
+        return m_deadline;
+    }
+
+private:
+    friend class timer_wheel;
+
+    timer_proc m_proc;
+    void* m_data;
+    uint64_t m_deadline = 0;
+    deadline_timer* m_next = nullptr;
+    deadline_timer** m_link = nullptr;  /* Pointer that points to this timer, nullptr if not armed */
+};
+
+/* Hashed timer wheel. Timers are put into the slot of their deadline
+ * (in ticks of the given resolution) modulo the slot count, so arming,
+ * rearming and cancelling is O(1) and advancing only looks at the slots
+ * of the ticks that passed. Timers further away than one rotation just
+ * stay in their slot until their deadline is reached.
+ * Not thread safe, all calls have to come from the same thread or be
+ * guarded by the same lock. Timer procs are called from advance()
+ * and may arm or cancel any timer, including their own
+ */
+class timer_wheel
+{
+public:
+    explicit timer_wheel(const uint64_t resolution) : m_resolution(resolution)
+    {
+    }
+
+    timer_wheel(const timer_wheel &) = delete;
+
+    timer_wheel &operator=(const timer_wheel &) = delete;
+
+    /* Arms the timer for the given deadline, or moves it there if it
+     * is already armed. Deadlines in the past fire on the next advance() */
+    void schedule(deadline_timer &timer, const uint64_t deadline)
+    {
+        cancel(timer);
+
+        /* Overdue timers go into the current slot, which the next advance()
+         * looks at again. Procs that rearm themselves for a past deadline
+         * go one further, so they can't keep advance() busy forever */
+        auto tick = deadline / m_resolution;
+        if (tick < m_tick || (m_advancing && tick == m_tick))
+            tick = m_advancing ? m_tick + 1 : m_tick;
+
+        auto &head = m_slots[tick & (TIMER_WHEEL_SLOTS - 1)];
+        timer.m_deadline = deadline;
+        timer.m_next = head;
+        timer.m_link = &head;
+        if (head)
+            head->m_link = &timer.m_next;
+        head = &timer;
+        m_count++;
+    }
+
+    void cancel(deadline_timer &timer)
+    {
+        if (!timer.m_link)
+            return;
+
+        *timer.m_link = timer.m_next;
+        if (timer.m_next)
+            timer.m_next->m_link = timer.m_link;
+        timer.m_next = nullptr;
+        timer.m_link = nullptr;
+        m_count--;
+    }
+
+    /* Fires all timers with a deadline up to now,
+     * returns how many fired */
+    size_t advance(const uint64_t now)
+    {
+        const auto target = now / m_resolution;
+        size_t fired = 0;
+
+        if (target < m_tick || m_count == 0) {
+            if (target > m_tick)
+                m_tick = target;
+            return 0;
+        }
+
+        /* The current tick is looked at again, it can have timers that were
+         * armed after the last advance(). After more than one rotation every
+         * slot has to be looked at once */
+        auto steps = target - m_tick;
+        if (steps >= TIMER_WHEEL_SLOTS)
+            steps = TIMER_WHEEL_SLOTS - 1;
+
+        m_advancing = true;
+        for (auto tick = target - steps; tick <= target; tick++) {
+            m_tick = tick;
+            auto &head = m_slots[tick & (TIMER_WHEEL_SLOTS - 1)];
+
+            /* Procs can change any timer, so the slot
+             * is searched again after each call */
+            auto timer = head;
+            while (timer) {
+                if (timer->m_deadline > now) {
+                    timer = timer->m_next;
+                    continue;
+                }
+                cancel(*timer);
+                timer->m_proc(timer->m_data);
+                fired++;
+                timer = head;
+            }
+        }
+        m_advancing = false;
+        return fired;
+    }
+
+    /* Amount of armed timers */
+    size_t size() const
+    {
+        return m_count;
+    }
+
+private:
+    uint64_t m_resolution;
+    uint64_t m_tick = 0;    /* Last tick that was advanced to */
+    size_t m_count = 0;
+    bool m_advancing = false;
+    deadline_timer* m_slots[TIMER_WHEEL_SLOTS] = {};
+};